@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Ping-pong frame banks
+//              Writes the frames of the sample stream into two BRAM banks of
+//              2^FRAME_BITS frames each: while one bank is filled, the other
+//              one holds the last complete block of frames for the PS, which
+//              reads it with bursts through an AXI BRAM Controller instead of
+//              single 32-bit AXI GPIO reads.
+//
+//              Once a bank is full, the banks are swapped, o_status is updated
+//              and o_bank_ready pulses, which can be used as an interrupt. The
+//              PS then has 2^FRAME_BITS frames to read the ready bank, and
+//              acknowledges it with a rising edge on i_ctrl[1]. A bank
+//              completed while the previous one is still unacknowledged is
+//              counted as an overrun, as the PS may have read a bank being
+//              overwritten.
+//
+//              Status (o_status):
+//              [31]     ready bank, once [15:0] is not 0
+//              [30]     ready bank not acknowledged yet
+//              [29:16]  overruns
+//              [15:0]   number of banks completed
+//
+//              Memory map of the read port (32-bit words):
+//              {0, b, f, c}  pair c of frame f of bank b, {dout_b, dout_a}
+//              {1, b, f}     frame flags of frame f of bank b, in the low
+//                            half (see rhd_sequencer.v)
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address = byte
+//              address [FRAME_BITS+8:2]).
+//
+//              Control bits (i_ctrl):
+//              [0] enable, applied at the start of a frame. The first bank
+//                  starts with the first frame.
+//              [1] acknowledge the ready bank, rising edge
+//
+// Parameters:  FRAME_BITS - log2 of the number of frames per bank, <= 9
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_banks #(
+  parameter FRAME_BITS = 4
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [1:0]       i_ctrl,
+  output [31:0]     o_status,
+  output reg        o_bank_ready,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Read port
+  input                   i_rd_en,
+  input [FRAME_BITS+6:0]  i_rd_addr,
+  output reg [31:0]       o_rd_data
+);
+
+  reg [31:0] r_mem [0:(1<<(FRAME_BITS+6))-1];
+  reg [15:0] r_flags [0:(1<<(FRAME_BITS+1))-1];
+
+  reg r_run;
+  reg r_wbank;                  // Bank being filled
+  reg [FRAME_BITS-1:0] r_frame; // Frame of the bank being filled
+  reg r_pending;
+  reg [13:0] r_overruns;
+  reg [15:0] r_banks;
+  reg r_ctrl_1;
+
+  wire w_run;
+
+  // Enabled at the start of a frame
+  assign w_run = i_smp_sof ? i_ctrl[0] : r_run;
+
+  assign o_status = {~r_wbank, r_pending, r_overruns, r_banks};
+
+  // Purpose: Banks, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (i_smp_valid & w_run) begin
+      r_mem[{r_wbank, r_frame, i_smp_ch}] <= i_smp_data;
+    end
+    if (i_smp_valid & i_smp_sof & w_run) begin
+      r_flags[{r_wbank, r_frame}] <= i_smp_flags;
+    end
+    if (i_rd_en) begin
+      o_rd_data <= i_rd_addr[FRAME_BITS+6] ? {16'b0, r_flags[i_rd_addr[FRAME_BITS:0]]}
+                                           : r_mem[i_rd_addr[FRAME_BITS+5:0]];
+    end
+  end
+
+  // Purpose: Swap the banks once the one being filled is full
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_run <= 1'b0;
+      r_wbank <= 1'b0;
+      r_frame <= 0;
+      r_pending <= 1'b0;
+      r_overruns <= 0;
+      r_banks <= 0;
+      r_ctrl_1 <= 1'b0;
+      o_bank_ready <= 1'b0;
+    end else begin
+      o_bank_ready <= 1'b0;
+      r_ctrl_1 <= i_ctrl[1];
+
+      if (i_ctrl[1] & ~r_ctrl_1) begin
+        r_pending <= 1'b0;
+      end
+
+      if (i_smp_valid) begin
+        if (i_smp_sof) begin
+          r_run <= i_ctrl[0];
+          if (~i_ctrl[0]) begin
+            // Drop the partial bank, filling restarts when enabled again
+            r_frame <= 0;
+          end
+        end
+
+        if (i_smp_eof & w_run) begin
+          r_frame <= r_frame + 1'b1;
+          if (&r_frame) begin
+            r_wbank <= ~r_wbank;
+            r_pending <= 1'b1;
+            r_banks <= r_banks + 1'b1;
+            o_bank_ready <= 1'b1;
+            if (r_pending & ~(i_ctrl[1] & ~r_ctrl_1)) begin
+              r_overruns <= r_overruns + 1'b1;
+            end
+          end
+        end
+      end
+    end
+  end
+
+endmodule // rhd_banks
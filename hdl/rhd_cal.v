@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Per-channel gain and offset calibration
+//              Applies a fixed-point scale and offset to every channel of the
+//              sample stream:
+//                y = gain * x + offset
+//              with gain in signed Q2.14 (16384 = 1.0) and offset in LSBs of
+//              the output, both signed. This calibrates electrode-specific
+//              gains and brings every channel to the same unit, e.g. a gain of
+//              0.195 (3195) outputs 1 uV per LSB on the RHD2164.
+//
+//              Coefficients are written through i_coef_wr/i_coef_addr/
+//              i_coef_data at address {field, n}, field 0 being the gain and
+//              field 1 the offset of channel n. Writes go to the inactive one
+//              of two tables, and a rising edge on i_ctrl[1] swaps the tables
+//              at the next start of frame. The inactive table then holds the
+//              previous coefficients: write them all before each commit.
+//              After reset both tables hold a gain of 1 and no offset.
+//
+//              A single multiply-add datapath is time-multiplexed over both
+//              lanes of every pair, which takes 3 clock cycles.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl):
+//              [0] enable, the stream goes through unchanged when cleared
+//              [1] commit the coefficients written since the last commit
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_cal (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [1:0] i_ctrl,
+
+  // Coefficient table
+  input        i_coef_wr,
+  input [6:0]  i_coef_addr, // {field, n}
+  input [15:0] i_coef_data,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // {table, n}
+  reg signed [15:0] r_gain [0:127];
+  reg signed [15:0] r_offset [0:127];
+  reg signed [15:0] r_gain_q;
+  reg signed [15:0] r_offset_q;
+  reg r_table;
+  reg r_commit;
+  reg r_ctrl_1;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_sof;
+  reg r_eof;
+  reg [15:0] r_flags;
+  reg [15:0] r_y_a;
+
+  wire [6:0] w_rd_addr;
+  wire [15:0] w_x;
+  wire signed [15:0] w_xs;
+  wire signed [31:0] w_acc;
+  wire [15:0] w_out;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 128; i = i + 1) begin
+      r_gain[i] = 16'sd16384;
+      r_offset[i] = 16'sd0;
+    end
+  end
+
+  // Lane A of the incoming pair, then lane B of the stored one
+  assign w_rd_addr = (r_sm == IDLE) ? {r_table ^ (i_smp_valid & i_smp_sof & r_commit), 1'b0, i_smp_ch}
+                                    : {r_table, 1'b1, r_ch};
+
+  // Datapath, shared by both lanes
+  assign w_x = (r_sm == LANE_A) ? r_data[15:0] : r_data[31:16];
+  assign w_xs = {~w_x[15], w_x[14:0]};
+  assign w_acc = w_xs * r_gain_q + $signed({{2{r_offset_q[15]}}, r_offset_q, 14'd8192});
+  // Round, scale back from Q2.14 and saturate
+  assign w_out = ((&w_acc[31:29]) | ~(|w_acc[31:29])) ? {~w_acc[29], w_acc[28:14]}
+                                                      : {~w_acc[31], {15{~w_acc[31]}}};
+
+  // Purpose: Coefficient tables, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (i_coef_wr) begin
+      if (i_coef_addr[6]) begin
+        r_offset[{~r_table, i_coef_addr[5:0]}] <= i_coef_data;
+      end else begin
+        r_gain[{~r_table, i_coef_addr[5:0]}] <= i_coef_data;
+      end
+    end
+    r_gain_q <= r_gain[w_rd_addr];
+    r_offset_q <= r_offset[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair through the datapath
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_table <= 1'b0;
+      r_commit <= 1'b0;
+      r_ctrl_1 <= 1'b0;
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_y_a <= 0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      r_ctrl_1 <= i_ctrl[1];
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          if (i_smp_sof) begin
+            r_flags <= i_smp_flags;
+          end
+          r_sm <= LANE_A;
+          // New coefficients from the start of a frame
+          if (i_smp_sof & r_commit) begin
+            r_commit <= 1'b0;
+            r_table <= ~r_table;
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_y_a <= w_out;
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        o_smp_valid <= 1'b1;
+        o_smp_ch <= r_ch;
+        o_smp_data <= i_ctrl[0] ? {w_out, r_y_a} : r_data;
+        o_smp_sof <= r_sof;
+        o_smp_eof <= r_eof;
+        if (r_sof) begin
+          o_smp_flags <= r_flags;
+        end
+        r_sm <= IDLE;
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+
+      if (i_ctrl[1] & ~r_ctrl_1) begin
+        r_commit <= 1'b1;
+      end
+    end
+  end
+
+endmodule // rhd_cal
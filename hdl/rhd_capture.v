@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Pre-trigger circular capture buffer
+//              Continuously writes the frames of the sample stream into a
+//              BRAM ring and freezes it once a trigger has been followed by
+//              i_post_frames more frames. The ring then holds the frames
+//              before the trigger as well as those after it, at full rate,
+//              even when the PS cannot keep up with continuous streaming.
+//
+//              The ring holds 2^FRAME_BITS frames of 32 {dout_b, dout_a}
+//              pairs. Frame f, channel pair c is at address {0, f, c}, and
+//              the frame flags of frame f (see rhd_sequencer.v) in the low
+//              half of the word at address {1, 0, f}. To keep
+//              N ms of pre and post-trigger data at a frame rate of F kHz,
+//              set i_post_frames to N*F and make sure 2^FRAME_BITS >= 2*N*F.
+//              i_post_frames must stay below 2^FRAME_BITS, otherwise the
+//              trigger frame gets overwritten.
+//
+//              Control bits (i_ctrl):
+//              [0] arm       - rising edge, restart filling the ring
+//              [1] trigger   - rising edge, register write trigger
+//              [2] level, trigger on a rising edge of i_trig, which is
+//                  synchronized to i_clk (2 clock cycles of latency)
+//              [3] level, trigger when a sample deviates from mid-scale
+//                  (0x8000) by more than i_threshold
+//
+//              Status (o_status):
+//              [31:30]               state (0: idle, 1: armed, 2: triggered,
+//                                    3: frozen)
+//              [29]                  ring wrapped, every frame is valid
+//              [16+FRAME_BITS-1:16]  frame holding the trigger
+//              [FRAME_BITS-1:0]      next frame to be written, the oldest
+//                                    frame once the ring has wrapped
+//
+//              Frames are read back through i_addr/o_data, with one clock
+//              cycle of latency.
+//
+// Parameters:  FRAME_BITS - log2 of the number of frames in the ring, <= 12
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_capture #(
+  parameter FRAME_BITS = 8
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input  [3:0]  i_ctrl,
+  input  [15:0] i_post_frames,
+  input  [15:0] i_threshold,
+  output [31:0] o_status,
+
+  // External trigger
+  input i_trig,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Readback
+  input [FRAME_BITS+5:0] i_addr,
+  output reg [31:0]      o_data
+);
+
+  localparam IDLE      = 2'b00;
+  localparam ARMED     = 2'b01;
+  localparam TRIGGERED = 2'b10;
+  localparam FROZEN    = 2'b11;
+
+  reg [31:0] r_mem [0:(1<<(FRAME_BITS+5))-1];
+  reg [15:0] r_flags [0:(1<<FRAME_BITS)-1];
+
+  reg [1:0] r_sm;
+  reg [1:0] r_ctrl;
+  reg [2:0] r_trig;  // 2 FF synchronizer + edge detection
+  reg r_sync;   // A start of frame has been seen since arming
+  reg r_wrapped;
+  reg [FRAME_BITS-1:0] r_frame;
+  reg [FRAME_BITS-1:0] r_trig_frame;
+  reg [15:0] r_post_cnt;
+
+  wire w_arm;
+  wire w_wr;
+  wire [15:0] w_dev_a;
+  wire [15:0] w_dev_b;
+  wire w_over;
+  wire w_trigger;
+
+  assign w_arm = i_ctrl[0] & ~r_ctrl[0];
+
+  // Distance of both samples from mid-scale
+  assign w_dev_a = i_smp_data[15] ? {1'b0, i_smp_data[14:0]} : 16'h8000 - i_smp_data[15:0];
+  assign w_dev_b = i_smp_data[31] ? {1'b0, i_smp_data[30:16]} : 16'h8000 - i_smp_data[31:16];
+  assign w_over = i_smp_valid & ((w_dev_a > i_threshold) | (w_dev_b > i_threshold));
+
+  assign w_trigger = (i_ctrl[1] & ~r_ctrl[1])
+                   | (i_ctrl[2] & r_trig[1] & ~r_trig[2])
+                   | (i_ctrl[3] & w_over & w_wr);
+
+  assign w_wr = i_smp_valid & ((r_sm == ARMED) | (r_sm == TRIGGERED))
+              & (r_sync | i_smp_sof);
+
+  // Purpose: Fill the ring and freeze it after the post-trigger frames
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_ctrl <= 2'b0;
+      r_trig <= 3'b0;
+      r_sync <= 1'b0;
+      r_wrapped <= 1'b0;
+      r_frame <= 0;
+      r_trig_frame <= 0;
+      r_post_cnt <= 0;
+    end else begin
+      r_ctrl <= i_ctrl[1:0];
+      r_trig <= {r_trig[1:0], i_trig};
+
+      if (w_arm) begin
+        r_sync <= 1'b0;
+        r_wrapped <= 1'b0;
+        r_frame <= 0;
+        r_sm <= ARMED;
+      end else begin
+        if (w_wr & i_smp_sof) begin
+          r_sync <= 1'b1;
+        end
+
+        if (w_wr & i_smp_eof) begin
+          r_frame <= r_frame + 1'b1;
+          if (&r_frame) begin
+            r_wrapped <= 1'b1;
+          end
+        end
+
+        case (r_sm)
+        ARMED:
+        begin
+          if (w_trigger) begin
+            r_trig_frame <= r_frame;
+            if (w_wr & i_smp_eof) begin
+              // Triggered on the last pair, the trigger frame is complete
+              r_post_cnt <= i_post_frames - 1'b1;
+              r_sm <= (i_post_frames == 0) ? FROZEN : TRIGGERED;
+            end else begin
+              r_post_cnt <= i_post_frames;
+              r_sm <= TRIGGERED;
+            end
+          end
+        end
+        TRIGGERED:
+        begin
+          if (w_wr & i_smp_eof) begin
+            if (r_post_cnt == 0) begin
+              r_sm <= FROZEN;
+            end else begin
+              r_post_cnt <= r_post_cnt - 1'b1;
+            end
+          end
+        end
+        default:
+          r_sm <= r_sm; // IDLE or FROZEN, wait for arm
+        endcase
+      end
+    end
+  end
+
+  // Purpose: Ring memory, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (w_wr) begin
+      r_mem[{r_frame, i_smp_ch}] <= i_smp_data;
+    end
+    if (w_wr & i_smp_sof) begin
+      r_flags[r_frame] <= i_smp_flags;
+    end
+    o_data <= i_addr[FRAME_BITS+5] ? {16'b0, r_flags[i_addr[FRAME_BITS-1:0]]}
+                                   : r_mem[i_addr[FRAME_BITS+4:0]];
+  end
+
+  assign o_status = {r_sm, r_wrapped, {(13-FRAME_BITS){1'b0}}, r_trig_frame,
+                     {(16-FRAME_BITS){1'b0}}, r_frame};
+
+endmodule // rhd_capture
@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Common-average reference
+//              Computes, for every frame, the mean of the channels of i_mask
+//              and subtracts it from all 64 channels of the frame. Channels
+//              left out of i_mask (broken electrodes, reference) still get the
+//              mean subtracted, they just do not contribute to it.
+//
+//              Since the mean is only known once the last pair of the frame
+//              has arrived, frames are stored in a ping-pong frame buffer and
+//              replayed once the mean is computed, one pair every PAIR_CLKS
+//              clock cycles. While a frame is replayed the next one is stored
+//              in the other bank. The stream is thus delayed by one frame.
+//              The replay starts at the last pair of the frame and takes
+//              32*PAIR_CLKS+25 clock cycles, which must be shorter than the
+//              frame period so that it is over before the last pair of the
+//              next frame.
+//
+//              The frame flags are stored with each bank and come out with
+//              the replayed frame, not with the one arriving meanwhile.
+//
+//              o_mean is the mean of the last frame, offset binary, and is
+//              updated whether the subtraction is enabled or not.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl): [0] enable the subtraction, the stream
+//              goes straight through, without the frame of delay, when
+//              cleared. It is applied at the start of a frame. When it is
+//              cleared while the previous frame is still being replayed, as
+//              with frames back to back, that frame is stored anyway and
+//              replayed unchanged as its pairs arrive, right after the
+//              previous one, so that the stream catches up without dropping
+//              or reordering pairs. The bypass starts at the next frame.
+//
+// Parameters:  PAIR_CLKS - Clock cycles between replayed pairs, 4 to 63, to
+//                          suit the stage that follows
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_car #(
+  parameter PAIR_CLKS = 4
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [63:0] i_mask,  // Channels included in the mean
+  output reg [15:0] o_mean,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  localparam IDLE  = 3'b000;
+  localparam LOAD  = 3'b001;
+  localparam DIV   = 3'b010;
+  localparam PLAY  = 3'b011;
+  localparam DRAIN = 3'b100;
+
+  reg [31:0] r_buf [0:63]; // {bank, ch}
+  reg [31:0] r_buf_q;
+  reg r_wr_bank;
+  reg [5:0] r_wr_n;  // Pairs stored in the current frame
+  reg [15:0] r_flags [0:1]; // Frame flags of each bank
+
+  reg r_en;
+  reg signed [21:0] r_sum;
+  reg [6:0] r_n;
+
+  reg [2:0] r_sm;
+  reg r_rd_bank;
+  reg r_play;        // Frame being divided was stored, replay it
+  reg r_drain;       // Disabled while replaying, frame stored to be drained
+  reg r_drain_bank;
+  reg [4:0] r_cnt;
+  reg [5:0] r_pace;
+  reg r_rd_valid;
+  reg [4:0] r_rd_ch;
+  reg r_neg;
+  reg [21:0] r_quot;
+  reg [7:0] r_rem;
+  reg [6:0] r_div;
+  reg [6:0] r_div_n;
+  reg signed [16:0] r_mean;
+
+  wire w_busy;
+  wire w_en;
+  wire [15:0] w_xa;
+  wire [15:0] w_xb;
+  wire signed [21:0] w_pair_sum;
+  wire [6:0] w_pair_n;
+  wire [7:0] w_rem_sh;
+  wire [16:0] w_mean;
+
+  // Subtract the mean and saturate
+  function [15:0] sub_mean;
+    input [15:0] x; // Offset binary
+    input signed [16:0] m;
+    reg signed [17:0] d;
+    begin
+      d = $signed({{2{~x[15]}}, x[14:0]}) - m;
+      if (d > 18'sd32767) begin
+        sub_mean = 16'hFFFF;
+      end else if (d < -18'sd32768) begin
+        sub_mean = 16'h0000;
+      end else begin
+        sub_mean = {~d[15], d[14:0]};
+      end
+    end
+  endfunction
+
+  // A stored frame is being replayed
+  assign w_busy = (r_play & (r_sm != IDLE)) | (r_sm == DRAIN) | r_drain;
+
+  // The subtraction is switched on and off between frames. A frame that
+  // starts while the previous one is replayed is still stored, and drained.
+  assign w_en = i_smp_sof ? (i_ctrl | (r_en & w_busy)) : r_en;
+
+  // Contribution of the incoming pair to the sum
+  assign w_xa = {~i_smp_data[15], i_smp_data[14:0]};
+  assign w_xb = {~i_smp_data[31], i_smp_data[30:16]};
+  assign w_pair_sum = (i_mask[{1'b0, i_smp_ch}] ? {{6{w_xa[15]}}, w_xa} : 22'd0)
+                    + (i_mask[{1'b1, i_smp_ch}] ? {{6{w_xb[15]}}, w_xb} : 22'd0);
+  assign w_pair_n = i_mask[{1'b0, i_smp_ch}] + i_mask[{1'b1, i_smp_ch}];
+
+  assign w_rem_sh = {r_rem[6:0], r_quot[21]};
+  assign w_mean = (r_div_n == 0) ? 17'd0 :
+                  r_neg ? 17'd0 - {1'b0, r_quot[15:0]} : {1'b0, r_quot[15:0]};
+
+  // Purpose: Frame buffer, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (i_smp_valid & w_en) begin
+      r_buf[{r_wr_bank, i_smp_ch}] <= i_smp_data;
+    end
+    r_buf_q <= r_buf[{r_rd_bank, r_cnt}];
+  end
+
+  // Purpose: Store the frame and sum the channels of i_mask
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_en <= 1'b0;
+      r_wr_bank <= 1'b0;
+      r_wr_n <= 0;
+      r_flags[0] <= 0;
+      r_flags[1] <= 0;
+      r_sum <= 0;
+      r_n <= 0;
+    end else begin
+      if (i_smp_valid) begin
+        r_en <= w_en;
+        if (w_en) begin
+          r_wr_n <= i_smp_sof ? 6'd1 : r_wr_n + 1'b1;
+          if (i_smp_sof) begin
+            r_flags[r_wr_bank] <= i_smp_flags;
+          end
+        end
+        r_sum <= i_smp_sof ? w_pair_sum : r_sum + w_pair_sum;
+        r_n <= i_smp_sof ? w_pair_n : r_n + w_pair_n;
+        if (i_smp_eof & w_en) begin
+          r_wr_bank <= ~r_wr_bank;
+        end
+      end
+    end
+  end
+
+  // Purpose: Divide the sum once the frame is complete, then replay it
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_rd_bank <= 1'b0;
+      r_play <= 1'b0;
+      r_drain <= 1'b0;
+      r_drain_bank <= 1'b0;
+      r_cnt <= 0;
+      r_pace <= 0;
+      r_rd_valid <= 1'b0;
+      r_rd_ch <= 0;
+      r_neg <= 1'b0;
+      r_quot <= 0;
+      r_rem <= 0;
+      r_div <= 0;
+      r_div_n <= 0;
+      r_mean <= 0;
+      o_mean <= 16'h8000;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      r_rd_valid <= 1'b0;
+
+      // Bypass
+      if (i_smp_valid & ~w_en) begin
+        o_smp_valid <= 1'b1;
+        o_smp_ch <= i_smp_ch;
+        o_smp_data <= i_smp_data;
+        o_smp_sof <= i_smp_sof;
+        o_smp_eof <= i_smp_eof;
+        if (i_smp_sof) begin
+          o_smp_flags <= i_smp_flags;
+        end
+      end
+
+      // Replayed pair, one clock cycle after its read
+      if (r_rd_valid) begin
+        o_smp_valid <= 1'b1;
+        o_smp_ch <= r_rd_ch;
+        o_smp_data <= {sub_mean(r_buf_q[31:16], r_mean), sub_mean(r_buf_q[15:0], r_mean)};
+        o_smp_sof <= (r_rd_ch == 5'd0);
+        o_smp_eof <= (r_rd_ch == 5'd31);
+        if (r_rd_ch == 5'd0) begin
+          o_smp_flags <= r_flags[r_rd_bank];
+        end
+      end
+
+      if (i_smp_valid & i_smp_sof & r_en & ~i_ctrl & w_busy) begin
+        r_drain <= 1'b1;
+        r_drain_bank <= r_wr_bank;
+      end
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (r_drain) begin
+          // Replay the frame being stored as it arrives, unchanged
+          r_drain <= 1'b0;
+          r_rd_bank <= r_drain_bank;
+          r_mean <= 0;
+          r_cnt <= 0;
+          r_pace <= 0;
+          r_sm <= DRAIN;
+        end else if (i_smp_valid & i_smp_eof) begin
+          r_rd_bank <= r_wr_bank;
+          r_play <= w_en;
+          r_sm <= LOAD;
+        end
+      end
+      LOAD:
+      begin
+        // Sign and magnitude of the complete sum
+        r_neg <= r_sum < 0;
+        r_quot <= (r_sum < 0) ? 22'd0 - r_sum : r_sum;
+        r_rem <= 0;
+        r_div <= 0;
+        r_div_n <= r_n;
+        r_cnt <= 0;
+        r_pace <= 0;
+        r_sm <= DIV;
+      end
+      DIV:
+      begin
+        // Restoring division by the number of channels, one bit per cycle
+        if (w_rem_sh >= {1'b0, r_div_n}) begin
+          r_rem <= w_rem_sh - r_div_n;
+          r_quot <= {r_quot[20:0], 1'b1};
+        end else begin
+          r_rem <= w_rem_sh;
+          r_quot <= {r_quot[20:0], 1'b0};
+        end
+        r_div <= r_div + 1'b1;
+        if (r_div == 7'd21) begin
+          r_sm <= PLAY;
+        end
+      end
+      PLAY:
+      begin
+        if (r_div == 7'd22) begin
+          // Quotient ready
+          r_div <= r_div + 1'b1;
+          r_mean <= w_mean;
+          o_mean <= {~w_mean[15], w_mean[14:0]};
+          if (~r_play) begin
+            // Frame went through the bypass or was drained, nothing to replay
+            r_sm <= IDLE;
+          end
+        end else if (r_pace == PAIR_CLKS-1) begin
+          r_pace <= 0;
+          r_rd_valid <= 1'b1;
+          r_rd_ch <= r_cnt;
+          r_cnt <= r_cnt + 1'b1;
+          if (r_cnt == 5'd31) begin
+            r_sm <= IDLE;
+          end
+        end else begin
+          r_pace <= r_pace + 1'b1;
+        end
+      end
+      DRAIN:
+      begin
+        // Pairs are replayed once stored, the mean of the frame is still
+        // computed once it is complete
+        if (r_pace != PAIR_CLKS-1) begin
+          r_pace <= r_pace + 1'b1;
+        end else if ({1'b0, r_cnt} < r_wr_n) begin
+          r_pace <= 0;
+          r_rd_valid <= 1'b1;
+          r_rd_ch <= r_cnt;
+          r_cnt <= r_cnt + 1'b1;
+          if (r_cnt == 5'd31) begin
+            r_play <= 1'b0;
+            r_sm <= LOAD;
+          end
+        end
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_car
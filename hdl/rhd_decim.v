@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: CIC decimator
+//              Decimates every channel of the sample stream by R = 2^i_ctrl,
+//              from 2 to 64, with an ORDER-stage CIC filter. The chip can
+//              then be oversampled at its maximum rate for anti-aliasing
+//              while only one frame out of R leaves the stage, which cuts
+//              the downstream bandwidth by R and lowers the noise floor.
+//
+//              The CIC gain R^ORDER is removed with a shift, so the output
+//              keeps the scale of the input. Since R is a power of two the
+//              normalization is exact.
+//
+//              Integrators run on every frame, combs only on the output
+//              frames (the last of every R frames). The per-channel states
+//              are kept in BRAM and a single datapath is time-multiplexed
+//              over both lanes of every pair, which takes 3 clock cycles.
+//              Wrap-around in the integrators is harmless, so after changing
+//              the ratio the output is exact again after ORDER output frames.
+//
+//              The frame flags of an output frame are the OR of those of its
+//              R input frames, so that a short TTL pulse or an overrun is not
+//              lost with the dropped frames.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl): [2:0] log2 of the decimation ratio,
+//              0 lets the stream through unchanged, 7 is taken as 6.
+//
+// Parameters:  ORDER - Number of integrator and comb stages
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_decim #(
+  parameter ORDER = 3
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [2:0] i_ctrl,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  // Bit growth is ORDER*log2(R), up to 6 bits per stage
+  localparam W = 16 + ORDER*6;
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // {combs, integrators} per lane and channel
+  reg [2*ORDER*W-1:0] r_state [0:63];
+  reg [2*ORDER*W-1:0] r_state_q;
+  reg [2*ORDER*W-1:0] r_state_next; // Combinational
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_sof;
+  reg r_eof;
+  reg [15:0] r_flags;
+  reg r_out;   // Current pair belongs to an output frame
+  reg [15:0] r_y_a;
+  reg [5:0] r_phase;
+  reg [2:0] r_ctrl;
+
+  reg [W-1:0] r_cic; // Combinational
+
+  wire [2:0] w_log2;
+  wire [5:0] w_rd_addr;
+  wire [15:0] w_x;
+  wire [W-1:0] w_shifted;
+  wire [15:0] w_y;
+  wire w_out_frame;
+
+  integer i;
+  integer k;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_state[i] = 0;
+    end
+  end
+
+  // R is at most 64, which the state width is sized for
+  assign w_log2 = (i_ctrl == 3'd7) ? 3'd6 : i_ctrl;
+
+  // Last frame of every R frames
+  assign w_out_frame = (r_phase == (6'd1 << w_log2) - 1'b1);
+
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+  assign w_x = (r_sm == LANE_A) ? r_data[15:0] : r_data[31:16];
+
+  // Purpose: Integrators then combs, on the lane being processed
+  always @(*) begin
+    r_state_next = r_state_q;
+    r_cic = {{(W-16){~w_x[15]}}, ~w_x[15], w_x[14:0]};
+    for (k = 0; k < ORDER; k = k + 1) begin
+      r_cic = r_state_q[k*W +: W] + r_cic;
+      r_state_next[k*W +: W] = r_cic;
+    end
+    if (r_out) begin
+      for (k = 0; k < ORDER; k = k + 1) begin
+        r_state_next[(ORDER+k)*W +: W] = r_cic;
+        r_cic = r_cic - r_state_q[(ORDER+k)*W +: W];
+      end
+    end
+  end
+
+  // Remove the R^ORDER gain
+  assign w_shifted = r_cic >> (ORDER * w_log2);
+  assign w_y = {~w_shifted[15], w_shifted[14:0]};
+
+  // Purpose: CIC states, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (r_sm != IDLE) begin
+      r_state[{r_sm == LANE_B, r_ch}] <= r_state_next;
+    end
+    r_state_q <= r_state[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair, keep one frame out of R
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_out <= 1'b0;
+      r_y_a <= 0;
+      r_phase <= 0;
+      r_ctrl <= 0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      r_ctrl <= w_log2;
+
+      if (r_ctrl != w_log2) begin
+        // Realign the output frames on the new ratio
+        r_phase <= 0;
+      end
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          r_out <= w_out_frame;
+          if (i_smp_sof) begin
+            r_flags <= ((r_phase == 0) ? 16'b0 : r_flags) | i_smp_flags;
+          end
+          r_sm <= LANE_A;
+        end
+      end
+      LANE_A:
+      begin
+        r_y_a <= w_y;
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        if (r_eof & (r_ctrl == w_log2)) begin
+          r_phase <= w_out_frame ? 6'd0 : r_phase + 1'b1;
+        end
+        if (i_ctrl == 0) begin
+          o_smp_valid <= 1'b1;
+          o_smp_data <= r_data;
+        end else begin
+          o_smp_valid <= r_out;
+          o_smp_data <= {w_y, r_y_a};
+        end
+        o_smp_ch <= r_ch;
+        o_smp_sof <= r_sof;
+        o_smp_eof <= r_eof;
+        if (r_sof & (r_out | (i_ctrl == 0))) begin
+          o_smp_flags <= r_flags;
+        end
+        r_sm <= IDLE;
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_decim
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Threshold detector
+//              Compares every channel of the sample stream to a threshold and
+//              drives o_detect straight from the PL, so that closed-loop
+//              stimulation reacts a few clock cycles after the sample comes
+//              out of the chip instead of after a PS round trip.
+//
+//              A crossing is a sample whose absolute value (distance to
+//              0x8000) goes above the threshold of its channel while the
+//              previous one was below. A crossing on a channel of i_mask
+//              holds o_detect high for i_pulse_len clock cycles and is
+//              recorded in the event ring.
+//
+//              The thresholds are either fixed, written per channel through
+//              i_thr_wr/i_thr_addr/i_thr_data (0xFFFF after reset, which
+//              never triggers), or adaptive: i_adapt_k (Q4.4) times the
+//              running mean of the absolute value of the channel. The mean is
+//              an exponential average with a time constant of 2^i_tau frames.
+//              For Gaussian noise it is about 0.8 sigma, so i_adapt_k = 0x50
+//              puts the threshold around 4 sigma.
+//
+//              Each event is {channel[31:26], frame[25:0]}, frame being the
+//              number of frames since reset. Events are written to a ring of
+//              2^EVT_BITS entries at o_evt_count modulo the ring size, so the
+//              PS reads the entries between the count it saw last and the
+//              current one, and detects an overflow when they are more than
+//              2^EVT_BITS apart. The read port has one clock cycle of latency.
+//
+//              A single datapath is time-multiplexed over both lanes of every
+//              pair, with the per-channel states kept in BRAM, which takes 3
+//              clock cycles.
+//
+//              Control bits (i_ctrl):
+//              [0] enable o_detect and the event ring
+//              [1] adaptive thresholds instead of the fixed ones
+//
+// Parameters:  EVT_BITS - log2 of the event ring size
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_detect #(
+  parameter EVT_BITS = 10
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [1:0]  i_ctrl,
+  input [63:0] i_mask,      // Channels that trigger o_detect and events
+  input [7:0]  i_adapt_k,   // Adaptive threshold gain, Q4.4
+  input [3:0]  i_tau,       // Noise averaging time constant, 2^i_tau frames
+  input [15:0] i_pulse_len, // Clock cycles o_detect stays high
+
+  // Fixed thresholds
+  input        i_thr_wr,
+  input [5:0]  i_thr_addr,
+  input [15:0] i_thr_data,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_eof,
+
+  // Detection output
+  output reg o_detect,
+
+  // Event ring
+  output reg [31:0]    o_evt_count,
+  input [EVT_BITS-1:0] i_evt_addr,
+  output reg [31:0]    o_evt_data
+);
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // {above, mean(|x|) in Q16.8} per channel
+  reg [24:0] r_state [0:63];
+  reg [24:0] r_state_q;
+
+  reg [15:0] r_thr [0:63];
+  reg [15:0] r_thr_q;
+
+  reg [31:0] r_evt [0:(1 << EVT_BITS)-1];
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_eof;
+  reg [25:0] r_frame;
+  reg [15:0] r_pulse;
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire [15:0] w_x;
+  wire [15:0] w_ax;
+  wire [23:0] w_mean;
+  wire [23:0] w_adapt;
+  wire [19:0] w_thr;
+  wire w_above;
+  wire w_cross;
+  wire signed [24:0] w_diff;
+  wire signed [24:0] w_step;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_state[i] = 0;
+      r_thr[i] = 16'hFFFF;
+    end
+  end
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+
+  // Datapath, shared by both lanes
+  assign w_x = w_lane ? {~r_data[31], r_data[30:16]} : {~r_data[15], r_data[14:0]};
+  assign w_ax = w_x[15] ? 16'd0 - w_x : w_x;
+  assign w_mean = r_state_q[23:0];
+  assign w_adapt = w_mean[23:8] * i_adapt_k;
+  assign w_thr = i_ctrl[1] ? w_adapt[23:4] : {4'b0, r_thr_q};
+  assign w_above = ({4'b0, w_ax} > w_thr);
+  assign w_cross = w_above & ~r_state_q[24] & i_mask[{w_lane, r_ch}] & i_ctrl[0];
+
+  // Exponential average of |x|
+  assign w_diff = {1'b0, w_ax, 8'b0} - {1'b0, w_mean};
+  assign w_step = w_diff >>> i_tau;
+
+  // Purpose: Channel states and event ring, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (r_sm != IDLE) begin
+      r_state[{w_lane, r_ch}] <= {w_above, w_mean + w_step[23:0]};
+    end
+    r_state_q <= r_state[w_rd_addr];
+
+    if (i_thr_wr) begin
+      r_thr[i_thr_addr] <= i_thr_data;
+    end
+    r_thr_q <= r_thr[w_rd_addr];
+
+    if ((r_sm != IDLE) & w_cross) begin
+      r_evt[o_evt_count[EVT_BITS-1:0]] <= {w_lane, r_ch, r_frame};
+    end
+    o_evt_data <= r_evt[i_evt_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair, drive the detection output
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_eof <= 1'b0;
+      r_frame <= 0;
+      r_pulse <= 0;
+      o_detect <= 1'b0;
+      o_evt_count <= 0;
+    end else begin
+      if ((r_sm != IDLE) & w_cross) begin
+        r_pulse <= i_pulse_len;
+        o_detect <= (i_pulse_len != 0);
+        o_evt_count <= o_evt_count + 1'b1;
+      end else if (r_pulse > 1) begin
+        r_pulse <= r_pulse - 1'b1;
+      end else begin
+        r_pulse <= 0;
+        o_detect <= 1'b0;
+      end
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_eof <= i_smp_eof;
+          r_sm <= LANE_A;
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        if (r_eof) begin
+          r_frame <= r_frame + 1'b1;
+        end
+        r_sm <= IDLE;
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_detect
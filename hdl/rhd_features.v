@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: EMG time-domain feature engine
+//              Computes the standard windowed EMG features of every channel of
+//              the sample stream over the last W = 2^i_win frames, and
+//              publishes them every i_hop frames as a feature frame:
+//                MAV  mean absolute value, sum(|x|) / W
+//                MS   mean square, sum(x^2) / W. RMS is its square root, left
+//                     to the PS since it is a single operation per channel
+//                WL   waveform length, sum(|x[n] - x[n-1]|)
+//                ZC   zero crossings with |x[n] - x[n-1]| >= i_thresh
+//                SSC  slope sign changes with either slope >= i_thresh
+//
+//              The features are running sums over a sliding window: every
+//              frame adds the contribution of the new sample and removes the
+//              one of the sample that leaves the window, read back from a
+//              history ring in BRAM. The window and the hop are thus
+//              independent, and the windows may overlap.
+//
+//              A single datapath is time-multiplexed over both lanes of every
+//              pair, which takes 3 clock cycles, with the running sums kept
+//              in BRAM. The history takes 2^WIN_BITS * 64 * 16 bits, so long
+//              windows are best used with rhd_decim.v.
+//
+//              i_win, i_hop and i_thresh are latched when the engine is
+//              enabled, at the start of a frame. The first feature frame is
+//              published once the window is full.
+//
+//              Memory map of the read port (32-bit words), the features being
+//              double buffered so a feature frame is never read half updated:
+//              4n + 0    MAV of channel n, n = 0 to 63
+//              4n + 1    MS of channel n
+//              4n + 2    WL of channel n
+//              4n + 3    {ZC[15:0], SSC[15:0]} of channel n
+//              256       generation, incremented with each feature frame
+//
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address =
+//              byte address [10:2]). o_feat_ready pulses when a feature frame
+//              is published and can be used as an interrupt.
+//
+//              Samples are offset binary (0x8000 = 0).
+//
+//              Control bits (i_ctrl): [0] enable, the sums are cleared while
+//              it is low.
+//
+// Parameters:  WIN_BITS - log2 of the longest window, in frames, up to 15
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_features #(
+  parameter WIN_BITS = 9
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [3:0]  i_win,    // log2 of the window length, 1 to WIN_BITS
+  input [15:0] i_hop,    // Frames between feature frames, 0 = 1
+  input [15:0] i_thresh, // ZC and SSC threshold
+  output reg   o_feat_ready,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+
+  // Read port
+  input             i_rd_en,
+  input [8:0]       i_rd_addr,
+  output reg [31:0] o_rd_data
+);
+
+  localparam SA_W = 16 + WIN_BITS; // sum(|x|)
+  localparam SQ_W = 31 + WIN_BITS; // sum(x^2)
+  localparam WL_W = 16 + WIN_BITS; // sum(|x[n] - x[n-1]|)
+  localparam CN_W = 1 + WIN_BITS;  // ZC and SSC counts
+  localparam ACC_W = SA_W + SQ_W + WL_W + 2*CN_W;
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // Samples of the last 2^WIN_BITS frames
+  reg [15:0] r_hist [0:(64 << WIN_BITS)-1];
+  reg [15:0] r_hist_q;
+
+  // {x[n-1], x[n-2], o[n-1], o[n-2]}, o being the samples leaving the window
+  reg [63:0] r_prev [0:63];
+  reg [63:0] r_prev_q;
+
+  // {sum(|x|), sum(x^2), WL, ZC, SSC}
+  reg [ACC_W-1:0] r_acc [0:63];
+  reg [ACC_W-1:0] r_acc_q;
+
+  // Feature frames, {MAV, MS, WL, {ZC, SSC}} per bank and channel
+  reg [127:0] r_feat [0:127];
+  reg r_vis;   // Bank visible on the read port
+  reg [31:0] r_gen;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_eof;
+
+  reg r_run;
+  reg [3:0] r_win;
+  reg [15:0] r_hop;
+  reg [15:0] r_thresh;
+  reg [WIN_BITS:0] r_fill;  // Frames in the window, saturates at W
+  reg [15:0] r_hop_cnt;
+  reg [WIN_BITS-1:0] r_ptr; // History slot of the current frame
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire [WIN_BITS:0] w_len;
+  wire w_full;  // Window holds W frames once this one is added
+  wire w_sub;   // A sample leaves the window
+  wire w_pub;   // This frame completes a feature frame
+  wire [WIN_BITS-1:0] w_old_ptr;
+
+  wire [15:0] w_x;
+  wire [15:0] w_x1;
+  wire [15:0] w_x2;
+  wire [15:0] w_o1;
+  wire [15:0] w_o2;
+  wire [66:0] w_new;
+  wire [66:0] w_old;
+
+  wire [SA_W-1:0] w_sa;
+  wire [SQ_W-1:0] w_sq;
+  wire [WL_W-1:0] w_wl;
+  wire [CN_W-1:0] w_zc;
+  wire [CN_W-1:0] w_ssc;
+  wire [ACC_W-1:0] w_acc_next;
+  wire [63:0] w_prev_next;
+  wire [31:0] w_mav;
+  wire [31:0] w_ms;
+  wire [31:0] w_wl_out;
+  wire [15:0] w_zc_out;
+  wire [15:0] w_ssc_out;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_prev[i] = 0;
+      r_acc[i] = 0;
+    end
+  end
+
+  // {|x|, x^2, |x - x1|, zero crossing, slope sign change} of sample x, x1 and
+  // x2 being the two samples before it, all signed
+  function [66:0] contrib;
+    input [15:0] x;
+    input [15:0] x1;
+    input [15:0] x2;
+    input [15:0] thr;
+    reg [16:0] ax;
+    reg [31:0] sq;
+    reg [16:0] d1; // x - x1
+    reg [16:0] d2; // x1 - x2
+    reg [16:0] a1;
+    reg [16:0] a2;
+    reg zc;
+    reg ssc;
+    begin
+      ax = x[15] ? 17'd0 - {x[15], x} : {1'b0, x};
+      sq = ax[15:0] * ax[15:0];
+      d1 = {x[15], x} - {x1[15], x1};
+      d2 = {x1[15], x1} - {x2[15], x2};
+      a1 = d1[16] ? 17'd0 - d1 : d1;
+      a2 = d2[16] ? 17'd0 - d2 : d2;
+      zc = ((x[15] & ~x1[15] & (x1 != 0)) | (~x[15] & (x != 0) & x1[15]))
+           & (a1 >= {1'b0, thr});
+      ssc = ((~d2[16] & (d2 != 0) & d1[16]) | (d2[16] & ~d1[16] & (d1 != 0)))
+            & ((a1 >= {1'b0, thr}) | (a2 >= {1'b0, thr}));
+      contrib = {ax, sq[30:0], a1, zc, ssc};
+    end
+  endfunction
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+
+  assign w_len = 1 << r_win;
+  assign w_full = (r_fill >= w_len - 1'b1);
+  assign w_sub = (r_fill == w_len);
+  assign w_pub = r_run & w_full & (r_hop_cnt == 0);
+  assign w_old_ptr = r_ptr - w_len[WIN_BITS-1:0];
+
+  // Datapath, shared by both lanes
+  assign w_x = w_lane ? {~r_data[31], r_data[30:16]} : {~r_data[15], r_data[14:0]};
+  assign {w_x1, w_x2, w_o1, w_o2} = r_prev_q;
+  assign w_new = contrib(w_x, w_x1, w_x2, r_thresh);
+  assign w_old = w_sub ? contrib(r_hist_q, w_o1, w_o2, r_thresh) : 67'b0;
+
+  assign {w_sa, w_sq, w_wl, w_zc, w_ssc} = r_acc_q;
+  assign w_acc_next = ~r_run ? {ACC_W{1'b0}} :
+                      {w_sa + w_new[66:50] - w_old[66:50],
+                       w_sq + w_new[49:19] - w_old[49:19],
+                       w_wl + w_new[18:2] - w_old[18:2],
+                       w_zc + w_new[1] - w_old[1],
+                       w_ssc + w_new[0] - w_old[0]};
+
+  // The leaving samples follow the input until the window starts filling
+  assign w_prev_next = ~r_run ? {w_x, w_x1, w_x, w_x1} :
+                       w_sub ? {w_x, w_x1, r_hist_q, w_o1} :
+                               {w_x, w_x1, w_o1, w_o2};
+
+  // Feature words
+  assign w_mav = w_acc_next[ACC_W-1 -: SA_W] >> r_win;
+  assign w_ms = w_acc_next[ACC_W-SA_W-1 -: SQ_W] >> r_win;
+  assign w_wl_out = w_acc_next[2*CN_W +: WL_W];
+  assign w_zc_out = w_acc_next[CN_W +: CN_W];
+  assign w_ssc_out = w_acc_next[0 +: CN_W];
+
+  // Purpose: History ring and running sums, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (r_sm != IDLE) begin
+      r_hist[{r_ptr, w_lane, r_ch}] <= w_x;
+      r_prev[{w_lane, r_ch}] <= w_prev_next;
+      r_acc[{w_lane, r_ch}] <= w_acc_next;
+      if (w_pub) begin
+        r_feat[{~r_vis, w_lane, r_ch}] <= {w_mav, w_ms, w_wl_out, w_zc_out, w_ssc_out};
+      end
+    end
+    r_hist_q <= r_hist[{w_old_ptr, w_rd_addr}];
+    r_prev_q <= r_prev[w_rd_addr];
+    r_acc_q <= r_acc[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair, window and hop bookkeeping
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_eof <= 1'b0;
+      r_run <= 1'b0;
+      r_win <= 1;
+      r_hop <= 1;
+      r_thresh <= 0;
+      r_fill <= 0;
+      r_hop_cnt <= 0;
+      r_ptr <= 0;
+      r_vis <= 1'b0;
+      r_gen <= 0;
+      o_feat_ready <= 1'b0;
+    end else begin
+      o_feat_ready <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_eof <= i_smp_eof;
+          r_sm <= LANE_A;
+
+          // Start and stop on frame boundaries only
+          if (i_smp_sof) begin
+            r_run <= i_ctrl;
+            if (i_ctrl & ~r_run) begin
+              r_win <= (i_win == 0) ? 4'd1 : (i_win > WIN_BITS) ? WIN_BITS : i_win;
+              r_hop <= (i_hop == 0) ? 16'd1 : i_hop;
+              r_thresh <= i_thresh;
+              r_fill <= 0;
+              r_hop_cnt <= 0;
+            end
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        r_sm <= IDLE;
+        if (r_eof) begin
+          r_ptr <= r_ptr + 1'b1;
+          if (r_run) begin
+            if (~w_sub) begin
+              r_fill <= r_fill + 1'b1;
+            end
+            if (w_full) begin
+              r_hop_cnt <= (r_hop_cnt == r_hop - 1'b1) ? 16'd0 : r_hop_cnt + 1'b1;
+            end
+            if (w_pub) begin
+              r_vis <= ~r_vis;
+              r_gen <= r_gen + 1'b1;
+              o_feat_ready <= 1'b1;
+            end
+          end
+        end
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+  // Purpose: Read port
+  always @(posedge i_clk) begin
+    if (i_rd_en) begin
+      if (i_rd_addr[8]) begin
+        o_rd_data <= r_gen;
+      end else begin
+        o_rd_data <= r_feat[{r_vis, i_rd_addr[7:2]}] >> (32 * (3 - i_rd_addr[1:0]));
+      end
+    end
+  end
+
+endmodule // rhd_features
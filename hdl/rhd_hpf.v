@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Per-channel DC-removal high-pass filter
+//              First-order high-pass on every channel of the sample stream,
+//              removing the electrode offset in the PL:
+//                y[n]   = x[n] - s[n]
+//                s[n+1] = s[n] + k * y[n]
+//              with s the per-channel offset estimate in Q16.16 and k = i_coef
+//              / 65536. The -3 dB cutoff is about k * fs / (2 * pi), fs being
+//              the frame rate.
+//
+//              A single multiply-add datapath is time-multiplexed over all 64
+//              channels: each {dout_b, dout_a} pair goes through it lane A
+//              first, then lane B, with the filter states kept in BRAM. A pair
+//              comes out 3 clock cycles after it went in, so pairs must be at
+//              least 3 cycles apart, which any SPI clock divider guarantees.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl):
+//              [0] enable, the stream goes through unchanged when cleared
+//              [1] load, the states take the value of the incoming samples and
+//                  the output is 0. Set it for one frame to start without the
+//                  offset transient.
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_hpf (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [1:0]  i_ctrl,
+  input [15:0] i_coef,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  reg [31:0] r_state [0:63];
+  reg [31:0] r_state_q;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_sof;
+  reg r_eof;
+  reg [15:0] r_flags;
+  reg [15:0] r_y_a;
+
+  wire [5:0] w_rd_addr;
+  wire [15:0] w_x;
+  wire signed [15:0] w_xs;
+  wire signed [16:0] w_diff;
+  wire signed [15:0] w_y;
+  wire signed [32:0] w_prod;
+  wire [31:0] w_state_next;
+  wire [15:0] w_out;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_state[i] = 0;
+    end
+  end
+
+  // Lane A of the incoming pair, then lane B of the stored one
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+
+  // Datapath, shared by both lanes
+  assign w_x = (r_sm == LANE_A) ? r_data[15:0] : r_data[31:16];
+  assign w_xs = {~w_x[15], w_x[14:0]};
+  assign w_diff = w_xs - $signed(r_state_q[31:16]);
+  assign w_y = (w_diff[16] != w_diff[15]) ? {w_diff[16], {15{~w_diff[16]}}} // Saturate
+                                          : w_diff[15:0];
+  assign w_prod = w_y * $signed({1'b0, i_coef});
+  assign w_state_next = i_ctrl[1] ? {w_xs, 16'b0} : r_state_q + w_prod[31:0];
+  assign w_out = i_ctrl[1] ? 16'h8000 : {~w_y[15], w_y[14:0]};
+
+  // Purpose: Filter states, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (i_ctrl[0] & (r_sm != IDLE)) begin
+      r_state[{r_sm == LANE_B, r_ch}] <= w_state_next;
+    end
+    r_state_q <= r_state[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair through the datapath
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_y_a <= 0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          if (i_smp_sof) begin
+            r_flags <= i_smp_flags;
+          end
+          r_sm <= LANE_A;
+        end
+      end
+      LANE_A:
+      begin
+        r_y_a <= w_out;
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        o_smp_valid <= 1'b1;
+        o_smp_ch <= r_ch;
+        o_smp_data <= i_ctrl[0] ? {w_out, r_y_a} : r_data;
+        o_smp_sof <= r_sof;
+        o_smp_eof <= r_eof;
+        if (r_sof) begin
+          o_smp_flags <= r_flags;
+        end
+        r_sm <= IDLE;
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_hpf
@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Powerline notch filter bank
+//              Cascade of N_SECTIONS biquads applied to every channel of the
+//              sample stream, typically a 50/60 Hz notch on the first section
+//              and its harmonics on the others:
+//                y = b0*x + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+//
+//              Coefficients are signed Q2.14 (16384 = 1.0). For a notch at f0
+//              with pole radius r (closer to 1 = narrower), w0 = 2*pi*f0/fs:
+//                b0 = b2 = 1, b1 = -2*cos(w0), a1 = -2*r*cos(w0), a2 = r^2
+//
+//              They are written at runtime through i_coef_wr/i_coef_addr/
+//              i_coef_data, at address {section, tap} with tap 0 to 4 for b0,
+//              b1, b2, a1, a2. Writes go to a shadow table, and a rising edge
+//              on the commit bit of i_ctrl copies it to the active table at
+//              the next start of frame. An update spanning several words and
+//              frames is thus applied all at once, and a frame is never
+//              filtered with a mix of old and new coefficients. After reset
+//              every section is a passthrough (b0 = 1).
+//
+//              A single multiply-accumulate datapath is time-multiplexed over
+//              all channels, lanes and sections, with the x[n-1], x[n-2],
+//              y[n-1], y[n-2] states kept in BRAM. A pair takes
+//              14*N_SECTIONS+1 clock cycles, which must be shorter than a SPI
+//              transfer: a clock divider of 1 is enough for 2 sections.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl):
+//              [s]           enables section s, a disabled section passes its
+//                            input through
+//              [N_SECTIONS]  commit the coefficients written since the last
+//                            commit, rising edge
+//
+// Parameters:  N_SECTIONS - Number of biquads in the cascade, 1 to 4
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_notch #(
+  parameter N_SECTIONS = 2
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [N_SECTIONS:0] i_ctrl,
+
+  // Coefficient table
+  input        i_coef_wr,
+  input [4:0]  i_coef_addr, // {section, tap}
+  input [15:0] i_coef_data,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  localparam IDLE = 2'b00;
+  localparam RD   = 2'b01;
+  localparam MAC  = 2'b10;
+  localparam WB   = 2'b11;
+
+  // {x[n-1], x[n-2], y[n-1], y[n-2]} per section, lane and channel
+  reg [63:0] r_state [0:N_SECTIONS*64-1];
+  reg [63:0] r_state_q;
+
+  reg [15:0] r_coef [0:31];
+  reg [15:0] r_coef_sh [0:31];
+  reg r_dirty;   // Committed, applied at the next start of frame
+  reg r_ctrl_c;
+
+  reg [1:0] r_sm;
+  reg [1:0] r_sec;
+  reg r_lane;
+  reg [2:0] r_tap;
+  reg signed [35:0] r_acc;
+  reg signed [15:0] r_x; // Input of the current section
+
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_sof;
+  reg r_eof;
+  reg [15:0] r_flags;
+  reg [15:0] r_y_a;
+
+  wire [7:0] w_addr;
+  wire signed [15:0] w_coef;
+  wire signed [15:0] w_op;
+  wire signed [31:0] w_prod;
+  wire signed [35:0] w_acc_r;
+  wire signed [15:0] w_y;
+  wire w_en;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < N_SECTIONS*64; i = i + 1) begin
+      r_state[i] = 0;
+    end
+  end
+
+  assign w_addr = {r_sec, r_lane, r_ch};
+  assign w_en = i_ctrl[r_sec];
+
+  // Operand of the current tap
+  assign w_coef = r_coef[{r_sec, r_tap}];
+  assign w_op = (r_tap == 3'd0) ? r_x :
+                (r_tap == 3'd1) ? r_state_q[63:48] :
+                (r_tap == 3'd2) ? r_state_q[47:32] :
+                (r_tap == 3'd3) ? r_state_q[31:16] :
+                                  r_state_q[15:0];
+  assign w_prod = w_coef * w_op;
+
+  // Round, scale back from Q2.14 and saturate
+  assign w_acc_r = r_acc + 36'sd8192;
+  assign w_y = ((&w_acc_r[35:29]) | ~(|w_acc_r[35:29])) ? w_acc_r[29:14]
+                                                        : {w_acc_r[35], {15{~w_acc_r[35]}}};
+
+  // Purpose: Filter states, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if ((r_sm == WB) & w_en) begin
+      r_state[w_addr] <= {r_x, r_state_q[63:48], w_y, r_state_q[31:16]};
+    end
+    r_state_q <= r_state[w_addr];
+  end
+
+  // Purpose: Coefficient table, committed at the start of a frame
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_dirty <= 1'b0;
+      r_ctrl_c <= 1'b0;
+      for (i = 0; i < 32; i = i + 1) begin
+        r_coef[i] <= (i % 8 == 0) ? 16'd16384 : 16'd0;
+        r_coef_sh[i] <= (i % 8 == 0) ? 16'd16384 : 16'd0;
+      end
+    end else begin
+      r_ctrl_c <= i_ctrl[N_SECTIONS];
+
+      if (i_coef_wr) begin
+        r_coef_sh[i_coef_addr] <= i_coef_data;
+      end
+
+      if (i_ctrl[N_SECTIONS] & ~r_ctrl_c) begin
+        r_dirty <= 1'b1;
+      end else if (r_dirty & i_smp_valid & i_smp_sof & (r_sm == IDLE)) begin
+        r_dirty <= 1'b0;
+        for (i = 0; i < 32; i = i + 1) begin
+          r_coef[i] <= r_coef_sh[i];
+        end
+      end
+    end
+  end
+
+  // Purpose: Run every lane of the pair through every section
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_sec <= 0;
+      r_lane <= 1'b0;
+      r_tap <= 0;
+      r_acc <= 0;
+      r_x <= 0;
+      r_data <= 0;
+      r_ch <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_y_a <= 0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          if (i_smp_sof) begin
+            r_flags <= i_smp_flags;
+          end
+          r_sec <= 0;
+          r_lane <= 1'b0;
+          r_x <= {~i_smp_data[15], i_smp_data[14:0]};
+          r_sm <= RD;
+        end
+      end
+      RD:
+      begin
+        // State read is issued this cycle
+        r_tap <= 0;
+        r_acc <= 0;
+        r_sm <= MAC;
+      end
+      MAC:
+      begin
+        if (r_tap < 3'd3) begin
+          r_acc <= r_acc + w_prod;
+        end else begin
+          r_acc <= r_acc - w_prod;
+        end
+        r_tap <= r_tap + 1'b1;
+        if (r_tap == 3'd4) begin
+          r_sm <= WB;
+        end
+      end
+      WB:
+      begin
+        r_sm <= RD;
+        if (r_sec != N_SECTIONS-1) begin
+          r_sec <= r_sec + 1'b1;
+          r_x <= w_en ? w_y : r_x;
+        end else if (~r_lane) begin
+          r_sec <= 0;
+          r_lane <= 1'b1;
+          r_y_a <= w_en ? {~w_y[15], w_y[14:0]} : {~r_x[15], r_x[14:0]};
+          r_x <= {~r_data[31], r_data[30:16]};
+        end else begin
+          o_smp_valid <= 1'b1;
+          o_smp_ch <= r_ch;
+          o_smp_data <= {w_en ? {~w_y[15], w_y[14:0]} : {~r_x[15], r_x[14:0]}, r_y_a};
+          o_smp_sof <= r_sof;
+          o_smp_eof <= r_eof;
+          if (r_sof) begin
+            o_smp_flags <= r_flags;
+          end
+          r_sm <= IDLE;
+        end
+      end
+      endcase
+    end
+  end
+
+endmodule // rhd_notch
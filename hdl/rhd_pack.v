@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Dense 16-bit sample packer
+//              Packs the samples of the channels of i_mask back to back into
+//              64-bit beats for an AXI HP port, four samples per beat, first
+//              sample in the low 16 bits. Masked channels (unconnected
+//              electrodes, partially populated arrays) take no space, so the
+//              stream only holds useful samples.
+//
+//              Samples are packed in stream order (0, 32, 1, 33, ...),
+//              skipping the masked ones, and keep going from one frame to
+//              the next: a frame of n channels takes n/4 beats on average.
+//              When i_ctrl[1] is set, each frame starts on a new beat instead,
+//              the last beat of the frame being padded with zeros and flagged
+//              by o_beat_last.
+//
+//              When i_ctrl[2] is set, the frame flags (see rhd_sequencer.v)
+//              are packed as an extra 16-bit sample before the samples of
+//              each frame, so that the recording keeps the digital inputs.
+//
+//              i_mask is latched at the start of each frame. A pair is
+//              handled in a single clock cycle, and a beat is sent at most
+//              every other cycle.
+//
+//              Samples are offset binary (0x8000 = 0), unchanged.
+//
+//              Control bits (i_ctrl):
+//              [0] enable, applied at the start of a frame
+//              [1] align frames on beats
+//              [2] prepend the frame flags to each frame
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_pack (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [2:0]  i_ctrl,
+  input [63:0] i_mask, // Channels to keep
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Beat stream
+  output reg        o_beat_valid,
+  output reg [63:0] o_beat_data,
+  output reg        o_beat_last
+);
+
+  reg r_run;
+  reg r_align;
+  reg [63:0] r_mask;
+  reg [63:0] r_buf;
+  reg [1:0] r_n;      // Samples in r_buf
+  reg r_flush;
+
+  wire w_sof;
+  wire w_run;
+  wire [63:0] w_mask;
+  wire w_keep_a;
+  wire w_keep_b;
+  wire w_keep_flags;
+  wire w_more;        // Samples left in the frame after this pair
+  wire [1:0] w_k;
+  wire [31:0] w_pair;
+  wire [47:0] w_new;
+  wire [2:0] w_total;
+  wire [127:0] w_ext;
+  wire w_end;
+
+  // Frame settings switch at the start of a frame only
+  assign w_sof = i_smp_valid & i_smp_sof;
+  assign w_run = w_sof ? i_ctrl[0] : r_run;
+  assign w_mask = w_sof ? i_mask : r_mask;
+
+  assign w_keep_a = w_run & w_mask[i_smp_ch];
+  assign w_keep_b = w_run & w_mask[{1'b1, i_smp_ch}];
+  assign w_keep_flags = w_sof & i_ctrl[0] & i_ctrl[2];
+  assign w_more = |(((w_mask[31:0] | w_mask[63:32]) >> i_smp_ch) >> 1);
+
+  // New samples, compacted
+  assign w_k = w_keep_a + w_keep_b + w_keep_flags;
+  assign w_pair = (w_keep_a & w_keep_b) ? i_smp_data :
+                  w_keep_a ? {16'b0, i_smp_data[15:0]} : {16'b0, i_smp_data[31:16]};
+  assign w_new = w_keep_flags ? {w_pair, i_smp_flags} : {16'b0, w_pair};
+  assign w_total = r_n + w_k;
+  assign w_ext = {64'b0, r_buf} | ({80'b0, w_new} << (16 * r_n));
+
+  // Last pair of the frame holding samples, when aligning
+  assign w_end = (w_sof ? i_ctrl[1] : r_align) & ~w_more;
+
+  // Purpose: Append the samples of each pair, send full beats
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_run <= 1'b0;
+      r_align <= 1'b0;
+      r_mask <= 0;
+      r_buf <= 0;
+      r_n <= 0;
+      r_flush <= 1'b0;
+      o_beat_valid <= 1'b0;
+      o_beat_data <= 0;
+      o_beat_last <= 1'b0;
+    end else begin
+      o_beat_valid <= 1'b0;
+      o_beat_last <= 1'b0;
+      r_flush <= 1'b0;
+
+      if (w_sof) begin
+        r_run <= i_ctrl[0];
+        r_align <= i_ctrl[1];
+        r_mask <= i_mask;
+        if (~i_ctrl[0]) begin
+          r_buf <= 0;
+          r_n <= 0;
+        end
+      end
+
+      if (r_flush) begin
+        // Padded last beat of the frame
+        o_beat_valid <= 1'b1;
+        o_beat_data <= r_buf;
+        o_beat_last <= 1'b1;
+        r_buf <= 0;
+        r_n <= 0;
+      end else if (i_smp_valid & (w_k != 0)) begin
+        if (w_total[2]) begin
+          o_beat_valid <= 1'b1;
+          o_beat_data <= w_ext[63:0];
+          o_beat_last <= w_end & (w_total == 3'd4);
+          r_buf <= w_ext[127:64];
+          r_n <= w_total[1:0];
+          r_flush <= w_end & (w_total != 3'd4);
+        end else if (w_end) begin
+          o_beat_valid <= 1'b1;
+          o_beat_data <= w_ext[63:0];
+          o_beat_last <= 1'b1;
+          r_buf <= 0;
+          r_n <= 0;
+        end else begin
+          r_buf <= w_ext[63:0];
+          r_n <= w_total[1:0];
+        end
+      end
+    end
+  end
+
+endmodule // rhd_pack
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Loopback pattern generator
+//              Replaces the words received on MISO by synthetic data, so the
+//              whole downstream path can be run and checked for drops at full
+//              rate without a chip attached. The SPI transfers still run with
+//              the configured timing, only their result is replaced.
+//
+//              Like the RHD2164, the result of a command comes out two
+//              transfers later. The result of CONVERT(c) is, on lane A
+//              (channel c) and lane B (channel c + 32):
+//              mode 0  counter of the CONVERT results, A = n, B = ~n
+//              mode 1  per-channel ramp, x = frames + 1024 * channel, the
+//                      frames being counted at each CONVERT(0) result
+//              mode 2  PRBS, x^16 + x^14 + x^13 + x^11 + 1 (Galois, 0xB400)
+//                      seeded with 0xACE1, one step per sample, A first
+//              mode 3  channel number, x = {channel, channel}
+//              The result of any other command is 0. The counters and the
+//              PRBS restart when the generator is enabled.
+//
+//              Control bits (i_ctrl):
+//              [0]   enable
+//              [2:1] mode
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_pattern (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [2:0] i_ctrl,
+
+  // SPI master
+  input         i_start,   // First cycle of i_start
+  input  [15:0] i_din,
+  input  [15:0] i_dout_a,
+  input  [15:0] i_dout_b,
+  output [15:0] o_dout_a,
+  output [15:0] o_dout_b
+);
+
+  localparam COUNTER = 2'd0;
+  localparam RAMP    = 2'd1;
+  localparam PRBS    = 2'd2;
+  localparam CHANNEL = 2'd3;
+
+  reg r_run;
+  reg [15:0] r_cmd0;   // Command of the previous transfer
+  reg [15:0] r_cmd1;   // Command two transfers back, whose result comes now
+  reg [15:0] r_cnt;
+  reg [15:0] r_frames;
+  reg [15:0] r_prbs;
+  reg [15:0] r_dout_a;
+  reg [15:0] r_dout_b;
+
+  wire w_convert;
+  wire [5:0] w_ch;
+  wire [15:0] w_prbs_a;
+  wire [15:0] w_prbs_b;
+  wire [15:0] w_frames;
+
+  function [15:0] prbs_step;
+    input [15:0] s;
+    begin
+      prbs_step = {1'b0, s[15:1]} ^ (s[0] ? 16'hB400 : 16'h0000);
+    end
+  endfunction
+
+  assign o_dout_a = r_run ? r_dout_a : i_dout_a;
+  assign o_dout_b = r_run ? r_dout_b : i_dout_b;
+
+  assign w_convert = (r_cmd1[15:14] == 2'b00);
+  assign w_ch = r_cmd1[13:8];
+  assign w_prbs_a = prbs_step(r_prbs);
+  assign w_prbs_b = prbs_step(w_prbs_a);
+  assign w_frames = (w_ch == 0) ? r_frames + 1'b1 : r_frames;
+
+  // Purpose: Result of each transfer, set when it starts
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_run <= 1'b0;
+      r_cmd0 <= 16'hFFFF;
+      r_cmd1 <= 16'hFFFF;
+      r_cnt <= 0;
+      r_frames <= 0;
+      r_prbs <= 16'hACE1;
+      r_dout_a <= 0;
+      r_dout_b <= 0;
+    end else begin
+      r_run <= i_ctrl[0];
+
+      if (~r_run) begin
+        r_cmd0 <= 16'hFFFF;
+        r_cmd1 <= 16'hFFFF;
+        r_cnt <= 0;
+        r_frames <= 0;
+        r_prbs <= 16'hACE1;
+      end else if (i_start) begin
+        r_cmd0 <= i_din;
+        r_cmd1 <= r_cmd0;
+        r_dout_a <= 0;
+        r_dout_b <= 0;
+        if (w_convert) begin
+          r_cnt <= r_cnt + 1'b1;
+          r_frames <= w_frames;
+          r_prbs <= w_prbs_b;
+          case (i_ctrl[2:1])
+          COUNTER:
+          begin
+            r_dout_a <= r_cnt;
+            r_dout_b <= ~r_cnt;
+          end
+          RAMP:
+          begin
+            r_dout_a <= w_frames + {1'b0, w_ch[4:0], 10'b0};
+            r_dout_b <= w_frames + {1'b1, w_ch[4:0], 10'b0};
+          end
+          PRBS:
+          begin
+            r_dout_a <= w_prbs_a;
+            r_dout_b <= w_prbs_b;
+          end
+          default:
+          begin
+            r_dout_a <= {3'b0, w_ch[4:0], 3'b0, w_ch[4:0]};
+            r_dout_b <= {3'b001, w_ch[4:0], 3'b001, w_ch[4:0]};
+          end
+          endcase
+        end
+      end
+    end
+  end
+
+endmodule // rhd_pattern
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Min/max preview stream
+//              Reduces the sample stream to a preview stream for live display,
+//              next to the full-rate stream which is left untouched for
+//              recording. Every i_ratio frames, the preview stream holds the
+//              min and max of each channel over these frames, so that spikes
+//              and artifacts still show on a heavily decimated display:
+//                o_prv_data = {max[15:0], min[15:0]} of channel o_prv_ch
+//              The 64 channels are sent during the last frame of the
+//              interval, in stream order (0, 32, 1, 33, ...), o_prv_sof and
+//              o_prv_eof flagging the first and last one.
+//
+//              A single datapath is time-multiplexed over both lanes of every
+//              pair, which takes 3 clock cycles, with the running min and max
+//              kept in BRAM.
+//
+//              i_ratio is latched at the start of each interval.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl): [0] enable, applied at the start of a
+//              frame
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_preview (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [15:0] i_ratio, // Frames per preview frame, 0 = 1
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+
+  // Preview stream
+  output reg        o_prv_valid,
+  output reg [5:0]  o_prv_ch,
+  output reg [31:0] o_prv_data,
+  output reg        o_prv_sof,
+  output reg        o_prv_eof
+);
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // {max, min}
+  reg [31:0] r_mm [0:63];
+  reg [31:0] r_mm_q;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_sof;
+  reg r_eof;
+
+  reg r_run;
+  reg [15:0] r_ratio;
+  reg [15:0] r_cnt;   // Frames of the interval before this one
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire w_first;
+  wire w_last;
+
+  wire [15:0] w_x;
+  wire [15:0] w_max;
+  wire [15:0] w_min;
+  wire [31:0] w_mm_next;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_mm[i] = 0;
+    end
+  end
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+
+  assign w_first = (r_cnt == 0);
+  assign w_last = (r_cnt == r_ratio - 1'b1);
+
+  // Datapath, shared by both lanes
+  assign w_x = w_lane ? r_data[31:16] : r_data[15:0];
+  assign {w_max, w_min} = r_mm_q;
+  assign w_mm_next = w_first ? {w_x, w_x} :
+                     {(w_x > w_max) ? w_x : w_max, (w_x < w_min) ? w_x : w_min};
+
+  // Purpose: Running min and max, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if ((r_sm != IDLE) & r_run) begin
+      r_mm[{w_lane, r_ch}] <= w_mm_next;
+    end
+    r_mm_q <= r_mm[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair, send the preview with the last
+  // frame of the interval
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_run <= 1'b0;
+      r_ratio <= 1;
+      r_cnt <= 0;
+      o_prv_valid <= 1'b0;
+      o_prv_ch <= 0;
+      o_prv_data <= 0;
+      o_prv_sof <= 1'b0;
+      o_prv_eof <= 1'b0;
+    end else begin
+      o_prv_valid <= 1'b0;
+      o_prv_sof <= 1'b0;
+      o_prv_eof <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          r_sm <= LANE_A;
+
+          // Start and stop on frame boundaries only
+          if (i_smp_sof) begin
+            r_run <= i_ctrl;
+            if (i_ctrl & (~r_run | (r_cnt == 0))) begin
+              r_ratio <= (i_ratio == 0) ? 16'd1 : i_ratio;
+              r_cnt <= 0;
+            end
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+        if (r_run & w_last) begin
+          o_prv_valid <= 1'b1;
+          o_prv_ch <= {1'b0, r_ch};
+          o_prv_data <= w_mm_next;
+          o_prv_sof <= r_sof;
+        end
+      end
+      LANE_B:
+      begin
+        r_sm <= IDLE;
+        if (r_run & w_last) begin
+          o_prv_valid <= 1'b1;
+          o_prv_ch <= {1'b1, r_ch};
+          o_prv_data <= w_mm_next;
+          o_prv_eof <= r_eof;
+        end
+        if (r_run & r_eof) begin
+          r_cnt <= w_last ? 16'd0 : r_cnt + 1'b1;
+        end
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_preview
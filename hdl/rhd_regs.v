@@ -0,0 +1,679 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: AXI4-Lite register block
+//              Maps the control registers, status outputs and BRAM-like
+//              ports of rhd_wrapper.v into the address space of the PS, so
+//              that the block design only needs one AXI slave for them.
+//
+//              The 64 KB address space is split into 4 KB pages. Page 0
+//              holds the registers, one 16-word block per module, and the
+//              other pages are windows onto the read and write ports of the
+//              modules. Byte strobes are ignored, every write sets the whole
+//              register.
+//
+//              Register map (byte offsets in page 0, RO = read-only):
+//              0x000  SEQ_CTRL      [0] i_seq_en, [1] i_sync_slave
+//              0x004  FRAME_PERIOD  i_frame_period
+//              0x008  FRAME_CNT     RO, o_frame_cnt
+//              0x00C  OVERRUNS      RO, o_overruns
+//              0x010  FRAME_FLAGS   RO, o_frame_flags of the last frame
+//              0x018  EVENTS        pulse outputs latched until cleared by
+//                                   writing 1 to their bit:
+//                                   [0] o_feat_ready
+//                                   [1] o_stats_ready
+//                                   [2] o_spec_ready
+//                                   [3] o_scrub_alert
+//              0x01C  IRQ_EN        events that drive o_irq
+//              0x020  AUX_CMD       i_aux_cmd, one word per aux slot, slot
+//                                   n at 0x020 + 4n (N_AUX <= 8)
+//              0x040  CAP_CTRL      i_cap_ctrl
+//              0x044  CAP_POST      i_cap_post_frames
+//              0x048  CAP_THRESH    i_cap_threshold
+//              0x04C  CAP_STATUS    RO, o_cap_status
+//              0x060  AUX_RESULT    RO, last o_aux_data of each aux slot,
+//                                   slot n at 0x060 + 4n
+//              0x080  HPF_CTRL      i_hpf_ctrl
+//              0x084  HPF_COEF      i_hpf_coef
+//              0x0C0  NOTCH_CTRL    i_notch_ctrl
+//              0x100  DECIM_CTRL    i_decim_ctrl
+//              0x140  FEAT_CTRL     i_feat_ctrl
+//              0x144  FEAT_WIN      i_feat_win
+//              0x148  FEAT_HOP      i_feat_hop
+//              0x14C  FEAT_THRESH   i_feat_thresh
+//              0x180  DET_CTRL      i_det_ctrl
+//              0x184  DET_MASK_LO   i_det_mask[31:0]
+//              0x188  DET_MASK_HI   i_det_mask[63:32]
+//              0x18C  DET_ADAPT_K   i_det_adapt_k
+//              0x190  DET_TAU       i_det_tau
+//              0x194  DET_PULSE     i_det_pulse_len
+//              0x198  DET_EVT_COUNT RO, o_det_evt_count
+//              0x1C0  CAR_CTRL      i_car_ctrl
+//              0x1C4  CAR_MASK_LO   i_car_mask[31:0]
+//              0x1C8  CAR_MASK_HI   i_car_mask[63:32]
+//              0x1CC  CAR_MEAN      RO, o_car_mean
+//              0x200  SPATIAL_CTRL  i_spatial_ctrl
+//              0x240  CAL_CTRL      i_cal_ctrl
+//              0x280  STATS_CTRL    i_stats_ctrl
+//              0x284  STATS_INTERVAL i_stats_interval
+//              0x2C0  SPEC_CTRL     i_spec_ctrl
+//              0x2C4  SPEC_HOP      i_spec_hop
+//              0x2C8  SPEC_BANDS    i_spec_bands
+//              0x300  RICE_CTRL     i_rice_ctrl
+//              0x304  RICE_K        i_rice_k
+//              0x308  RICE_KEY      i_rice_key_period
+//              0x340  BLK_CTRL      i_blk_ctrl
+//              0x380  PRV_CTRL      i_prv_ctrl
+//              0x384  PRV_RATIO     i_prv_ratio
+//              0x3C0  PACK_CTRL     i_pack_ctrl
+//              0x3C4  PACK_MASK_LO  i_pack_mask[31:0]
+//              0x3C8  PACK_MASK_HI  i_pack_mask[63:32]
+//              0x440  ZC_CTRL       i_zc_ctrl
+//              0x444  ZC_CFG        i_zc_cfg
+//              0x448  ZC_PHASE_INC  i_zc_phase_inc
+//              0x44C  ZC_SETTLE     i_zc_settle
+//              0x450  ZC_FRAMES     i_zc_frames
+//              0x454  ZC_STATUS     RO, o_zc_status
+//              0x480  SCRUB_CTRL    i_scrub_ctrl
+//              0x484  SCRUB_PERIOD  i_scrub_period
+//              0x488  SCRUB_MASK    i_scrub_mask
+//              0x48C  SCRUB_STATUS  RO, o_scrub_status
+//              0x490  SCRUB_FLAGS   RO, o_scrub_flags
+//              0x4C0  SETTLE_CTRL   i_settle_ctrl
+//              0x4C4  SETTLE_MASK_LO i_settle_mask[31:0]
+//              0x4C8  SETTLE_MASK_HI i_settle_mask[63:32]
+//              0x4CC  SETTLE_MARGIN i_settle_margin
+//              0x4D0  SETTLE_HITS   i_settle_hits
+//              0x4D4  SETTLE_HOLD   i_settle_hold
+//              0x4D8  SETTLE_REG0   i_settle_reg0
+//              0x4DC  SETTLE_STATUS RO, o_settle_status
+//              0x500  PAT_CTRL      i_pat_ctrl
+//
+//              Unmapped registers read as 0.
+//
+//              Windows (byte offsets of the 4 KB pages):
+//              0x1000  snapshot bank, read (rhd_snapshot.v)
+//              0x2000  notch coefficients, write (rhd_notch.v)
+//              0x3000  feature frames, read (rhd_features.v)
+//              0x4000  detector thresholds, write (rhd_detect.v)
+//              0x5000  detector event ring, read (rhd_detect.v)
+//              0x6000  calibration coefficients, write (rhd_cal.v)
+//              0x7000  channel statistics, read (rhd_stats.v)
+//              0x8000  spectral features, read (rhd_spectrum.v)
+//              0x9000  impedance results, read (rhd_zcheck.v)
+//              0xA000  scrubbing shadow table, write (rhd_scrub.v)
+//              0xC000  spatial filter weights, write (rhd_spatial.v), the
+//                      4096 words of the matrix take the last 4 pages
+//
+//              Windows are read and written with one access per word, the
+//              read ports taking one clock cycle of latency like a BRAM.
+//              Bursts from the PS are split into single accesses by the AXI
+//              interconnect.
+//
+// Parameters:  N_AUX          - number of aux slots of the sequencer, <= 8
+//              NOTCH_SECTIONS - number of notch sections, as in rhd_wrapper.v
+//              DETECT_EVT_BITS - log2 of the size of the detector event
+//                                ring, as in rhd_wrapper.v, <= 10
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_regs #(
+  parameter N_AUX = 3,
+  parameter NOTCH_SECTIONS = 2,
+  parameter DETECT_EVT_BITS = 10
+) (
+  // Control/Data Signals,
+  (* X_INTERFACE_INFO = "xilinx.com:signal:reset:1.0 i_rst RST" *)
+  (* X_INTERFACE_PARAMETER = "POLARITY ACTIVE_LOW" *)
+  input i_rst,     // FPGA Reset
+  (* X_INTERFACE_INFO = "xilinx.com:signal:clock:1.0 i_clk CLK" *)
+  (* X_INTERFACE_PARAMETER = "ASSOCIATED_BUSIF S_AXI, ASSOCIATED_RESET i_rst" *)
+  input i_clk,     // FPGA Clock
+
+  // AXI4-Lite slave
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI AWADDR" *)
+  (* X_INTERFACE_PARAMETER = "PROTOCOL AXI4LITE, DATA_WIDTH 32, ADDR_WIDTH 16" *)
+  input      [15:0] i_axi_awaddr,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI AWVALID" *)
+  input             i_axi_awvalid,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI AWREADY" *)
+  output reg        o_axi_awready,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI WDATA" *)
+  input      [31:0] i_axi_wdata,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI WSTRB" *)
+  input      [3:0]  i_axi_wstrb,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI WVALID" *)
+  input             i_axi_wvalid,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI WREADY" *)
+  output reg        o_axi_wready,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI BRESP" *)
+  output     [1:0]  o_axi_bresp,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI BVALID" *)
+  output reg        o_axi_bvalid,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI BREADY" *)
+  input             i_axi_bready,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI ARADDR" *)
+  input      [15:0] i_axi_araddr,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI ARVALID" *)
+  input             i_axi_arvalid,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI ARREADY" *)
+  output reg        o_axi_arready,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI RDATA" *)
+  output reg [31:0] o_axi_rdata,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI RRESP" *)
+  output     [1:0]  o_axi_rresp,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI RVALID" *)
+  output reg        o_axi_rvalid,
+  (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 S_AXI RREADY" *)
+  input             i_axi_rready,
+
+  // Interrupt, high while an enabled event is pending
+  output            o_irq,
+
+  // Sequencer
+  output reg                 o_seq_en,
+  output reg                 o_sync_slave,
+  output reg [31:0]          o_frame_period,
+  output reg [N_AUX*16-1:0]  o_aux_cmd,
+  input      [31:0]          i_frame_cnt,
+  input      [15:0]          i_overruns,
+  input      [15:0]          i_frame_flags,
+  input                      i_aux_valid,
+  input      [3:0]           i_aux_slot,
+  input      [15:0]          i_aux_data,
+
+  // Capture buffer
+  output reg [3:0]  o_cap_ctrl,
+  output reg [15:0] o_cap_post_frames,
+  output reg [15:0] o_cap_threshold,
+  input      [31:0] i_cap_status,
+
+  // Snapshot bank
+  output            o_snap_rd_en,
+  output     [6:0]  o_snap_rd_addr,
+  input      [31:0] i_snap_rd_data,
+
+  // High-pass filter
+  output reg [1:0]  o_hpf_ctrl,
+  output reg [15:0] o_hpf_coef,
+
+  // Notch filter bank
+  output reg [NOTCH_SECTIONS:0] o_notch_ctrl,
+  output            o_notch_coef_wr,
+  output     [4:0]  o_notch_coef_addr,
+  output     [15:0] o_notch_coef_data,
+
+  // Decimator
+  output reg [2:0]  o_decim_ctrl,
+
+  // Feature engine
+  output reg        o_feat_ctrl,
+  output reg [3:0]  o_feat_win,
+  output reg [15:0] o_feat_hop,
+  output reg [15:0] o_feat_thresh,
+  input             i_feat_ready,
+  output            o_feat_rd_en,
+  output     [8:0]  o_feat_rd_addr,
+  input      [31:0] i_feat_rd_data,
+
+  // Threshold detector
+  output reg [1:0]  o_det_ctrl,
+  output reg [63:0] o_det_mask,
+  output reg [7:0]  o_det_adapt_k,
+  output reg [3:0]  o_det_tau,
+  output reg [15:0] o_det_pulse_len,
+  input      [31:0] i_det_evt_count,
+  output            o_det_thr_wr,
+  output     [5:0]  o_det_thr_addr,
+  output     [15:0] o_det_thr_data,
+  output     [DETECT_EVT_BITS-1:0] o_det_evt_addr,
+  input      [31:0] i_det_evt_data,
+
+  // Common-average reference
+  output reg        o_car_ctrl,
+  output reg [63:0] o_car_mask,
+  input      [15:0] i_car_mean,
+
+  // Spatial filter
+  output reg [1:0]  o_spatial_ctrl,
+  output            o_spatial_coef_wr,
+  output     [11:0] o_spatial_coef_addr,
+  output     [15:0] o_spatial_coef_data,
+
+  // Calibration
+  output reg [1:0]  o_cal_ctrl,
+  output            o_cal_coef_wr,
+  output     [6:0]  o_cal_coef_addr,
+  output     [15:0] o_cal_coef_data,
+
+  // Channel statistics
+  output reg        o_stats_ctrl,
+  output reg [15:0] o_stats_interval,
+  input             i_stats_ready,
+  output            o_stats_rd_en,
+  output     [9:0]  o_stats_rd_addr,
+  input      [31:0] i_stats_rd_data,
+
+  // Spectral features
+  output reg        o_spec_ctrl,
+  output reg [15:0] o_spec_hop,
+  output reg [31:0] o_spec_bands,
+  input             i_spec_ready,
+  output            o_spec_rd_en,
+  output     [9:0]  o_spec_rd_addr,
+  input      [31:0] i_spec_rd_data,
+
+  // Rice encoder
+  output reg        o_rice_ctrl,
+  output reg [3:0]  o_rice_k,
+  output reg [15:0] o_rice_key_period,
+
+  // Transpose buffer
+  output reg        o_blk_ctrl,
+
+  // Preview stream
+  output reg        o_prv_ctrl,
+  output reg [15:0] o_prv_ratio,
+
+  // Dense packing
+  output reg [2:0]  o_pack_ctrl,
+  output reg [63:0] o_pack_mask,
+
+  // Impedance measurement
+  output reg        o_zc_ctrl,
+  output reg [7:0]  o_zc_cfg,
+  output reg [15:0] o_zc_phase_inc,
+  output reg [15:0] o_zc_settle,
+  output reg [15:0] o_zc_frames,
+  input      [31:0] i_zc_status,
+  output            o_zc_rd_en,
+  output     [7:0]  o_zc_rd_addr,
+  input      [31:0] i_zc_rd_data,
+
+  // Register scrubbing
+  output reg [1:0]  o_scrub_ctrl,
+  output reg [15:0] o_scrub_period,
+  output reg [26:0] o_scrub_mask,
+  input      [31:0] i_scrub_status,
+  input      [26:0] i_scrub_flags,
+  input             i_scrub_alert,
+  output            o_scrub_wr,
+  output     [4:0]  o_scrub_addr,
+  output     [7:0]  o_scrub_data,
+
+  // Automatic fast settle
+  output reg        o_settle_ctrl,
+  output reg [63:0] o_settle_mask,
+  output reg [15:0] o_settle_margin,
+  output reg [7:0]  o_settle_hits,
+  output reg [15:0] o_settle_hold,
+  output reg [7:0]  o_settle_reg0,
+  input      [31:0] i_settle_status,
+
+  // Loopback patterns
+  output reg [2:0]  o_pat_ctrl
+);
+
+  reg        r_wr;      // Write strobe, on the handshake cycle
+  reg [15:0] r_waddr;
+  reg [31:0] r_wdata;
+  reg        r_rd;      // Read strobe, on the handshake cycle
+  reg        r_rd_wait; // Read data of the windows available
+  reg [15:0] r_raddr;
+
+  reg [N_AUX*16-1:0] r_aux_res; // Last result of each aux slot
+  reg [7:0]  r_events;
+  reg [7:0]  r_irq_en;
+  wire [7:0] w_events;
+
+  reg [31:0] r_reg_rdata;
+  reg [31:0] r_rdata;
+  wire w_reg_wr;
+
+  integer i;
+
+  assign o_axi_bresp = 2'b00;
+  assign o_axi_rresp = 2'b00;
+
+  // Purpose: AXI4-Lite handshakes, one transaction of each kind at a time
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      o_axi_awready <= 1'b0;
+      o_axi_wready <= 1'b0;
+      o_axi_bvalid <= 1'b0;
+      o_axi_arready <= 1'b0;
+      o_axi_rvalid <= 1'b0;
+      o_axi_rdata <= 0;
+      r_wr <= 1'b0;
+      r_waddr <= 0;
+      r_wdata <= 0;
+      r_rd <= 1'b0;
+      r_rd_wait <= 1'b0;
+      r_raddr <= 0;
+    end else begin
+      // Write address and data are taken together
+      o_axi_awready <= 1'b0;
+      o_axi_wready <= 1'b0;
+      r_wr <= 1'b0;
+      if (i_axi_awvalid & i_axi_wvalid & ~o_axi_awready & ~o_axi_bvalid) begin
+        o_axi_awready <= 1'b1;
+        o_axi_wready <= 1'b1;
+        r_wr <= 1'b1;
+        r_waddr <= i_axi_awaddr;
+        r_wdata <= i_axi_wdata;
+      end
+
+      if (r_wr) begin
+        o_axi_bvalid <= 1'b1;
+      end else if (i_axi_bready) begin
+        o_axi_bvalid <= 1'b0;
+      end
+
+      // The windows answer one cycle after r_rd
+      o_axi_arready <= 1'b0;
+      r_rd <= 1'b0;
+      r_rd_wait <= r_rd;
+      if (i_axi_arvalid & ~o_axi_arready & ~r_rd_wait & ~o_axi_rvalid) begin
+        o_axi_arready <= 1'b1;
+        r_rd <= 1'b1;
+        r_raddr <= i_axi_araddr;
+      end
+
+      if (r_rd_wait) begin
+        o_axi_rvalid <= 1'b1;
+        o_axi_rdata <= r_rdata;
+      end else if (i_axi_rready) begin
+        o_axi_rvalid <= 1'b0;
+      end
+    end
+  end
+
+  assign w_reg_wr = r_wr & (r_waddr[15:12] == 4'h0);
+
+  // Purpose: Write the registers of page 0
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      o_seq_en <= 1'b0;
+      o_sync_slave <= 1'b0;
+      r_irq_en <= 0;
+      o_frame_period <= 0;
+      o_aux_cmd <= 0;
+      o_cap_ctrl <= 0;
+      o_cap_post_frames <= 0;
+      o_cap_threshold <= 0;
+      o_hpf_ctrl <= 0;
+      o_hpf_coef <= 0;
+      o_notch_ctrl <= 0;
+      o_decim_ctrl <= 0;
+      o_feat_ctrl <= 1'b0;
+      o_feat_win <= 0;
+      o_feat_hop <= 0;
+      o_feat_thresh <= 0;
+      o_det_ctrl <= 0;
+      o_det_mask <= 0;
+      o_det_adapt_k <= 0;
+      o_det_tau <= 0;
+      o_det_pulse_len <= 0;
+      o_car_ctrl <= 1'b0;
+      o_car_mask <= 0;
+      o_spatial_ctrl <= 0;
+      o_cal_ctrl <= 0;
+      o_stats_ctrl <= 1'b0;
+      o_stats_interval <= 0;
+      o_spec_ctrl <= 1'b0;
+      o_spec_hop <= 0;
+      o_spec_bands <= 0;
+      o_rice_ctrl <= 1'b0;
+      o_rice_k <= 0;
+      o_rice_key_period <= 0;
+      o_blk_ctrl <= 1'b0;
+      o_prv_ctrl <= 1'b0;
+      o_prv_ratio <= 0;
+      o_pack_ctrl <= 0;
+      o_pack_mask <= 0;
+      o_zc_ctrl <= 1'b0;
+      o_zc_cfg <= 0;
+      o_zc_phase_inc <= 0;
+      o_zc_settle <= 0;
+      o_zc_frames <= 0;
+      o_scrub_ctrl <= 0;
+      o_scrub_period <= 0;
+      o_scrub_mask <= 0;
+      o_settle_ctrl <= 1'b0;
+      o_settle_mask <= 0;
+      o_settle_margin <= 0;
+      o_settle_hits <= 0;
+      o_settle_hold <= 0;
+      o_settle_reg0 <= 0;
+      o_pat_ctrl <= 0;
+    end else if (w_reg_wr) begin
+      case (r_waddr[11:0])
+      12'h000:
+      begin
+        o_seq_en <= r_wdata[0];
+        o_sync_slave <= r_wdata[1];
+      end
+      12'h004: o_frame_period <= r_wdata;
+      12'h01C: r_irq_en <= r_wdata[7:0];
+      12'h040: o_cap_ctrl <= r_wdata[3:0];
+      12'h044: o_cap_post_frames <= r_wdata[15:0];
+      12'h048: o_cap_threshold <= r_wdata[15:0];
+      12'h080: o_hpf_ctrl <= r_wdata[1:0];
+      12'h084: o_hpf_coef <= r_wdata[15:0];
+      12'h0C0: o_notch_ctrl <= r_wdata[NOTCH_SECTIONS:0];
+      12'h100: o_decim_ctrl <= r_wdata[2:0];
+      12'h140: o_feat_ctrl <= r_wdata[0];
+      12'h144: o_feat_win <= r_wdata[3:0];
+      12'h148: o_feat_hop <= r_wdata[15:0];
+      12'h14C: o_feat_thresh <= r_wdata[15:0];
+      12'h180: o_det_ctrl <= r_wdata[1:0];
+      12'h184: o_det_mask[31:0] <= r_wdata;
+      12'h188: o_det_mask[63:32] <= r_wdata;
+      12'h18C: o_det_adapt_k <= r_wdata[7:0];
+      12'h190: o_det_tau <= r_wdata[3:0];
+      12'h194: o_det_pulse_len <= r_wdata[15:0];
+      12'h1C0: o_car_ctrl <= r_wdata[0];
+      12'h1C4: o_car_mask[31:0] <= r_wdata;
+      12'h1C8: o_car_mask[63:32] <= r_wdata;
+      12'h200: o_spatial_ctrl <= r_wdata[1:0];
+      12'h240: o_cal_ctrl <= r_wdata[1:0];
+      12'h280: o_stats_ctrl <= r_wdata[0];
+      12'h284: o_stats_interval <= r_wdata[15:0];
+      12'h2C0: o_spec_ctrl <= r_wdata[0];
+      12'h2C4: o_spec_hop <= r_wdata[15:0];
+      12'h2C8: o_spec_bands <= r_wdata;
+      12'h300: o_rice_ctrl <= r_wdata[0];
+      12'h304: o_rice_k <= r_wdata[3:0];
+      12'h308: o_rice_key_period <= r_wdata[15:0];
+      12'h340: o_blk_ctrl <= r_wdata[0];
+      12'h380: o_prv_ctrl <= r_wdata[0];
+      12'h384: o_prv_ratio <= r_wdata[15:0];
+      12'h3C0: o_pack_ctrl <= r_wdata[2:0];
+      12'h3C4: o_pack_mask[31:0] <= r_wdata;
+      12'h3C8: o_pack_mask[63:32] <= r_wdata;
+      12'h440: o_zc_ctrl <= r_wdata[0];
+      12'h444: o_zc_cfg <= r_wdata[7:0];
+      12'h448: o_zc_phase_inc <= r_wdata[15:0];
+      12'h44C: o_zc_settle <= r_wdata[15:0];
+      12'h450: o_zc_frames <= r_wdata[15:0];
+      12'h480: o_scrub_ctrl <= r_wdata[1:0];
+      12'h484: o_scrub_period <= r_wdata[15:0];
+      12'h488: o_scrub_mask <= r_wdata[26:0];
+      12'h4C0: o_settle_ctrl <= r_wdata[0];
+      12'h4C4: o_settle_mask[31:0] <= r_wdata;
+      12'h4C8: o_settle_mask[63:32] <= r_wdata;
+      12'h4CC: o_settle_margin <= r_wdata[15:0];
+      12'h4D0: o_settle_hits <= r_wdata[7:0];
+      12'h4D4: o_settle_hold <= r_wdata[15:0];
+      12'h4D8: o_settle_reg0 <= r_wdata[7:0];
+      12'h500: o_pat_ctrl <= r_wdata[2:0];
+      endcase
+
+      for (i = 0; i < N_AUX; i = i + 1) begin
+        if (r_waddr[11:0] == 12'h020 + 4 * i) begin
+          o_aux_cmd[i*16 +: 16] <= r_wdata[15:0];
+        end
+      end
+    end
+  end
+
+  // Purpose: Read the registers of page 0
+  always @(*) begin // Combinational
+    case (r_raddr[11:0])
+    12'h000: r_reg_rdata = {30'b0, o_sync_slave, o_seq_en};
+    12'h004: r_reg_rdata = o_frame_period;
+    12'h008: r_reg_rdata = i_frame_cnt;
+    12'h00C: r_reg_rdata = {16'b0, i_overruns};
+    12'h010: r_reg_rdata = {16'b0, i_frame_flags};
+    12'h018: r_reg_rdata = {24'b0, r_events};
+    12'h01C: r_reg_rdata = {24'b0, r_irq_en};
+    12'h040: r_reg_rdata = {28'b0, o_cap_ctrl};
+    12'h044: r_reg_rdata = {16'b0, o_cap_post_frames};
+    12'h048: r_reg_rdata = {16'b0, o_cap_threshold};
+    12'h04C: r_reg_rdata = i_cap_status;
+    12'h080: r_reg_rdata = {30'b0, o_hpf_ctrl};
+    12'h084: r_reg_rdata = {16'b0, o_hpf_coef};
+    12'h0C0: r_reg_rdata = o_notch_ctrl;
+    12'h100: r_reg_rdata = {29'b0, o_decim_ctrl};
+    12'h140: r_reg_rdata = {31'b0, o_feat_ctrl};
+    12'h144: r_reg_rdata = {28'b0, o_feat_win};
+    12'h148: r_reg_rdata = {16'b0, o_feat_hop};
+    12'h14C: r_reg_rdata = {16'b0, o_feat_thresh};
+    12'h180: r_reg_rdata = {30'b0, o_det_ctrl};
+    12'h184: r_reg_rdata = o_det_mask[31:0];
+    12'h188: r_reg_rdata = o_det_mask[63:32];
+    12'h18C: r_reg_rdata = {24'b0, o_det_adapt_k};
+    12'h190: r_reg_rdata = {28'b0, o_det_tau};
+    12'h194: r_reg_rdata = {16'b0, o_det_pulse_len};
+    12'h198: r_reg_rdata = i_det_evt_count;
+    12'h1C0: r_reg_rdata = {31'b0, o_car_ctrl};
+    12'h1C4: r_reg_rdata = o_car_mask[31:0];
+    12'h1C8: r_reg_rdata = o_car_mask[63:32];
+    12'h1CC: r_reg_rdata = {16'b0, i_car_mean};
+    12'h200: r_reg_rdata = {30'b0, o_spatial_ctrl};
+    12'h240: r_reg_rdata = {30'b0, o_cal_ctrl};
+    12'h280: r_reg_rdata = {31'b0, o_stats_ctrl};
+    12'h284: r_reg_rdata = {16'b0, o_stats_interval};
+    12'h2C0: r_reg_rdata = {31'b0, o_spec_ctrl};
+    12'h2C4: r_reg_rdata = {16'b0, o_spec_hop};
+    12'h2C8: r_reg_rdata = o_spec_bands;
+    12'h300: r_reg_rdata = {31'b0, o_rice_ctrl};
+    12'h304: r_reg_rdata = {28'b0, o_rice_k};
+    12'h308: r_reg_rdata = {16'b0, o_rice_key_period};
+    12'h340: r_reg_rdata = {31'b0, o_blk_ctrl};
+    12'h380: r_reg_rdata = {31'b0, o_prv_ctrl};
+    12'h384: r_reg_rdata = {16'b0, o_prv_ratio};
+    12'h3C0: r_reg_rdata = {29'b0, o_pack_ctrl};
+    12'h3C4: r_reg_rdata = o_pack_mask[31:0];
+    12'h3C8: r_reg_rdata = o_pack_mask[63:32];
+    12'h440: r_reg_rdata = {31'b0, o_zc_ctrl};
+    12'h444: r_reg_rdata = {24'b0, o_zc_cfg};
+    12'h448: r_reg_rdata = {16'b0, o_zc_phase_inc};
+    12'h44C: r_reg_rdata = {16'b0, o_zc_settle};
+    12'h450: r_reg_rdata = {16'b0, o_zc_frames};
+    12'h454: r_reg_rdata = i_zc_status;
+    12'h480: r_reg_rdata = {30'b0, o_scrub_ctrl};
+    12'h484: r_reg_rdata = {16'b0, o_scrub_period};
+    12'h488: r_reg_rdata = {5'b0, o_scrub_mask};
+    12'h48C: r_reg_rdata = i_scrub_status;
+    12'h490: r_reg_rdata = {5'b0, i_scrub_flags};
+    12'h4C0: r_reg_rdata = {31'b0, o_settle_ctrl};
+    12'h4C4: r_reg_rdata = o_settle_mask[31:0];
+    12'h4C8: r_reg_rdata = o_settle_mask[63:32];
+    12'h4CC: r_reg_rdata = {16'b0, o_settle_margin};
+    12'h4D0: r_reg_rdata = {24'b0, o_settle_hits};
+    12'h4D4: r_reg_rdata = {16'b0, o_settle_hold};
+    12'h4D8: r_reg_rdata = {24'b0, o_settle_reg0};
+    12'h4DC: r_reg_rdata = i_settle_status;
+    12'h500: r_reg_rdata = {29'b0, o_pat_ctrl};
+    default: r_reg_rdata = 0;
+    endcase
+
+    for (i = 0; i < N_AUX; i = i + 1) begin
+      if (r_raddr[11:0] == 12'h020 + 4 * i) begin
+        r_reg_rdata = {16'b0, o_aux_cmd[i*16 +: 16]};
+      end
+      if (r_raddr[11:0] == 12'h060 + 4 * i) begin
+        r_reg_rdata = {16'b0, r_aux_res[i*16 +: 16]};
+      end
+    end
+  end
+
+  assign w_events = {4'b0, i_scrub_alert, i_spec_ready, i_stats_ready, i_feat_ready};
+  assign o_irq = |(r_events & r_irq_en);
+
+  // Purpose: Latch the event pulses until the PS clears them
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_events <= 0;
+    end else if (w_reg_wr & (r_waddr[11:0] == 12'h018)) begin
+      r_events <= (r_events & ~r_wdata[7:0]) | w_events;
+    end else begin
+      r_events <= r_events | w_events;
+    end
+  end
+
+  // Purpose: Keep the last result of each aux slot
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_aux_res <= 0;
+    end else if (i_aux_valid) begin
+      for (i = 0; i < N_AUX; i = i + 1) begin
+        if (i_aux_slot == i) begin
+          r_aux_res[i*16 +: 16] <= i_aux_data;
+        end
+      end
+    end
+  end
+
+  // Window pages
+  assign o_snap_rd_en = r_rd & (r_raddr[15:12] == 4'h1);
+  assign o_snap_rd_addr = r_raddr[8:2];
+
+  assign o_notch_coef_wr = r_wr & (r_waddr[15:12] == 4'h2);
+  assign o_notch_coef_addr = r_waddr[6:2];
+  assign o_notch_coef_data = r_wdata[15:0];
+
+  assign o_feat_rd_en = r_rd & (r_raddr[15:12] == 4'h3);
+  assign o_feat_rd_addr = r_raddr[10:2];
+
+  assign o_det_thr_wr = r_wr & (r_waddr[15:12] == 4'h4);
+  assign o_det_thr_addr = r_waddr[7:2];
+  assign o_det_thr_data = r_wdata[15:0];
+
+  // The event ring has no read enable, it follows the read address
+  assign o_det_evt_addr = r_raddr[DETECT_EVT_BITS+1:2];
+
+  assign o_cal_coef_wr = r_wr & (r_waddr[15:12] == 4'h6);
+  assign o_cal_coef_addr = r_waddr[8:2];
+  assign o_cal_coef_data = r_wdata[15:0];
+
+  assign o_stats_rd_en = r_rd & (r_raddr[15:12] == 4'h7);
+  assign o_stats_rd_addr = r_raddr[11:2];
+
+  assign o_spec_rd_en = r_rd & (r_raddr[15:12] == 4'h8);
+  assign o_spec_rd_addr = r_raddr[11:2];
+
+  assign o_zc_rd_en = r_rd & (r_raddr[15:12] == 4'h9);
+  assign o_zc_rd_addr = r_raddr[9:2];
+
+  assign o_scrub_wr = r_wr & (r_waddr[15:12] == 4'hA);
+  assign o_scrub_addr = r_waddr[6:2];
+  assign o_scrub_data = r_wdata[7:0];
+
+  assign o_spatial_coef_wr = r_wr & (r_waddr[15:14] == 2'b11);
+  assign o_spatial_coef_addr = r_waddr[13:2];
+  assign o_spatial_coef_data = r_wdata[15:0];
+
+  // Purpose: Select the page of the read data
+  always @(*) begin // Combinational
+    case (r_raddr[15:12])
+    4'h0: r_rdata = r_reg_rdata;
+    4'h1: r_rdata = i_snap_rd_data;
+    4'h3: r_rdata = i_feat_rd_data;
+    4'h5: r_rdata = i_det_evt_data;
+    4'h7: r_rdata = i_stats_rd_data;
+    4'h8: r_rdata = i_spec_rd_data;
+    4'h9: r_rdata = i_zc_rd_data;
+    default: r_rdata = 0;
+    endcase
+  end
+
+endmodule // rhd_regs
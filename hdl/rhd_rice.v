@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Lossless delta/Rice encoder
+//              Compresses the sample stream into a stream of 32-bit words.
+//              Each channel is coded as the difference with its previous
+//              sample, which for EMG mostly fits in 8 to 10 bits, with a Rice
+//              code of parameter k = i_k:
+//                u = zigzag(d) = 2d for d >= 0, -2d-1 otherwise
+//                q = u >> k ones, a zero, then the k low bits of u
+//              When q >= 16, the code is 16 ones followed by u on 16 bits
+//              instead, so that no code is longer than 32 bits.
+//
+//              Every frame starts on a word boundary with a header and ends
+//              on the word flagged by o_cmp_last, padded with zeros:
+//                header  {8'hA5, 3'b0, k[3:0], key, frame[15:0]}
+//                flags   16 bits, the frame flags (see rhd_sequencer.v)
+//              followed by the codes of the channels in stream order (0, 32,
+//              1, 33, ...), bits being sent MSB first. Key frames hold the
+//              raw 16-bit samples instead of codes, so decoding can start at
+//              any of them. One frame out of i_key_period is a key frame, the
+//              first one after enabling always is. With i_key_period = 1,
+//              every frame is a reset point.
+//
+//              A single datapath is time-multiplexed over both lanes of every
+//              pair, which takes 3 clock cycles, plus one for the flags at
+//              the start of the frame and one at the end of it, with the
+//              previous samples kept in BRAM.
+//
+//              i_k and i_key_period are latched at the start of each frame.
+//              vitis/rhd_rice.c holds the matching decoder.
+//
+//              Control bits (i_ctrl): [0] enable, applied at the start of a
+//              frame
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_rice (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [3:0]  i_k,
+  input [15:0] i_key_period, // Frames between key frames, 0 = first only
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Compressed stream
+  output reg        o_cmp_valid,
+  output reg [31:0] o_cmp_data,
+  output reg        o_cmp_last
+);
+
+  localparam IDLE   = 3'b000;
+  localparam LANE_A = 3'b001;
+  localparam LANE_B = 3'b010;
+  localparam FLUSH  = 3'b011;
+  localparam FLAGS  = 3'b100;
+
+  reg [15:0] r_prev [0:63];
+  reg [15:0] r_prev_q;
+
+  reg [2:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_eof;
+  reg [15:0] r_flags;
+
+  reg r_run;
+  reg [3:0] r_k;
+  reg r_key;
+  reg [15:0] r_frame;
+  reg [15:0] r_key_cnt;
+
+  // Bit packer, MSB first, holds 1 to 32 bits between codes
+  reg [63:0] r_buf;
+  reg [6:0] r_nbits;
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire w_sof;
+
+  wire [15:0] w_x;
+  wire [15:0] w_d;
+  wire [15:0] w_u;
+  wire [15:0] w_q;
+  wire w_esc;
+
+  reg r_push;         // Combinational
+  reg [31:0] r_code;  // Combinational, right aligned
+  reg [5:0] r_len;    // Combinational, 0 = 32 bits
+
+  wire [6:0] w_len;
+  wire [6:0] w_total;
+  wire [63:0] w_buf_next;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_prev[i] = 0;
+    end
+  end
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} :
+                     (r_sm == FLAGS) ? {1'b0, r_ch} : {1'b1, r_ch};
+
+  // A frame is encoded when enabled at its start
+  assign w_sof = i_smp_valid & i_smp_sof & (r_sm == IDLE) & i_ctrl;
+
+  // Rice code of the lane being processed
+  assign w_x = w_lane ? r_data[31:16] : r_data[15:0];
+  assign w_d = w_x - r_prev_q;
+  assign w_u = {w_d[14:0], 1'b0} ^ {16{w_d[15]}};
+  assign w_q = w_u >> r_k;
+  assign w_esc = (w_q >= 16);
+
+  always @(*) begin // Combinational
+    r_push = 1'b0;
+    r_code = 32'b0;
+    r_len = 6'd0;
+    if (w_sof) begin
+      r_push = 1'b1;
+      r_code = {8'hA5, 3'b0, i_k, (r_key_cnt == 0), r_frame};
+      r_len = 6'd0;
+    end else if (r_sm == FLAGS) begin
+      r_push = 1'b1;
+      r_code = {16'b0, r_flags};
+      r_len = 6'd16;
+    end else if (r_run & ((r_sm == LANE_A) | (r_sm == LANE_B))) begin
+      r_push = 1'b1;
+      if (r_key) begin
+        r_code = {16'b0, w_x};
+        r_len = 6'd16;
+      end else if (w_esc) begin
+        r_code = {16'hFFFF, w_u};
+        r_len = 6'd0;
+      end else begin
+        r_code = ((((32'd1 << w_q) - 1'b1) << (r_k + 1)) | (w_u & ((16'd1 << r_k) - 1'b1)));
+        r_len = w_q + r_k + 1'b1;
+      end
+    end
+  end
+
+  assign w_len = (r_len == 0) ? 7'd32 : {1'b0, r_len};
+  assign w_total = r_nbits + w_len;
+  assign w_buf_next = r_buf | ({32'b0, r_code} << (7'd64 - w_total));
+
+  // Purpose: Previous sample of each channel, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (r_run & ((r_sm == LANE_A) | (r_sm == LANE_B))) begin
+      r_prev[{w_lane, r_ch}] <= w_x;
+    end
+    r_prev_q <= r_prev[w_rd_addr];
+  end
+
+  // Purpose: Code both lanes of a pair and pack the codes into words
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_run <= 1'b0;
+      r_k <= 0;
+      r_key <= 1'b0;
+      r_frame <= 0;
+      r_key_cnt <= 0;
+      r_buf <= 0;
+      r_nbits <= 0;
+      o_cmp_valid <= 1'b0;
+      o_cmp_data <= 0;
+      o_cmp_last <= 1'b0;
+    end else begin
+      o_cmp_valid <= 1'b0;
+      o_cmp_last <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_eof <= i_smp_eof;
+          r_sm <= LANE_A;
+
+          // Start and stop on frame boundaries only
+          if (i_smp_sof) begin
+            r_run <= i_ctrl;
+            if (i_ctrl) begin
+              r_flags <= i_smp_flags;
+              r_sm <= FLAGS;
+              r_k <= i_k;
+              r_key <= (r_key_cnt == 0);
+              r_key_cnt <= ((r_key_cnt == i_key_period - 1'b1) | (i_key_period == 1)) ? 16'd0 :
+                           (i_key_period == 0) ? 16'd1 : r_key_cnt + 1'b1;
+              r_frame <= r_frame + 1'b1;
+            end else begin
+              r_key_cnt <= 0;
+              r_frame <= 0;
+            end
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        r_sm <= (r_eof & r_run) ? FLUSH : IDLE;
+      end
+      FLUSH:
+      begin
+        r_sm <= IDLE;
+      end
+      FLAGS:
+      begin
+        r_sm <= LANE_A;
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+
+      // Words are sent as soon as they hold more than 32 bits, the last
+      // one of the frame being flushed
+      if (r_sm == FLUSH) begin
+        o_cmp_valid <= 1'b1;
+        o_cmp_data <= r_buf[63:32];
+        o_cmp_last <= 1'b1;
+        r_buf <= 0;
+        r_nbits <= 0;
+      end else if (r_push) begin
+        if (w_total > 32) begin
+          o_cmp_valid <= 1'b1;
+          o_cmp_data <= w_buf_next[63:32];
+          r_buf <= w_buf_next << 32;
+          r_nbits <= w_total - 7'd32;
+        end else begin
+          r_buf <= w_buf_next;
+          r_nbits <= w_total;
+        end
+      end
+    end
+  end
+
+endmodule // rhd_rice
@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Register scrubbing
+//              Reads back the configuration and ROM registers of the RHD2164
+//              in the background, one READ every i_period + 1 frames through
+//              aux slot SLOT of the acquisition sequencer, and compares them
+//              to a shadow table written by the PS. A headstage that browned
+//              out or was reset by a cable fault shows up as mismatches
+//              without stopping the acquisition.
+//
+//              Shadow table entries (i_shadow_addr):
+//              0-17    registers 0 to 17
+//              18-22   registers 40 to 44 ("INTAN", preloaded)
+//              23-26   registers 60 to 63 (63 preloaded with 4, RHD2164)
+//              Only the entries of i_mask are checked, so that registers that
+//              other aux commands write (e.g. rhd_zcheck.v) can be left out.
+//
+//              The result of a READ comes out during the next frame, tagged
+//              with its slot. A result that differs from the shadow entry, or
+//              with a non-zero upper byte, is a mismatch: it is counted, sets
+//              the entry in o_flags and pulses o_alert, which can be used as
+//              an interrupt.
+//
+//              The slot can be taken by another module for a whole frame
+//              (rhd_zcheck.v when SLOT is 0 or 1), in which case i_aux_grant
+//              goes low after the frame start. The READ of that frame is then
+//              dropped, its result is not checked, and the same entry is read
+//              again at the next frame.
+//
+//              Status (o_status):
+//              [31]     a mismatch was found since the last clear
+//              [30:16]  mismatches
+//              [15:0]   passes over the whole table
+//
+//              Control bits (i_ctrl):
+//              [0] enable
+//              [1] clear the status and o_flags, rising edge
+//
+// Parameters:  SLOT - Aux slot used for the READs
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_scrub #(
+  parameter SLOT = 2
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input  [1:0]      i_ctrl,
+  input  [15:0]     i_period,  // Frames between READs, 0 = every frame
+  input  [26:0]     i_mask,    // Entries to check
+  input             i_shadow_wr,
+  input  [4:0]      i_shadow_addr,
+  input  [7:0]      i_shadow_data,
+  output [31:0]     o_status,
+  output reg [26:0] o_flags,   // Entries found mismatching
+  output reg        o_alert,
+
+  // Sequencer
+  input             i_frame_start,
+  input             i_aux_grant, // Aux slot SLOT is not taken by another module
+  output reg        o_aux_en,    // Replace aux slot SLOT
+  output reg [15:0] o_aux_cmd,
+
+  // Aux results
+  input             i_aux_valid,
+  input [3:0]       i_aux_slot,
+  input [15:0]      i_aux_data
+);
+
+  localparam N_ENTRIES = 27;
+
+  reg [7:0] r_shadow [0:31];
+
+  reg r_ctrl_1;
+  reg [4:0] r_idx;     // Next entry to read
+  reg [15:0] r_cnt;    // Frames before the next READ
+  reg r_q0;            // READ issued this frame, slot still granted
+  reg [4:0] r_q0_idx;
+  reg r_q1;            // READ issued last frame, result expected
+  reg [4:0] r_q1_idx;
+  reg r_bad;
+  reg [14:0] r_mismatches;
+  reg [15:0] r_passes;
+
+  wire [5:0] w_reg;
+  wire w_check;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 32; i = i + 1) begin
+      r_shadow[i] = 0;
+    end
+    r_shadow[18] = "I";
+    r_shadow[19] = "N";
+    r_shadow[20] = "T";
+    r_shadow[21] = "A";
+    r_shadow[22] = "N";
+    r_shadow[26] = 8'd4;
+  end
+
+  assign o_status = {r_bad, r_mismatches, r_passes};
+
+  // Register of the next entry
+  assign w_reg = (r_idx < 18) ? {1'b0, r_idx} :
+                 (r_idx < 23) ? r_idx + 6'd22 : r_idx + 6'd37;
+
+  assign w_check = i_aux_valid & (i_aux_slot == SLOT) & r_q1;
+
+  // Purpose: Shadow table
+  always @(posedge i_clk) begin
+    if (i_shadow_wr) begin
+      r_shadow[i_shadow_addr] <= i_shadow_data;
+    end
+  end
+
+  // Purpose: Issue the READs, check their results
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_ctrl_1 <= 1'b0;
+      r_idx <= 0;
+      r_cnt <= 0;
+      r_q0 <= 1'b0;
+      r_q0_idx <= 0;
+      r_q1 <= 1'b0;
+      r_q1_idx <= 0;
+      r_bad <= 1'b0;
+      r_mismatches <= 0;
+      r_passes <= 0;
+      o_flags <= 0;
+      o_alert <= 1'b0;
+      o_aux_en <= 1'b0;
+      o_aux_cmd <= 0;
+    end else begin
+      o_alert <= 1'b0;
+      r_ctrl_1 <= i_ctrl[1];
+
+      if (i_frame_start) begin
+        r_q1 <= r_q0;
+        r_q1_idx <= r_q0_idx;
+        r_q0 <= 1'b0;
+        o_aux_en <= 1'b0;
+        if (r_q0 & (r_q0_idx == N_ENTRIES-1)) begin
+          r_passes <= r_passes + 1'b1;
+        end
+        if (i_ctrl[0]) begin
+          if (r_cnt == 0) begin
+            o_aux_en <= 1'b1;
+            o_aux_cmd <= {2'b11, w_reg, 8'b0};
+            r_q0 <= 1'b1;
+            r_q0_idx <= r_idx;
+            r_cnt <= i_period;
+            r_idx <= (r_idx == N_ENTRIES-1) ? 5'd0 : r_idx + 1'b1;
+          end else begin
+            r_cnt <= r_cnt - 1'b1;
+          end
+        end
+      end else if (r_q0 & ~i_aux_grant) begin
+        // Slot taken for this frame, read the entry again at the next one
+        r_q0 <= 1'b0;
+        r_idx <= r_q0_idx;
+        r_cnt <= 0;
+        o_aux_en <= 1'b0;
+      end
+
+      if (w_check & ~i_frame_start) begin
+        r_q1 <= 1'b0;
+        if (i_mask[r_q1_idx] & ((i_aux_data[15:8] != 0) |
+                                (i_aux_data[7:0] != r_shadow[r_q1_idx]))) begin
+          r_bad <= 1'b1;
+          r_mismatches <= r_mismatches + 1'b1;
+          o_flags[r_q1_idx] <= 1'b1;
+          o_alert <= 1'b1;
+        end
+      end
+
+      if (i_ctrl[1] & ~r_ctrl_1) begin
+        r_bad <= 1'b0;
+        r_mismatches <= 0;
+        r_passes <= 0;
+        o_flags <= 0;
+      end
+    end
+  end
+
+endmodule // rhd_scrub
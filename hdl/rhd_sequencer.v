@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: RHD2164 acquisition sequencer
+//              Drives spi_master_cs on its own to sample all 64 channels
+//              continuously, without any PS involvement per transfer.
+//
+//              A frame is 32 CONVERT commands (channel 0 to 31, each
+//              returning channel c on MISO A and channel c+32 on MISO B)
+//              followed by N_AUX auxiliary commands taken from i_aux_cmd.
+//              A new frame starts every i_frame_period clock cycles, or back
+//              to back when i_frame_period is 0. A frame that cannot start
+//              on time because the previous one is still running counts as
+//              an overrun.
+//
+//              The RHD2164 returns the result of a command two transfers
+//              later, so every command is tagged and the tag follows it
+//              through a 3-deep pipeline. Results are published as a sample
+//              stream, one {dout_b, dout_a} pair per CONVERT:
+//              o_smp_valid - one clock cycle pulse per pair
+//              o_smp_ch    - CONVERT channel, 0 to 31
+//              o_smp_data  - {channel + 32, channel}
+//              o_smp_sof   - first pair of a frame (channel 0)
+//              o_smp_eof   - last pair of a frame (channel 31)
+//              o_smp_flags - o_frame_flags of the frame, set with o_smp_sof
+//                            and held until the next one
+//              Aux results come out on o_aux_*, with the aux slot index.
+//
+//              Several boards can be aligned with the sync signals:
+//              o_sync_out pulses high for SYNC_OUT_CLKS cycles at each frame
+//              start, and when i_sync_slave is set the frame timer is
+//              replaced by the rising edges of i_sync_in.
+//
+//              o_frame_flags is latched at each frame start and holds until
+//              the next one, so it covers all the sample pairs of the frame:
+//              [0] frame started by a pulse on i_sync_in
+//              [1] frames were missed since the previous frame (overrun)
+//              [15:8] i_dig_in, sampled at the frame start so that TTL
+//                     events are aligned with the samples of the frame
+//
+//              The sequencer only checks i_en between frames, so disabling
+//              it always completes the current frame. The results of the
+//              last aux commands of the run are dropped.
+//
+// Parameters:  N_AUX - Number of aux command slots per frame. Must be >= 2
+//              so that all CONVERT results of a frame come out during the
+//              same frame.
+//              SYNC_OUT_CLKS - Width of the o_sync_out pulse in clock cycles
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_sequencer #(
+  parameter N_AUX = 3,
+  parameter SYNC_OUT_CLKS = 16
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input                 i_en,           // Run continuous acquisition
+  input [31:0]          i_frame_period, // Clock cycles between frame starts
+  input [N_AUX*16-1:0]  i_aux_cmd,      // Aux slot commands, slot 0 in LSBs
+  input                 i_sync_slave,   // Start frames on i_sync_in instead of the timer
+
+  // Multi-board sync
+  input                 i_sync_in,      // Asynchronous, from another board
+  output                o_sync_out,
+
+  // Digital inputs, asynchronous
+  input [7:0]           i_dig_in,
+
+  // Status
+  output                o_busy,         // A frame is being sequenced
+  output reg            o_frame_start,  // Pulse when a frame starts
+  output reg [31:0]     o_frame_cnt,    // Number of frames started
+  output reg [15:0]     o_overruns,     // Frames that could not start on time
+  output reg [15:0]     o_frame_flags,
+
+  // SPI master handshake
+  output reg            o_start,
+  output reg [15:0]     o_din,
+  input                 i_done,
+  input [31:0]          i_dout,
+
+  // Sample stream
+  output reg            o_smp_valid,
+  output reg [4:0]      o_smp_ch,
+  output reg [31:0]     o_smp_data,
+  output reg            o_smp_sof,
+  output reg            o_smp_eof,
+  output reg [15:0]     o_smp_flags,
+
+  // Aux results
+  output reg            o_aux_valid,
+  output reg [3:0]      o_aux_slot,
+  output reg [15:0]     o_aux_data
+);
+
+  localparam N_CONVERT = 32;
+  localparam N_SLOTS   = N_CONVERT + N_AUX;
+
+  localparam IDLE  = 2'b00;
+  localparam START = 2'b01;
+  localparam WAIT  = 2'b10;
+
+  // Tags: {valid, aux, index}
+  localparam TAG_NONE = 7'b0;
+
+  reg [1:0] r_sm;
+  reg [5:0] r_slot;
+  reg [6:0] r_tag0; // In flight
+  reg [6:0] r_tag1;
+  reg [6:0] r_tag2; // Result received during the current transfer
+
+  reg [31:0] r_timer;
+  reg r_pending;
+  reg r_missed;   // Overrun since the last frame start
+
+  reg [2:0] r_sync_in;  // 2 FF synchronizer + edge detection
+  reg [7:0] r_sync_out_cnt;
+  reg [7:0] r_dig_meta;
+  reg [7:0] r_dig;
+
+  wire w_tick;
+  wire [5:0] w_aux_idx;
+  wire [6:0] w_tag;
+  wire [15:0] w_cmd;
+
+  assign o_busy = (r_sm != IDLE);
+
+  assign w_tick = i_sync_slave ? (r_sync_in[1] & ~r_sync_in[2])
+                              : (r_timer + 1'b1 >= i_frame_period);
+
+  assign o_sync_out = (r_sync_out_cnt != 0);
+
+  // Command and tag of the current slot
+  assign w_aux_idx = r_slot - N_CONVERT;
+  assign w_tag = (r_slot < N_CONVERT) ? {2'b10, r_slot[4:0]}
+                                      : {2'b11, w_aux_idx[4:0]};
+  assign w_cmd = (r_slot < N_CONVERT) ? {2'b00, r_slot, 8'h00}
+                                      : i_aux_cmd[w_aux_idx*16 +: 16];
+
+  // Purpose: Frame timer, or external sync in slave mode
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_timer <= 0;
+      r_pending <= 1'b0;
+      r_missed <= 1'b0;
+      r_sync_in <= 3'b0;
+      o_overruns <= 0;
+    end else begin
+      r_sync_in <= {r_sync_in[1:0], i_sync_in};
+
+      if (~i_en) begin
+        r_timer <= 0;
+        r_pending <= 1'b0;
+        r_missed <= 1'b0;
+      end else begin
+        if (o_frame_start) begin
+          r_missed <= 1'b0;
+        end
+
+        if (w_tick) begin
+          r_timer <= 0;
+          r_pending <= 1'b1;
+          if (r_pending & ~o_frame_start & (i_sync_slave | (i_frame_period != 0))) begin
+            o_overruns <= o_overruns + 1'b1;
+            r_missed <= 1'b1;
+          end
+        end else begin
+          r_timer <= r_timer + 1'b1;
+          if (o_frame_start) begin
+            r_pending <= 1'b0;
+          end
+        end
+      end
+    end
+  end
+
+  // Purpose: Synchronize the digital inputs
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_dig_meta <= 8'b0;
+      r_dig <= 8'b0;
+    end else begin
+      r_dig_meta <= i_dig_in;
+      r_dig <= r_dig_meta;
+    end
+  end
+
+  // Purpose: Stretch the frame start into the sync output pulse
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sync_out_cnt <= 0;
+    end else begin
+      if (o_frame_start) begin
+        r_sync_out_cnt <= SYNC_OUT_CLKS;
+      end else if (r_sync_out_cnt != 0) begin
+        r_sync_out_cnt <= r_sync_out_cnt - 1'b1;
+      end
+    end
+  end
+
+  // Purpose: Issue the commands of a frame and tag their results
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_slot <= 0;
+      r_tag0 <= TAG_NONE;
+      r_tag1 <= TAG_NONE;
+      r_tag2 <= TAG_NONE;
+      o_start <= 1'b0;
+      o_din <= 16'b0;
+      o_frame_start <= 1'b0;
+      o_frame_cnt <= 0;
+      o_frame_flags <= 16'b0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 16'b0;
+      o_aux_valid <= 1'b0;
+      o_aux_slot <= 0;
+      o_aux_data <= 0;
+    end else begin
+      o_frame_start <= 1'b0;
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_aux_valid <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (~i_en) begin
+          // Results still in the pipeline are lost once the PS takes over
+          r_tag0 <= TAG_NONE;
+          r_tag1 <= TAG_NONE;
+          r_tag2 <= TAG_NONE;
+        end else if (r_pending & i_done) begin
+          r_slot <= 0;
+          o_frame_start <= 1'b1;
+          o_frame_cnt <= o_frame_cnt + 1'b1;
+          o_frame_flags <= {r_dig, 6'b0, r_missed, i_sync_slave};
+          r_sm <= START;
+        end
+      end
+
+      START:
+      begin
+        // i_done drops on the cycle o_start is high
+        o_start <= ~o_start;
+        o_din <= w_cmd;
+        if (o_start) begin
+          r_tag0 <= w_tag;
+          r_tag1 <= r_tag0;
+          r_tag2 <= r_tag1;
+          r_sm <= WAIT;
+        end
+      end
+
+      WAIT:
+      begin
+        if (i_done) begin
+          if (r_tag2[6] & ~r_tag2[5]) begin
+            o_smp_valid <= 1'b1;
+            o_smp_ch <= r_tag2[4:0];
+            o_smp_data <= i_dout;
+            o_smp_sof <= (r_tag2[4:0] == 0);
+            o_smp_eof <= (r_tag2[4:0] == N_CONVERT-1);
+            if (r_tag2[4:0] == 0) begin
+              o_smp_flags <= o_frame_flags;
+            end
+          end else if (r_tag2[6]) begin
+            o_aux_valid <= 1'b1;
+            o_aux_slot <= r_tag2[3:0];
+            o_aux_data <= i_dout[15:0];
+          end
+
+          if (r_slot == N_SLOTS-1) begin
+            r_sm <= IDLE;
+          end else begin
+            r_slot <= r_slot + 1'b1;
+            r_sm <= START;
+          end
+        end
+      end
+
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+endmodule // rhd_sequencer
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Automatic amplifier fast settle
+//              Watches the raw sample stream for channels stuck at a rail, as
+//              after a movement artifact, and asserts amplifier fast settle
+//              (bit 5 of register 0) through aux slot 0 of the acquisition
+//              sequencer to recover them, without waiting for the PS.
+//
+//              A channel of i_mask whose samples are within i_margin of 0x0000
+//              or 0xFFFF for i_hits frames in a row triggers fast settle:
+//              WRITE(0, i_reg0 | 0x20) is sent in aux slot 0 from then on,
+//              within the same frame unless the channel is one of the last
+//              CONVERTs, and WRITE(0, i_reg0 & ~0x20) releases it in the
+//              (i_hold + 1)th frame after the trigger.
+//              Aux slot 0 then goes back to i_aux_cmd. Hits are not counted
+//              until the release is sent, so a channel still at a rail
+//              triggers again i_hits frames later.
+//
+//              Aux slot 0 may be taken by another module, e.g. rhd_zcheck.v
+//              during a sweep, in which case i_aux_grant is low for the whole
+//              frame. Only the frames where the slot was granted count
+//              towards i_hold, and the release is sent again until it goes
+//              out in a granted frame, so fast settle is never left asserted.
+//
+//              The counters of consecutive frames are kept in BRAM, both
+//              lanes of a pair being handled in 3 clock cycles.
+//
+//              Status (o_status):
+//              [31]     fast settle asserted
+//              [21:16]  channel that triggered the last fast settle
+//              [15:0]   number of fast settles
+//
+//              Samples are offset binary (0x8000 = 0).
+//
+//              Control bits (i_ctrl): [0] enable, applied at the start of a
+//              frame. A fast settle in progress is always released.
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_settle (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input         i_ctrl,
+  input  [63:0] i_mask,   // Channels watched
+  input  [15:0] i_margin, // Distance to the rails counted as a hit
+  input  [7:0]  i_hits,   // Frames in a row at a rail to trigger, 0 = 1
+  input  [15:0] i_hold,   // Frames with fast settle, 0 = 1
+  input  [7:0]  i_reg0,   // Register 0, fast settle bit excluded
+  output [31:0] o_status,
+
+  // Sequencer
+  input             i_frame_start,
+  input             i_aux_grant, // Aux slot 0 is not taken by another module
+  output reg        o_aux_en,    // Replace aux slot 0
+  output reg [15:0] o_aux_cmd,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof
+);
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  reg [7:0] r_cnt [0:63]; // Frames in a row at a rail
+  reg [7:0] r_cnt_q;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_run;
+
+  reg r_settle;
+  reg r_release;
+  reg r_granted;  // Aux slot 0 granted during the whole frame
+  reg [15:0] r_hold_cnt;
+  reg [5:0] r_last_ch;
+  reg [15:0] r_settles;
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire [5:0] w_c;
+  wire [15:0] w_x;
+  wire w_hit;
+  wire [7:0] w_cnt_next;
+  wire w_trigger;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_cnt[i] = 0;
+    end
+  end
+
+  assign o_status = {r_settle, 9'b0, r_last_ch, r_settles};
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+  assign w_c = {w_lane, r_ch};
+
+  // Datapath, shared by both lanes
+  assign w_x = w_lane ? r_data[31:16] : r_data[15:0];
+  assign w_hit = r_run & ~r_settle & ~r_release & i_mask[w_c] &
+                 ((w_x <= i_margin) | (w_x >= ~i_margin));
+  assign w_cnt_next = ~w_hit ? 8'd0 : (&r_cnt_q) ? r_cnt_q : r_cnt_q + 1'b1;
+  assign w_trigger = (r_sm != IDLE) & w_hit & (w_cnt_next >= ((i_hits == 0) ? 8'd1 : i_hits));
+
+  // Purpose: Counters, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (r_sm != IDLE) begin
+      r_cnt[w_c] <= w_cnt_next;
+    end
+    r_cnt_q <= r_cnt[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_run <= 1'b0;
+    end else begin
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_sm <= LANE_A;
+          if (i_smp_sof) begin
+            r_run <= i_ctrl;
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+      end
+      default:
+      begin
+        r_sm <= IDLE;
+      end
+      endcase
+    end
+  end
+
+  // Purpose: Assert fast settle, release it after i_hold frames
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_settle <= 1'b0;
+      r_release <= 1'b0;
+      r_granted <= 1'b0;
+      r_hold_cnt <= 0;
+      r_last_ch <= 0;
+      r_settles <= 0;
+      o_aux_en <= 1'b0;
+      o_aux_cmd <= 0;
+    end else begin
+      if (i_frame_start) begin
+        r_granted <= i_aux_grant;
+      end else if (~i_aux_grant) begin
+        r_granted <= 1'b0;
+      end
+
+      if (w_trigger) begin
+        r_settle <= 1'b1;
+        r_hold_cnt <= (i_hold == 0) ? 16'd1 : i_hold;
+        r_last_ch <= w_c;
+        r_settles <= r_settles + 1'b1;
+        o_aux_en <= 1'b1;
+        o_aux_cmd <= {2'b10, 6'd0, i_reg0 | 8'h20};
+      end else if (i_frame_start & r_granted) begin
+        if (r_settle) begin
+          if (r_hold_cnt == 0) begin
+            r_settle <= 1'b0;
+            r_release <= 1'b1;
+            o_aux_cmd <= {2'b10, 6'd0, i_reg0 & ~8'h20};
+          end else begin
+            r_hold_cnt <= r_hold_cnt - 1'b1;
+          end
+        end else if (r_release) begin
+          r_release <= 1'b0;
+          o_aux_en <= 1'b0;
+        end
+      end
+    end
+  end
+
+endmodule // rhd_settle
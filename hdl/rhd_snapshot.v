@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Latest-value snapshot bank
+//              Holds the most recent sample of each of the 64 channels in a
+//              memory-mapped register bank, for control loops that only need
+//              the newest value per channel.
+//
+//              Samples of the stream are collected in a shadow bank, which
+//              is copied to the visible bank at the end of every frame, so
+//              the visible bank always holds a complete frame. The frame
+//              generation counter is incremented at the same time.
+//
+//              Memory map (32-bit words):
+//              0       frame generation counter
+//              1 + n   {generation[15:0], channel n}, n = 0 to 63
+//              65      {generation[15:0], frame flags}, which hold the
+//                      digital inputs sampled at the start of the frame
+//                      (i_smp_flags, carried with the frame by the stages
+//                      of the stream)
+//
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address =
+//              byte address [8:2]) and the whole bank can be read with a
+//              single burst. The burst is consistent when the generation in
+//              the upper half of every channel word is the same.
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_snapshot (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Read port
+  input             i_rd_en,
+  input [6:0]       i_rd_addr,
+  output reg [31:0] o_rd_data
+);
+
+  reg [31:0] r_shadow [0:31];
+  reg [31:0] r_bank [0:31];
+  reg [31:0] r_gen;
+  reg [15:0] r_flags;
+
+  wire [31:0] w_pair;
+  wire [15:0] w_sample;
+
+  integer i;
+
+  // Purpose: Collect the frame, publish it at the end of the frame
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_gen <= 0;
+      r_flags <= 0;
+      for (i = 0; i < 32; i = i + 1) begin
+        r_shadow[i] <= 0;
+        r_bank[i] <= 0;
+      end
+    end else begin
+      if (i_smp_valid) begin
+        r_shadow[i_smp_ch] <= i_smp_data;
+        if (i_smp_eof) begin
+          for (i = 0; i < 32; i = i + 1) begin
+            r_bank[i] <= r_shadow[i];
+          end
+          r_bank[i_smp_ch] <= i_smp_data; // Last pair of the frame, still in flight
+          r_flags <= i_smp_flags;
+          r_gen <= r_gen + 1'b1;
+        end
+      end
+    end
+  end
+
+  // Channel n is MISO A of pair n for n < 32, MISO B of pair n-32 otherwise
+  assign w_pair = r_bank[i_rd_addr[4:0] - 1'b1];
+  assign w_sample = (i_rd_addr > 7'd32) ? w_pair[31:16] : w_pair[15:0];
+
+  // Purpose: Read port
+  always @(posedge i_clk) begin
+    if (i_rd_en) begin
+      if (i_rd_addr == 0) begin
+        o_rd_data <= r_gen;
+      end else if (i_rd_addr <= 7'd64) begin
+        o_rd_data <= {r_gen[15:0], w_sample};
+      end else if (i_rd_addr == 7'd65) begin
+        o_rd_data <= {r_gen[15:0], r_flags};
+      end else begin
+        o_rd_data <= 32'b0;
+      end
+    end
+  end
+
+endmodule // rhd_snapshot
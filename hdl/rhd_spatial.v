@@ -0,0 +1,339 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Spatial filter matrix
+//              Multiplies every frame by an M x 64 weight matrix:
+//                y[m] = sum over n of W[m][n] * x[n], m = 0 to M-1
+//              which covers bipolar montages, Laplacians and projections onto
+//              a few components, so that only M channels leave the PL.
+//
+//              Weights are signed Q2.14 (16384 = 1.0), written through
+//              i_coef_wr/i_coef_addr/i_coef_data at address {m, n}. Writes go
+//              to the inactive one of two weight banks, and a rising edge on
+//              i_ctrl[1] swaps the banks at the next start of frame, so a
+//              frame is never filtered with a mix of two matrices. The swap
+//              only affects the accumulation, so it also happens while the
+//              outputs of the previous frame are being sent. The
+//              inactive bank then holds the previous matrix: write the whole
+//              matrix before each commit. After reset both banks hold the
+//              identity.
+//
+//              The products are accumulated as the pairs arrive, N_PAR
+//              outputs at a time with two multipliers each (DSP48), so a pair
+//              takes M/N_PAR+1 clock cycles, which must be shorter than a SPI
+//              transfer. Once the last pair of the frame is in, the outputs
+//              are rounded, saturated and sent as M/2 pairs, one every 4
+//              clock cycles, pair k being {y[k+M/2], y[k]}. For M = 64 this
+//              is the usual channel order.
+//
+//              When the stream goes straight through, its pairs pass through
+//              a 32-pair FIFO that is held while outputs are being sent. The
+//              stage can thus be disabled at any start of frame, with frames
+//              back to back: the pairs of the first bypassed frame wait for
+//              the outputs of the last filtered one and follow them, one
+//              every 4 clock cycles, until the FIFO is empty.
+//
+//              The frame flags of a filtered frame are published with its
+//              outputs, those of a bypassed frame wait with its pairs in the
+//              FIFO.
+//
+//              Samples are offset binary (0x8000 = 0) on both sides.
+//
+//              Control bits (i_ctrl):
+//              [0] enable, the stream goes straight through when cleared. It
+//                  is applied at the start of a frame.
+//              [1] commit the weights written since the last commit
+//
+// Parameters:  M     - Number of output channels, even, up to 64
+//              N_PAR - Outputs computed in parallel, a power of two dividing M
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_spatial #(
+  parameter M = 64,
+  parameter N_PAR = 4
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input [1:0] i_ctrl,
+
+  // Weight matrix
+  input        i_coef_wr,
+  input [11:0] i_coef_addr, // {m, n}
+  input [15:0] i_coef_data,
+
+  // Sample stream in
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags, // Frame flags, taken with i_smp_sof
+
+  // Sample stream out
+  output reg        o_smp_valid,
+  output reg [4:0]  o_smp_ch,
+  output reg [31:0] o_smp_data,
+  output reg        o_smp_sof,
+  output reg        o_smp_eof,
+  output reg [15:0] o_smp_flags
+);
+
+  localparam G = M / N_PAR; // Groups of outputs computed together
+  localparam PAIR_CLKS = 4;
+
+  localparam IDLE = 2'b00;
+  localparam RUN  = 2'b01;
+
+  reg r_en;
+  reg r_bank;
+  reg r_commit;
+  reg r_ctrl_1;
+
+  reg [1:0] r_sm;
+  reg [5:0] r_grp_rd;  // Group whose weights are read
+  reg [5:0] r_grp;     // Group being accumulated, one cycle later
+  reg r_mac;
+  reg [4:0] r_ch;
+  reg signed [15:0] r_xa;
+  reg signed [15:0] r_xb;
+  reg r_sof;
+  reg r_eof;
+  reg [15:0] r_flags;     // Frame being accumulated
+  reg [15:0] r_res_flags; // Frame whose outputs are sent
+
+  reg r_play;
+  reg [4:0] r_cnt;
+  reg [1:0] r_pace;
+
+  // Bypass FIFO, {flags, sof, eof, ch, data}
+  reg [54:0] r_fifo [0:31];
+  reg [5:0] r_f_wr;
+  reg [5:0] r_f_rd;
+  reg [1:0] r_f_pace;
+
+  wire w_en;
+  wire w_f_rd;
+  wire [54:0] w_f_q;
+  wire w_swap;
+  wire w_last;
+  wire [5:0] w_coef_m;
+  wire [5:0] w_coef_n;
+  wire [31:0] w_wr_base;
+  wire [31:0] w_rd_base;
+  wire [16*M-1:0] w_res; // Outputs of the last frame, offset binary
+
+  // The matrix and the bypass are switched between frames only
+  assign w_swap = i_smp_valid & i_smp_sof & (r_sm == IDLE);
+  assign w_en = w_swap ? i_ctrl[0] : r_en;
+
+  // Bypassed pairs wait for the outputs of the last filtered frame
+  assign w_f_rd = (r_f_wr != r_f_rd) & (r_f_pace == PAIR_CLKS-1) & ~r_play & ~w_last;
+  assign w_f_q = r_fifo[r_f_rd[4:0]];
+
+  assign w_last = r_mac & r_eof & (r_grp == G-1);
+  assign w_coef_m = i_coef_addr[11:6];
+  assign w_coef_n = i_coef_addr[5:0];
+
+  // Writes go to the inactive bank
+  assign w_wr_base = r_bank ? 0 : G*32;
+  assign w_rd_base = r_bank ? G*32 : 0;
+
+  genvar p;
+  genvar g;
+  generate
+    for (p = 0; p < N_PAR; p = p + 1) begin : lane
+      // Weights of lane A and B inputs, {bank, group, ch}
+      reg signed [15:0] r_wa [0:2*G*32-1];
+      reg signed [15:0] r_wb [0:2*G*32-1];
+      reg signed [15:0] r_wa_q;
+      reg signed [15:0] r_wb_q;
+      reg signed [39:0] r_acc [0:G-1];
+      reg [16*G-1:0] r_res;
+
+      wire signed [39:0] w_acc_in;
+      wire signed [39:0] w_acc;
+      wire signed [39:0] w_acc_r;
+      wire [15:0] w_y;
+      integer j;
+
+      initial begin
+        for (j = 0; j < 2*G*32; j = j + 1) begin
+          r_wa[j] = (((j / 32) % G) * N_PAR + p == j % 32) ? 16'sd16384 : 16'sd0;
+          r_wb[j] = (((j / 32) % G) * N_PAR + p == j % 32 + 32) ? 16'sd16384 : 16'sd0;
+        end
+      end
+
+      // Purpose: Weight banks, no reset so they map to BRAM
+      always @(posedge i_clk) begin
+        if (i_coef_wr & (w_coef_m % N_PAR == p) & (w_coef_m < M)) begin
+          if (w_coef_n[5]) begin
+            r_wb[w_wr_base + (w_coef_m / N_PAR) * 32 + w_coef_n[4:0]] <= i_coef_data;
+          end else begin
+            r_wa[w_wr_base + (w_coef_m / N_PAR) * 32 + w_coef_n[4:0]] <= i_coef_data;
+          end
+        end
+        r_wa_q <= r_wa[w_rd_base + r_grp_rd * 32 + r_ch];
+        r_wb_q <= r_wb[w_rd_base + r_grp_rd * 32 + r_ch];
+      end
+
+      // Multiply-accumulate, both lanes of the pair at once
+      assign w_acc_in = r_sof ? 40'sd0 : r_acc[r_grp];
+      assign w_acc = w_acc_in + r_wa_q * r_xa + r_wb_q * r_xb;
+
+      // Round, scale back from Q2.14 and saturate
+      assign w_acc_r = w_acc + 40'sd8192;
+      assign w_y = ((&w_acc_r[39:29]) | ~(|w_acc_r[39:29])) ? {~w_acc_r[29], w_acc_r[28:14]}
+                                                            : {~w_acc_r[39], {15{~w_acc_r[39]}}};
+
+      // Purpose: Accumulators, publish the outputs with the last pair
+      always @(posedge i_clk) begin
+        if (r_mac) begin
+          r_acc[r_grp] <= w_acc;
+          if (r_eof) begin
+            r_res[r_grp*16 +: 16] <= w_y;
+          end
+        end
+      end
+
+      // Output m = g * N_PAR + p
+      for (g = 0; g < G; g = g + 1) begin : out
+        assign w_res[(g*N_PAR + p)*16 +: 16] = r_res[g*16 +: 16];
+      end
+    end
+  endgenerate
+
+  // Purpose: Bypass FIFO, no reset so it maps to distributed RAM
+  always @(posedge i_clk) begin
+    if (i_smp_valid & ~w_en) begin
+      r_fifo[r_f_wr[4:0]] <= {i_smp_flags, i_smp_sof, i_smp_eof, i_smp_ch, i_smp_data};
+    end
+  end
+
+  // Purpose: Read the weights of every group for each pair, then send the
+  // outputs once the frame is complete
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_en <= 1'b0;
+      r_bank <= 1'b0;
+      r_commit <= 1'b0;
+      r_ctrl_1 <= 1'b0;
+      r_sm <= IDLE;
+      r_grp_rd <= 0;
+      r_grp <= 0;
+      r_mac <= 1'b0;
+      r_ch <= 0;
+      r_xa <= 0;
+      r_xb <= 0;
+      r_sof <= 1'b0;
+      r_eof <= 1'b0;
+      r_flags <= 0;
+      r_res_flags <= 0;
+      r_play <= 1'b0;
+      r_cnt <= 0;
+      r_pace <= 0;
+      r_f_wr <= 0;
+      r_f_rd <= 0;
+      r_f_pace <= 0;
+      o_smp_valid <= 1'b0;
+      o_smp_ch <= 0;
+      o_smp_data <= 0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      o_smp_flags <= 0;
+    end else begin
+      o_smp_valid <= 1'b0;
+      o_smp_sof <= 1'b0;
+      o_smp_eof <= 1'b0;
+      r_ctrl_1 <= i_ctrl[1];
+
+      if (w_swap) begin
+        r_en <= i_ctrl[0];
+        if (r_commit) begin
+          r_commit <= 1'b0;
+          r_bank <= ~r_bank;
+        end
+      end
+
+      if (i_ctrl[1] & ~r_ctrl_1) begin
+        r_commit <= 1'b1;
+      end
+
+      // Bypass
+      if (i_smp_valid & ~w_en) begin
+        r_f_wr <= r_f_wr + 1'b1;
+      end
+      if (w_f_rd) begin
+        r_f_rd <= r_f_rd + 1'b1;
+        r_f_pace <= 0;
+        o_smp_valid <= 1'b1;
+        o_smp_ch <= w_f_q[36:32];
+        o_smp_data <= w_f_q[31:0];
+        o_smp_sof <= w_f_q[38];
+        o_smp_eof <= w_f_q[37];
+        if (w_f_q[38]) begin
+          o_smp_flags <= w_f_q[54:39];
+        end
+      end else if (r_f_pace != PAIR_CLKS-1) begin
+        r_f_pace <= r_f_pace + 1'b1;
+      end
+
+      r_mac <= (r_sm == RUN);
+      r_grp <= r_grp_rd;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid & w_en) begin
+          r_ch <= i_smp_ch;
+          r_xa <= {~i_smp_data[15], i_smp_data[14:0]};
+          r_xb <= {~i_smp_data[31], i_smp_data[30:16]};
+          r_sof <= i_smp_sof;
+          r_eof <= i_smp_eof;
+          if (i_smp_sof) begin
+            r_flags <= i_smp_flags;
+          end
+          r_grp_rd <= 0;
+          r_sm <= RUN;
+        end
+      end
+      RUN:
+      begin
+        // Weights of r_grp_rd are read this cycle
+        if (r_grp_rd == G-1) begin
+          r_sm <= IDLE;
+        end else begin
+          r_grp_rd <= r_grp_rd + 1'b1;
+        end
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+
+      // Send the outputs once the last group of the frame is accumulated
+      if (w_last) begin
+        r_play <= 1'b1;
+        r_res_flags <= r_flags;
+        r_cnt <= 0;
+        r_pace <= 0;
+      end else if (r_play) begin
+        r_pace <= r_pace + 1'b1;
+        if (r_pace == PAIR_CLKS-1) begin
+          o_smp_valid <= 1'b1;
+          o_smp_ch <= r_cnt;
+          o_smp_data <= {w_res[(r_cnt + M/2)*16 +: 16], w_res[r_cnt*16 +: 16]};
+          o_smp_sof <= (r_cnt == 0);
+          o_smp_eof <= (r_cnt == M/2-1);
+          if (r_cnt == 0) begin
+            o_smp_flags <= r_res_flags;
+          end
+          r_cnt <= r_cnt + 1'b1;
+          if (r_cnt == M/2-1) begin
+            r_play <= 1'b0;
+          end
+        end
+      end
+    end
+  end
+
+endmodule // rhd_spatial
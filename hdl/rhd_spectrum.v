@@ -0,0 +1,516 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Spectral feature engine
+//              Computes the spectrum of every channel of the sample stream
+//              over windows of the last N = 2^FFT_BITS frames, every i_hop
+//              frames, and publishes for each channel:
+//                MNF  mean frequency, sum(k * P[k]) / sum(P[k]), in bins with
+//                     8 fractional bits
+//                MDF  median frequency, the first bin at which the cumulated
+//                     power reaches half of the total
+//                the total power and the power of 4 bands
+//              with P[k] = |X[k]|^2 over the bins k = 1 to N/2-1, bin k being
+//              k * fs / N. MDF tracks muscle fatigue.
+//
+//              The samples go through a Hann window and a radix-2 FFT, one
+//              channel after the other, on a single butterfly (4 DSP48) with
+//              the data in BRAM. The FFT is not scaled, so it is exact up to
+//              the rounding of the products. Powers are published divided by
+//              N^2, the total then being the mean square of the windowed
+//              samples over these bins.
+//
+//              A window takes about 64 * N * (3 * FFT_BITS / 2 + 2) clock
+//              cycles. A window due while the previous one is still being
+//              processed is skipped and counted, so i_hop has to be longer
+//              than this. It also has to be shorter than N frames, as the
+//              history holds 2N frames. The windows may overlap.
+//
+//              i_hop and i_bands are latched when the engine is enabled, at
+//              the start of a frame. The first window is processed once N
+//              frames are in. Band b covers the bins e[b-1] < k <= e[b], e[b]
+//              being byte b of i_bands and e[-1] = 0.
+//
+//              Memory map of the read port (32-bit words), the features being
+//              double buffered so they are never read half updated:
+//              8n + 0    MNF of channel n, n = 0 to 63
+//              8n + 1    MDF of channel n
+//              8n + 2    total power of channel n
+//              8n + 3-6  power of bands 0 to 3 of channel n
+//              8n + 7    0
+//              512       generation, incremented with each window
+//              513       number of skipped windows
+//
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address =
+//              byte address [11:2]). o_spec_ready pulses when the features of
+//              a window are published and can be used as an interrupt.
+//
+//              Samples are offset binary (0x8000 = 0).
+//
+//              Control bits (i_ctrl): [0] enable
+//
+// Parameters:  FFT_BITS - log2 of the window length, in frames, 4 to 8
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_spectrum #(
+  parameter FFT_BITS = 8
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [15:0] i_hop,   // Frames between windows, 0 = 1
+  input [31:0] i_bands, // Upper bin of each band
+  output reg   o_spec_ready,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+
+  // Read port
+  input             i_rd_en,
+  input [9:0]       i_rd_addr,
+  output reg [31:0] o_rd_data
+);
+
+  localparam L = FFT_BITS;
+  localparam N = 1 << FFT_BITS;
+  localparam W = 17 + FFT_BITS; // FFT data, grows by one bit per stage
+  localparam real PI = 3.141592653589793;
+
+  localparam E_IDLE  = 3'd0;
+  localparam E_LOAD  = 3'd1; // Window the samples into the FFT buffer
+  localparam E_BF    = 3'd2; // Butterflies
+  localparam E_POW1  = 3'd3; // Powers, total, bands and sum(k * P[k])
+  localparam E_POW2  = 3'd4; // Median
+  localparam E_DIV   = 3'd5; // Mean
+  localparam E_STORE = 3'd6;
+
+  // Sample pairs of the last 2N frames, {slot, ch}
+  reg [31:0] r_hist [0:64*N-1];
+  reg [31:0] r_hist_q;
+  reg [L:0] r_ptr;    // Slot of the current frame
+
+  // Window and twiddle factors, 65536 = 1.0
+  reg [16:0] r_hann [0:N-1];
+  reg [16:0] r_hann_q;
+  reg signed [17:0] r_tw_re [0:N/2-1];
+  reg signed [17:0] r_tw_im [0:N/2-1];
+  reg signed [17:0] r_tw_re_q;
+  reg signed [17:0] r_tw_im_q;
+
+  // FFT buffer {re, im}, two ports, and powers
+  reg [2*W-1:0] r_x [0:N-1];
+  reg [2*W-1:0] r_xa_q;
+  reg [2*W-1:0] r_xb_q;
+  reg [47:0] r_pow [0:N/2-1];
+  reg [47:0] r_pow_q;
+
+  // Published features, {MNF, MDF, total, band 0 to 3} per bank and channel
+  reg [223:0] r_feat [0:127];
+  reg [223:0] r_feat_q;
+  reg r_vis;   // Bank visible on the read port
+  reg [31:0] r_gen;
+  reg [31:0] r_skip;
+  reg [1:0] r_rd_sel;
+  reg [2:0] r_rd_word;
+
+  // Window scheduling
+  reg r_run;
+  reg [15:0] r_hop;
+  reg [31:0] r_bands;
+  reg [L:0] r_fill;   // Frames since enabled, saturates at N-1
+  reg [15:0] r_hop_cnt;
+
+  // Engine
+  reg [2:0] r_es;
+  reg [5:0] r_ech;
+  reg [L:0] r_win_ptr; // Slot of the oldest frame of the window
+  reg [L:0] r_n;
+  reg r_ld_v;
+  reg [L-1:0] r_ld_addr;
+  reg [1:0] r_ph;
+  reg [3:0] r_stage;
+  reg [L-1:0] r_c;
+  reg signed [W-1:0] r_t_re;
+  reg signed [W-1:0] r_t_im;
+  reg [L-1:0] r_k;
+  reg [L-1:0] r_pk;
+  reg r_pv;
+  reg [47:0] r_tot;
+  reg [63:0] r_kp;
+  reg [47:0] r_band0;
+  reg [47:0] r_band1;
+  reg [47:0] r_band2;
+  reg [47:0] r_band3;
+  reg [47:0] r_cum;
+  reg r_found;
+  reg [L-1:0] r_mdf;
+  reg [63:0] r_rem;
+  reg [15:0] r_q;
+  reg [3:0] r_dbit;
+
+  wire w_full;
+  wire w_due;
+
+  wire [15:0] w_hx;
+  wire signed [15:0] w_hxs;
+  wire signed [34:0] w_xw_p;
+  wire signed [15:0] w_xw;
+
+  wire [L-1:0] w_half;
+  wire [L-1:0] w_addr_a;
+  wire [L-1:0] w_addr_b;
+  wire [L-2:0] w_tw;
+  wire [L-1:0] w_xa_addr;
+  wire w_we_a;
+  wire w_we_b;
+  wire [2*W-1:0] w_din_a;
+  wire [2*W-1:0] w_din_b;
+
+  wire signed [W-1:0] w_a_re;
+  wire signed [W-1:0] w_a_im;
+  wire signed [W-1:0] w_b_re;
+  wire signed [W-1:0] w_b_im;
+  wire signed [W+18:0] w_p_re;
+  wire signed [W+18:0] w_p_im;
+
+  wire [47:0] w_p;
+  wire [47:0] w_cum_next;
+  wire [63:0] w_den;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < N; i = i + 1) begin
+      r_hann[i] = $rtoi($floor(65536.0 * (0.5 - 0.5 * $cos(2.0 * PI * i / N)) + 0.5));
+    end
+    for (i = 0; i < N/2; i = i + 1) begin
+      r_tw_re[i] = $rtoi($floor(65536.0 * $cos(2.0 * PI * i / N) + 0.5));
+      r_tw_im[i] = $rtoi($floor(-65536.0 * $sin(2.0 * PI * i / N) + 0.5));
+    end
+  end
+
+  function [L-1:0] bitrev;
+    input [L-1:0] n;
+    integer b;
+    begin
+      for (b = 0; b < L; b = b + 1) begin
+        bitrev[b] = n[L-1-b];
+      end
+    end
+  endfunction
+
+  // A window completes with this frame
+  assign w_full = (r_fill >= N - 1);
+  assign w_due = r_run & w_full & (r_hop_cnt == 0);
+
+  // Windowed sample, lane B for channels 32 to 63
+  assign w_hx = r_ech[5] ? r_hist_q[31:16] : r_hist_q[15:0];
+  assign w_hxs = {~w_hx[15], w_hx[14:0]};
+  assign w_xw_p = w_hxs * $signed({1'b0, r_hann_q}) + 32768;
+  assign w_xw = w_xw_p[31:16];
+
+  // Butterfly c of stage s: a = X[g + j], b = X[g + j + 2^s], twiddle j * N / 2^(s+1)
+  assign w_half = 1 << r_stage;
+  assign w_addr_a = ((r_c >> r_stage) << (r_stage + 1)) | (r_c & (w_half - 1'b1));
+  assign w_addr_b = w_addr_a | w_half;
+  assign w_tw = r_c << (L - 1 - r_stage);
+
+  assign {w_a_re, w_a_im} = r_xa_q;
+  assign {w_b_re, w_b_im} = r_xb_q;
+
+  // b * twiddle, rounded
+  assign w_p_re = w_b_re * r_tw_re_q - w_b_im * r_tw_im_q + 32768;
+  assign w_p_im = w_b_re * r_tw_im_q + w_b_im * r_tw_re_q + 32768;
+
+  assign w_xa_addr = (r_es == E_LOAD) ? r_ld_addr :
+                     (r_es == E_BF) ? w_addr_a : r_k;
+  assign w_we_a = ((r_es == E_LOAD) & r_ld_v) | ((r_es == E_BF) & (r_ph == 2'd2));
+  assign w_we_b = (r_es == E_BF) & (r_ph == 2'd2);
+  assign w_din_a = (r_es == E_LOAD) ? {{(W-16){w_xw[15]}}, w_xw, {W{1'b0}}}
+                                    : {w_a_re + r_t_re, w_a_im + r_t_im};
+  assign w_din_b = {w_a_re - r_t_re, w_a_im - r_t_im};
+
+  // Power of the bin read on port A
+  assign w_p = w_a_re * w_a_re + w_a_im * w_a_im;
+  assign w_cum_next = r_cum + r_pow_q;
+  assign w_den = {16'b0, r_tot} << r_dbit;
+
+  // Purpose: History and FFT buffers, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (i_smp_valid) begin
+      r_hist[{r_ptr, i_smp_ch}] <= i_smp_data;
+    end
+    r_hist_q <= r_hist[{r_win_ptr + r_n, r_ech[4:0]}];
+    r_hann_q <= r_hann[r_n[L-1:0]];
+    r_tw_re_q <= r_tw_re[w_tw];
+    r_tw_im_q <= r_tw_im[w_tw];
+  end
+
+  always @(posedge i_clk) begin
+    if (w_we_a) begin
+      r_x[w_xa_addr] <= w_din_a;
+    end
+    r_xa_q <= r_x[w_xa_addr];
+  end
+
+  always @(posedge i_clk) begin
+    if (w_we_b) begin
+      r_x[w_addr_b] <= w_din_b;
+    end
+    r_xb_q <= r_x[w_addr_b];
+  end
+
+  always @(posedge i_clk) begin
+    if ((r_es == E_POW1) & r_pv) begin
+      r_pow[r_pk] <= w_p;
+    end
+    r_pow_q <= r_pow[r_k];
+  end
+
+  always @(posedge i_clk) begin
+    if (r_es == E_STORE) begin
+      r_feat[{~r_vis, r_ech}] <= {16'b0, r_q, {(32-L){1'b0}}, r_mdf,
+                                  r_tot[2*L +: 32], r_band0[2*L +: 32], r_band1[2*L +: 32],
+                                  r_band2[2*L +: 32], r_band3[2*L +: 32]};
+    end
+  end
+
+  // Purpose: Schedule the windows, run the FFT and the features of each
+  // channel in turn
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_ptr <= 0;
+      r_run <= 1'b0;
+      r_hop <= 1;
+      r_bands <= 0;
+      r_fill <= 0;
+      r_hop_cnt <= 0;
+      r_skip <= 0;
+      r_vis <= 1'b0;
+      r_gen <= 0;
+      r_es <= E_IDLE;
+      r_ech <= 0;
+      r_win_ptr <= 0;
+      r_n <= 0;
+      r_ld_v <= 1'b0;
+      r_ld_addr <= 0;
+      r_ph <= 0;
+      r_stage <= 0;
+      r_c <= 0;
+      r_t_re <= 0;
+      r_t_im <= 0;
+      r_k <= 0;
+      r_pk <= 0;
+      r_pv <= 1'b0;
+      r_tot <= 0;
+      r_kp <= 0;
+      r_band0 <= 0;
+      r_band1 <= 0;
+      r_band2 <= 0;
+      r_band3 <= 0;
+      r_cum <= 0;
+      r_found <= 1'b0;
+      r_mdf <= 0;
+      r_rem <= 0;
+      r_q <= 0;
+      r_dbit <= 0;
+      o_spec_ready <= 1'b0;
+    end else begin
+      o_spec_ready <= 1'b0;
+
+      case (r_es)
+      E_IDLE:
+      begin
+      end
+      E_LOAD:
+      begin
+        // One sample per clock cycle, in bit-reversed order
+        if (r_n != N) begin
+          r_ld_addr <= bitrev(r_n[L-1:0]);
+          r_ld_v <= 1'b1;
+          r_n <= r_n + 1'b1;
+        end else begin
+          r_ld_v <= 1'b0;
+          r_ph <= 0;
+          r_stage <= 0;
+          r_c <= 0;
+          r_es <= E_BF;
+        end
+      end
+      E_BF:
+      begin
+        // Read a and b, multiply, write back
+        case (r_ph)
+        2'd0:
+          r_ph <= 2'd1;
+        2'd1:
+        begin
+          r_t_re <= w_p_re[W+15:16];
+          r_t_im <= w_p_im[W+15:16];
+          r_ph <= 2'd2;
+        end
+        default:
+        begin
+          r_ph <= 2'd0;
+          if (r_c == N/2 - 1) begin
+            r_c <= 0;
+            if (r_stage == L - 1) begin
+              r_k <= 1;
+              r_pv <= 1'b0;
+              r_tot <= 0;
+              r_kp <= 0;
+              r_band0 <= 0;
+              r_band1 <= 0;
+              r_band2 <= 0;
+              r_band3 <= 0;
+              r_es <= E_POW1;
+            end else begin
+              r_stage <= r_stage + 1'b1;
+            end
+          end else begin
+            r_c <= r_c + 1'b1;
+          end
+        end
+        endcase
+      end
+      E_POW1:
+      begin
+        // Bin r_k is read while bin r_pk is accumulated
+        r_pk <= r_k;
+        r_pv <= (r_k != N/2);
+        if (r_k != N/2) begin
+          r_k <= r_k + 1'b1;
+        end else if (~r_pv) begin
+          r_k <= 1;
+          r_cum <= 0;
+          r_found <= 1'b0;
+          r_mdf <= 0;
+          r_es <= E_POW2;
+        end
+        if (r_pv) begin
+          r_tot <= r_tot + w_p;
+          r_kp <= r_kp + w_p * r_pk;
+          if (r_pk <= r_bands[7:0]) begin
+            r_band0 <= r_band0 + w_p;
+          end
+          if ((r_pk > r_bands[7:0]) & (r_pk <= r_bands[15:8])) begin
+            r_band1 <= r_band1 + w_p;
+          end
+          if ((r_pk > r_bands[15:8]) & (r_pk <= r_bands[23:16])) begin
+            r_band2 <= r_band2 + w_p;
+          end
+          if ((r_pk > r_bands[23:16]) & (r_pk <= r_bands[31:24])) begin
+            r_band3 <= r_band3 + w_p;
+          end
+        end
+      end
+      E_POW2:
+      begin
+        r_pk <= r_k;
+        r_pv <= (r_k != N/2);
+        if (r_k != N/2) begin
+          r_k <= r_k + 1'b1;
+        end else if (~r_pv) begin
+          r_rem <= r_kp << 8;
+          r_q <= 0;
+          r_dbit <= 4'd15;
+          r_es <= E_DIV;
+        end
+        if (r_pv) begin
+          r_cum <= w_cum_next;
+          if (~r_found & ({w_cum_next, 1'b0} >= {1'b0, r_tot})) begin
+            r_found <= 1'b1;
+            r_mdf <= r_pk;
+          end
+        end
+      end
+      E_DIV:
+      begin
+        // Restoring division, one quotient bit per clock cycle
+        if ((r_tot != 0) & (r_rem >= w_den)) begin
+          r_rem <= r_rem - w_den;
+          r_q[r_dbit] <= 1'b1;
+        end
+        if (r_dbit == 0) begin
+          r_es <= E_STORE;
+        end else begin
+          r_dbit <= r_dbit - 1'b1;
+        end
+      end
+      E_STORE:
+      begin
+        r_n <= 0;
+        if (r_ech == 6'd63) begin
+          r_vis <= ~r_vis;
+          r_gen <= r_gen + 1'b1;
+          o_spec_ready <= 1'b1;
+          r_es <= E_IDLE;
+        end else begin
+          r_ech <= r_ech + 1'b1;
+          r_es <= E_LOAD;
+        end
+      end
+      default:
+        r_es <= E_IDLE;
+      endcase
+
+      if (i_smp_valid) begin
+        // Start and stop on frame boundaries only
+        if (i_smp_sof) begin
+          r_run <= i_ctrl;
+          if (i_ctrl & ~r_run) begin
+            r_hop <= (i_hop == 0) ? 16'd1 : i_hop;
+            r_bands <= i_bands;
+            r_fill <= 0;
+            r_hop_cnt <= 0;
+          end
+        end
+
+        if (i_smp_eof) begin
+          r_ptr <= r_ptr + 1'b1;
+          if (r_run) begin
+            if (~w_full) begin
+              r_fill <= r_fill + 1'b1;
+            end else begin
+              r_hop_cnt <= (r_hop_cnt == r_hop - 1'b1) ? 16'd0 : r_hop_cnt + 1'b1;
+            end
+          end
+          if (w_due) begin
+            if (r_es == E_IDLE) begin
+              r_win_ptr <= r_ptr + 1'b1 - N;
+              r_ech <= 0;
+              r_n <= 0;
+              r_es <= E_LOAD;
+            end else begin
+              r_skip <= r_skip + 1'b1;
+            end
+          end
+        end
+      end
+    end
+  end
+
+  // Purpose: Read port, the word is selected on the registered record
+  always @(posedge i_clk) begin
+    if (i_rd_en) begin
+      r_feat_q <= r_feat[{r_vis, i_rd_addr[8:3]}];
+      r_rd_sel <= {i_rd_addr[9], i_rd_addr[0]};
+      r_rd_word <= i_rd_addr[2:0];
+    end
+  end
+
+  always @(*) begin // Combinational
+    case (r_rd_sel)
+    2'b10: o_rd_data = r_gen;
+    2'b11: o_rd_data = r_skip;
+    default: o_rd_data = (r_rd_word == 3'd7) ? 32'b0 : r_feat_q[32*(6 - r_rd_word) +: 32];
+    endcase
+  end
+
+endmodule // rhd_spectrum
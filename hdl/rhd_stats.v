@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Per-channel running statistics
+//              Accumulates, for every channel of the sample stream and over
+//              intervals of i_interval frames:
+//                min and max of the samples
+//                sum(x) and sum(x^2), from which the PS gets the mean and the
+//                variance with a couple of operations per channel
+//                the number of samples stuck at either rail (0x0000 or
+//                0xFFFF), which flags saturated amplifiers and bad contacts
+//              and publishes them at the end of each interval, so electrode
+//              quality can be monitored live on all channels without pulling
+//              the raw stream into the PS.
+//
+//              A single datapath is time-multiplexed over both lanes of every
+//              pair, which takes 3 clock cycles, with the accumulators kept in
+//              BRAM.
+//
+//              i_interval is latched when the statistics are enabled, at the
+//              start of a frame.
+//
+//              Memory map of the read port (32-bit words), the statistics
+//              being double buffered so they are never read half updated:
+//              8n + 0    {max[15:0], min[15:0]} of channel n, n = 0 to 63
+//              8n + 1    sum(x) of channel n, signed
+//              8n + 2    sum(x^2)[31:0] of channel n
+//              8n + 3    sum(x^2)[47:32] of channel n
+//              8n + 4    {hits at 0xFFFF[15:0], hits at 0x0000[15:0]}
+//              8n + 5-7  0
+//              512       generation, incremented at the end of each interval
+//
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address =
+//              byte address [11:2]). o_stats_ready pulses when new statistics
+//              are published and can be used as an interrupt.
+//
+//              Samples are offset binary (0x8000 = 0). min and max are given
+//              as offset binary, the sums with 0x8000 removed.
+//
+//              Control bits (i_ctrl): [0] enable
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_stats (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input        i_ctrl,
+  input [15:0] i_interval, // Frames per interval, 0 = 1
+  output reg   o_stats_ready,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+
+  // Read port
+  input             i_rd_en,
+  input [9:0]       i_rd_addr,
+  output reg [31:0] o_rd_data
+);
+
+  localparam ACC_W = 16 + 16 + 32 + 48 + 16 + 16;
+
+  localparam IDLE   = 2'b00;
+  localparam LANE_A = 2'b01;
+  localparam LANE_B = 2'b10;
+
+  // {min, max, sum(x), sum(x^2), hits at 0xFFFF, hits at 0x0000}
+  reg [ACC_W-1:0] r_acc [0:63];
+  reg [ACC_W-1:0] r_acc_q;
+
+  // Published statistics, per bank and channel
+  reg [ACC_W-1:0] r_stat [0:127];
+  reg [ACC_W-1:0] r_stat_q;
+  reg r_vis;   // Bank visible on the read port
+  reg [31:0] r_gen;
+  reg r_rd_gen;
+  reg [2:0] r_rd_word;
+
+  reg [1:0] r_sm;
+  reg [31:0] r_data;
+  reg [4:0] r_ch;
+  reg r_eof;
+
+  reg r_run;
+  reg [15:0] r_interval;
+  reg [15:0] r_cnt;   // Frames of the interval before this one
+
+  wire w_lane;
+  wire [5:0] w_rd_addr;
+  wire w_first;  // First frame of the interval, the accumulators restart
+  wire w_pub;    // Last frame of the interval
+
+  wire [15:0] w_x;
+  wire signed [15:0] w_xs;
+  wire [31:0] w_sq;
+  wire [15:0] w_min;
+  wire [15:0] w_max;
+  wire [31:0] w_sum;
+  wire [47:0] w_sumsq;
+  wire [15:0] w_hi;
+  wire [15:0] w_lo;
+  wire [ACC_W-1:0] w_acc_next;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 64; i = i + 1) begin
+      r_acc[i] = 0;
+    end
+  end
+
+  assign w_lane = (r_sm == LANE_B);
+  assign w_rd_addr = (r_sm == IDLE) ? {1'b0, i_smp_ch} : {1'b1, r_ch};
+
+  assign w_first = (r_cnt == 0);
+  assign w_pub = r_run & (r_cnt == r_interval - 1'b1);
+
+  // Datapath, shared by both lanes
+  assign w_x = w_lane ? r_data[31:16] : r_data[15:0];
+  assign w_xs = {~w_x[15], w_x[14:0]};
+  assign w_sq = w_xs * w_xs;
+  assign {w_min, w_max, w_sum, w_sumsq, w_hi, w_lo} = r_acc_q;
+
+  assign w_acc_next = w_first ?
+                      {w_x, w_x, {{16{w_xs[15]}}, w_xs}, {16'b0, w_sq},
+                       15'b0, &w_x, 15'b0, ~|w_x} :
+                      {(w_x < w_min) ? w_x : w_min,
+                       (w_x > w_max) ? w_x : w_max,
+                       w_sum + {{16{w_xs[15]}}, w_xs},
+                       w_sumsq + w_sq,
+                       w_hi + &w_x,
+                       w_lo + ~|w_x};
+
+  // Purpose: Accumulators, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if ((r_sm != IDLE) & r_run) begin
+      r_acc[{w_lane, r_ch}] <= w_acc_next;
+      if (w_pub) begin
+        r_stat[{~r_vis, w_lane, r_ch}] <= w_acc_next;
+      end
+    end
+    r_acc_q <= r_acc[w_rd_addr];
+  end
+
+  // Purpose: Sequence both lanes of a pair, interval bookkeeping
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_data <= 0;
+      r_ch <= 0;
+      r_eof <= 1'b0;
+      r_run <= 1'b0;
+      r_interval <= 1;
+      r_cnt <= 0;
+      r_vis <= 1'b0;
+      r_gen <= 0;
+      o_stats_ready <= 1'b0;
+    end else begin
+      o_stats_ready <= 1'b0;
+
+      case (r_sm)
+      IDLE:
+      begin
+        if (i_smp_valid) begin
+          r_data <= i_smp_data;
+          r_ch <= i_smp_ch;
+          r_eof <= i_smp_eof;
+          r_sm <= LANE_A;
+
+          // Start and stop on frame boundaries only
+          if (i_smp_sof) begin
+            r_run <= i_ctrl;
+            if (i_ctrl & ~r_run) begin
+              r_interval <= (i_interval == 0) ? 16'd1 : i_interval;
+              r_cnt <= 0;
+            end
+          end
+        end
+      end
+      LANE_A:
+      begin
+        r_sm <= LANE_B;
+      end
+      LANE_B:
+      begin
+        r_sm <= IDLE;
+        if (r_eof & r_run) begin
+          if (w_pub) begin
+            r_cnt <= 0;
+            r_vis <= ~r_vis;
+            r_gen <= r_gen + 1'b1;
+            o_stats_ready <= 1'b1;
+          end else begin
+            r_cnt <= r_cnt + 1'b1;
+          end
+        end
+      end
+      default:
+        r_sm <= IDLE;
+      endcase
+    end
+  end
+
+  // Purpose: Read port, the word is selected on the registered record
+  always @(posedge i_clk) begin
+    if (i_rd_en) begin
+      r_stat_q <= r_stat[{r_vis, i_rd_addr[8:3]}];
+      r_rd_gen <= i_rd_addr[9];
+      r_rd_word <= i_rd_addr[2:0];
+    end
+  end
+
+  always @(*) begin // Combinational
+    if (r_rd_gen) begin
+      o_rd_data = r_gen;
+    end else begin
+      case (r_rd_word)
+      3'd0: o_rd_data = {r_stat_q[ACC_W-17 -: 16], r_stat_q[ACC_W-1 -: 16]};
+      3'd1: o_rd_data = r_stat_q[111:80];
+      3'd2: o_rd_data = r_stat_q[63:32];
+      3'd3: o_rd_data = {16'b0, r_stat_q[79:64]};
+      3'd4: o_rd_data = r_stat_q[31:0];
+      default: o_rd_data = 32'b0;
+      endcase
+    end
+  end
+
+endmodule // rhd_stats
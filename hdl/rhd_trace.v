@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Transfer trace recorder
+//              Logs a timestamped entry in BRAM whenever one of the events
+//              of i_event is asserted, so the dead time between SPI transfers
+//              can be profiled on the deployed system without a scope.
+//
+//              Each entry is {i_event, timestamp}. Keeping the whole event
+//              mask instead of an event code lets simultaneous events share
+//              one entry. The timestamp counts i_clk cycles since the trigger
+//              and wraps after 2^(32-N_EVENTS) cycles.
+//
+//              Control bits are edge sensitive so they can be driven
+//              directly by an AXI GPIO:
+//              [0] arm     - clear the buffer and wait for a trigger
+//              [1] trigger - start recording
+//              [2] stop    - stop recording
+//              [3] level, trigger on i_event[0] instead of [1]
+//
+//              Recording stops by itself once the buffer is full.
+//
+//              Status: [31:30] = state (0: idle, 1: armed, 2: running,
+//              3: stopped), [ADDR_WIDTH:0] = number of entries recorded.
+//
+//              Entries are read back through i_addr/o_data, with one clock
+//              cycle of latency.
+//
+// Parameters:  ADDR_WIDTH - Buffer holds 2^ADDR_WIDTH entries
+//              N_EVENTS - Number of event inputs
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_trace #(
+  parameter ADDR_WIDTH = 10,
+  parameter N_EVENTS   = 6
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input  [3:0]  i_ctrl,
+  output [31:0] o_status,
+
+  // Events to record
+  input [N_EVENTS-1:0] i_event,
+
+  // Readback
+  input [ADDR_WIDTH-1:0] i_addr,
+  output reg [31:0]      o_data
+);
+
+  localparam TS_WIDTH = 32 - N_EVENTS;
+  localparam DEPTH    = 1 << ADDR_WIDTH;
+
+  localparam IDLE    = 2'b00;
+  localparam ARMED   = 2'b01;
+  localparam RUNNING = 2'b10;
+  localparam STOPPED = 2'b11;
+
+  reg [31:0] r_mem [0:DEPTH-1];
+
+  reg [1:0] r_sm;
+  reg [3:0] r_ctrl;
+  reg [TS_WIDTH-1:0] r_ts;
+  reg [ADDR_WIDTH:0] r_cnt;
+
+  wire [3:0] w_ctrl_rise;
+  wire w_trig;
+  wire w_wr;
+  wire [TS_WIDTH-1:0] w_ts;
+
+  assign w_ctrl_rise = i_ctrl & ~r_ctrl;
+  assign w_trig = i_ctrl[3] ? i_event[0] : w_ctrl_rise[1];
+
+  // The triggering cycle is recorded as timestamp 0
+  assign w_wr = ((r_sm == RUNNING) | ((r_sm == ARMED) & w_trig)) & (|i_event);
+  assign w_ts = (r_sm == ARMED) ? {TS_WIDTH{1'b0}} : r_ts;
+
+  // Purpose: Arm/trigger/stop state machine
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_sm <= IDLE;
+      r_ctrl <= 4'b0;
+      r_ts <= 0;
+      r_cnt <= 0;
+    end else begin
+      r_ctrl <= i_ctrl;
+      r_ts <= r_ts + 1'b1;
+
+      if (w_ctrl_rise[0]) begin
+        r_cnt <= 0;
+        r_sm <= ARMED;
+      end else begin
+        case (r_sm)
+        ARMED:
+        begin
+          if (w_ctrl_rise[2]) begin
+            r_sm <= STOPPED;
+          end else if (w_trig) begin
+            r_ts <= 1;
+            r_cnt <= w_wr ? 1 : 0;
+            r_sm <= RUNNING;
+          end
+        end
+        RUNNING:
+        begin
+          if (w_wr) begin
+            r_cnt <= r_cnt + 1'b1;
+          end
+          if (w_ctrl_rise[2] | (w_wr & (r_cnt == DEPTH-1))) begin
+            r_sm <= STOPPED;
+          end
+        end
+        default:
+          r_sm <= r_sm; // IDLE or STOPPED, wait for arm
+        endcase
+      end
+    end
+  end
+
+  // Purpose: Trace memory, no reset so it maps to BRAM
+  always @(posedge i_clk) begin
+    if (w_wr) begin
+      r_mem[r_cnt[ADDR_WIDTH-1:0]] <= {i_event, w_ts};
+    end
+    o_data <= r_mem[i_addr];
+  end
+
+  assign o_status = {r_sm, {(29-ADDR_WIDTH){1'b0}}, r_cnt};
+
+endmodule // rhd_trace
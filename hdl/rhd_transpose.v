@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Channel-major transpose buffer
+//              Gathers blocks of N = 2^FRAME_BITS frames of the sample stream
+//              and sends each of them channel-major, so that the N samples of
+//              each channel are contiguous once written to memory:
+//                word c * N/2 + i = {x[c][2i+1], x[c][2i]}
+//              for channel c = 0 to 63 and i = 0 to N/2-1, x[c][f] being the
+//              sample of channel c in frame f of the block.
+//              Per-channel processing on the PS then reads its input with
+//              unit stride instead of skipping over the other 63 channels.
+//              The frame flags (see rhd_sequencer.v) follow as a 65th
+//              channel, word 32 * N + i = {flags[2i+1], flags[2i]}.
+//
+//              The blocks are double buffered in BRAM: one bank is filled by
+//              the stream while the other one is sent, at one word per clock
+//              cycle with o_blk_last on the last word of the block. Sending a
+//              block takes 32 * N + N/2 clock cycles, much less than filling
+//              one.
+//              The receiver must accept a word every clock cycle, e.g. an
+//              AXI-Stream FIFO in front of a DMA.
+//
+//              Samples are offset binary (0x8000 = 0), unchanged.
+//
+//              Control bits (i_ctrl): [0] enable, applied at the start of a
+//              frame. The first block starts with the first frame, and a
+//              block interrupted by clearing it is dropped.
+//
+// Parameters:  FRAME_BITS - log2 of the number of frames per block, >= 1
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_transpose #(
+  parameter FRAME_BITS = 6
+) (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input i_ctrl,
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_sof,
+  input        i_smp_eof,
+  input [15:0] i_smp_flags,
+
+  // Block stream
+  output reg        o_blk_valid,
+  output reg [31:0] o_blk_data,
+  output reg        o_blk_last
+);
+
+  localparam N = 1 << FRAME_BITS;
+  localparam DEPTH = 2 * 32 * N / 2; // {bank, ch[4:0], frame[FRAME_BITS-1:1]}
+
+  // Lane A (channels 0 to 31) and B (32 to 63), even and odd frames
+  reg [15:0] r_mem_ae [0:DEPTH-1];
+  reg [15:0] r_mem_ao [0:DEPTH-1];
+  reg [15:0] r_mem_be [0:DEPTH-1];
+  reg [15:0] r_mem_bo [0:DEPTH-1];
+  reg [15:0] r_ae_q;
+  reg [15:0] r_ao_q;
+  reg [15:0] r_be_q;
+  reg [15:0] r_bo_q;
+  reg [15:0] r_flags [0:2*N-1]; // {bank, frame}
+  reg [31:0] r_flags_q;
+
+  reg r_run;
+  reg r_wbank;                  // Bank being filled
+  reg [FRAME_BITS-1:0] r_frame; // Frame of the block being filled
+
+  reg r_send;
+  reg r_rbank;                  // Bank being sent
+  reg [FRAME_BITS+4:0] r_rptr;  // {ch[5:0], word}
+  reg r_send_flags;             // Sending the flags after the channels
+  reg [FRAME_BITS-1:0] r_fptr;  // Flags word
+  reg r_rd_v;
+  reg r_rd_lane;
+  reg r_rd_flags;
+  reg r_rd_last;
+
+  wire w_run;
+  wire w_wr;
+  wire [FRAME_BITS+4:0] w_wr_addr;
+  wire [FRAME_BITS+4:0] w_rd_addr;
+
+  // Enabled at the start of a frame
+  assign w_run = i_smp_sof ? i_ctrl : r_run;
+  assign w_wr = i_smp_valid & w_run;
+
+  generate
+    if (FRAME_BITS > 1) begin : addr
+      assign w_wr_addr = {r_wbank, i_smp_ch, r_frame[FRAME_BITS-1:1]};
+      assign w_rd_addr = {r_rbank, r_rptr[FRAME_BITS+3:0]};
+    end else begin : addr
+      assign w_wr_addr = {r_wbank, i_smp_ch};
+      assign w_rd_addr = {r_rbank, r_rptr[4:0]};
+    end
+  endgenerate
+
+  // Purpose: Block banks, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (w_wr & ~r_frame[0]) begin
+      r_mem_ae[w_wr_addr] <= i_smp_data[15:0];
+      r_mem_be[w_wr_addr] <= i_smp_data[31:16];
+    end
+    if (w_wr & r_frame[0]) begin
+      r_mem_ao[w_wr_addr] <= i_smp_data[15:0];
+      r_mem_bo[w_wr_addr] <= i_smp_data[31:16];
+    end
+    r_ae_q <= r_mem_ae[w_rd_addr];
+    r_ao_q <= r_mem_ao[w_rd_addr];
+    r_be_q <= r_mem_be[w_rd_addr];
+    r_bo_q <= r_mem_bo[w_rd_addr];
+  end
+
+  // Purpose: Frame flags of both banks, no reset so they map to
+  // distributed RAM
+  always @(posedge i_clk) begin
+    if (w_wr & i_smp_sof) begin
+      r_flags[{r_wbank, r_frame}] <= i_smp_flags;
+    end
+    r_flags_q <= {r_flags[r_rbank * N + 2 * r_fptr + 1], r_flags[r_rbank * N + 2 * r_fptr]};
+  end
+
+  // Purpose: Fill one bank while the other one is sent
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_run <= 1'b0;
+      r_wbank <= 1'b0;
+      r_frame <= 0;
+      r_send <= 1'b0;
+      r_rbank <= 1'b0;
+      r_rptr <= 0;
+      r_send_flags <= 1'b0;
+      r_fptr <= 0;
+      r_rd_v <= 1'b0;
+      r_rd_lane <= 1'b0;
+      r_rd_flags <= 1'b0;
+      r_rd_last <= 1'b0;
+      o_blk_valid <= 1'b0;
+      o_blk_data <= 0;
+      o_blk_last <= 1'b0;
+    end else begin
+      if (i_smp_valid) begin
+        if (i_smp_sof) begin
+          r_run <= i_ctrl;
+          if (~i_ctrl) begin
+            // Drop the partial block, the next one starts when enabled again
+            r_frame <= 0;
+          end
+        end
+
+        if (i_smp_eof & w_run) begin
+          r_frame <= r_frame + 1'b1;
+          if (&r_frame) begin
+            r_wbank <= ~r_wbank;
+            r_rbank <= r_wbank;
+            r_rptr <= 0;
+            r_send <= 1'b1;
+          end
+        end
+      end
+
+      // Read one word per clock cycle, sent on the next one
+      r_rd_v <= r_send | r_send_flags;
+      r_rd_lane <= r_rptr[FRAME_BITS+4];
+      r_rd_flags <= r_send_flags;
+      r_rd_last <= r_send_flags & (r_fptr == N/2-1);
+      if (r_send) begin
+        r_rptr <= r_rptr + 1'b1;
+        if (&r_rptr) begin
+          r_send <= 1'b0;
+          r_send_flags <= 1'b1;
+          r_fptr <= 0;
+        end
+      end else if (r_send_flags) begin
+        r_fptr <= r_fptr + 1'b1;
+        if (r_fptr == N/2-1) begin
+          r_send_flags <= 1'b0;
+        end
+      end
+
+      o_blk_valid <= r_rd_v;
+      o_blk_data <= r_rd_flags ? r_flags_q :
+                    r_rd_lane ? {r_bo_q, r_be_q} : {r_ao_q, r_ae_q};
+      o_blk_last <= r_rd_v & r_rd_last;
+    end
+  end
+
+endmodule // rhd_transpose
@@ -1,10 +1,27 @@
-module rhd_wrapper (
+module rhd_wrapper #(
+    parameter TRACE_ADDR_WIDTH = 10,
+    parameter N_AUX = 3,
+    parameter CAPTURE_FRAME_BITS = 8,
+    parameter NOTCH_SECTIONS = 2,
+    parameter FEATURES_WIN_BITS = 9,
+    parameter DETECT_EVT_BITS = 10,
+    parameter SPATIAL_M = 64,
+    parameter SPATIAL_PAR = 4,
+    parameter SPECTRUM_FFT_BITS = 8,
+    parameter TRANSPOSE_FRAME_BITS = 6,
+    parameter BANK_FRAME_BITS = 4
+) (
     // Control/Data Signals,
+    (* X_INTERFACE_INFO = "xilinx.com:signal:reset:1.0 i_rst RST" *)
+    (* X_INTERFACE_PARAMETER = "POLARITY ACTIVE_LOW" *)
     input i_rst,     // FPGA Reset
+    (* X_INTERFACE_INFO = "xilinx.com:signal:clock:1.0 i_clk CLK" *)
+    (* X_INTERFACE_PARAMETER = "ASSOCIATED_BUSIF CMP_AXIS:BLK_AXIS:PRV_AXIS:BEAT_AXIS, ASSOCIATED_RESET i_rst" *)
     input i_clk,     // FPGA Clock
 
     // Control registers
-    input [23:0] i_ctrl, // [0:15] = i_clk_div, [16:23] = i_clk_delay
+    input [24:0] i_ctrl, // [0:15] = i_clk_div, [16:23] = i_clk_delay, [24] = commit
+    output       o_ctrl_pending, // Committed i_ctrl waiting for the next frame boundary
 
     // Status
     input         i_start,   // Data Valid Pulse with i_din
@@ -21,19 +38,936 @@ module rhd_wrapper (
     output o_sclk,
     input  i_miso,
     output o_mosi,
-    output o_cs
+    output o_cs,
+
+    // Loopback pattern generator, see rhd_pattern.v
+    input  [2:0] i_pat_ctrl,
+
+    // Sequencer
+    input                  i_seq_en,       // Continuous acquisition, ignores i_start/i_din
+    input  [31:0]          i_frame_period, // Clock cycles between frames, 0 = back to back
+    input  [N_AUX*16-1:0]  i_aux_cmd,      // Commands sent after the 32 CONVERTs of a frame
+    input                  i_sync_slave,   // Start frames on i_sync_in instead of the frame timer
+    output                 o_frame_start,
+    output [31:0]          o_frame_cnt,
+    output [15:0]          o_overruns,
+    output [15:0]          o_frame_flags,  // [15:8] = i_dig_in at the frame start
+
+    // Multi-board sync
+    input  i_sync_in,
+    output o_sync_out,
+
+    // Digital inputs, sampled at each frame start
+    input [7:0] i_dig_in,
+
+    // Impedance measurement, see rhd_zcheck.v
+    input         i_zc_ctrl,
+    input  [7:0]  i_zc_cfg,
+    input  [15:0] i_zc_phase_inc,
+    input  [15:0] i_zc_settle,
+    input  [15:0] i_zc_frames,
+    output [31:0] o_zc_status,
+    input         i_zc_rd_en,
+    input  [7:0]  i_zc_rd_addr,
+    output [31:0] o_zc_rd_data,
+
+    // Register scrubbing, see rhd_scrub.v
+    input  [1:0]  i_scrub_ctrl,
+    input  [15:0] i_scrub_period,
+    input  [26:0] i_scrub_mask,
+    input         i_scrub_wr,
+    input  [4:0]  i_scrub_addr,
+    input  [7:0]  i_scrub_data,
+    output [31:0] o_scrub_status,
+    output [26:0] o_scrub_flags,
+    output        o_scrub_alert,
+
+    // Automatic fast settle, see rhd_settle.v
+    input         i_settle_ctrl,
+    input  [63:0] i_settle_mask,
+    input  [15:0] i_settle_margin,
+    input  [7:0]  i_settle_hits,
+    input  [15:0] i_settle_hold,
+    input  [7:0]  i_settle_reg0,
+    output [31:0] o_settle_status,
+
+    // Conditioning
+    input  [2:0]  i_decim_ctrl, // See rhd_decim.v
+    input  [1:0]  i_hpf_ctrl,   // See rhd_hpf.v
+    input  [15:0] i_hpf_coef,
+    input  [NOTCH_SECTIONS:0] i_notch_ctrl, // See rhd_notch.v
+    input         i_notch_coef_wr,
+    input  [4:0]  i_notch_coef_addr,
+    input  [15:0] i_notch_coef_data,
+    input  [1:0]  i_cal_ctrl,   // See rhd_cal.v
+    input         i_cal_coef_wr,
+    input  [6:0]  i_cal_coef_addr,
+    input  [15:0] i_cal_coef_data,
+    input         i_car_ctrl,   // See rhd_car.v
+    input  [63:0] i_car_mask,
+    output [15:0] o_car_mean,
+    input  [1:0]  i_spatial_ctrl, // See rhd_spatial.v
+    input         i_spatial_coef_wr,
+    input  [11:0] i_spatial_coef_addr,
+    input  [15:0] i_spatial_coef_data,
+
+    // Sample stream, see rhd_sequencer.v
+    output        o_smp_valid,
+    output [4:0]  o_smp_ch,
+    output [31:0] o_smp_data,
+    output        o_smp_sof,
+    output        o_smp_eof,
+    output [15:0] o_smp_flags,
+    output        o_aux_valid,
+    output [3:0]  o_aux_slot,
+    output [15:0] o_aux_data,
+
+    // Pre-trigger capture buffer, see rhd_capture.v. The read port is a BRAM
+    // interface for an AXI BRAM Controller, addressed in bytes
+    input  [3:0]  i_cap_ctrl,
+    input  [15:0] i_cap_post_frames,
+    input  [15:0] i_cap_threshold,
+    output [31:0] o_cap_status,
+    input         i_cap_trig,     // Pmod JE4 on the Zybo Z7-20
+    (* X_INTERFACE_INFO = "xilinx.com:interface:bram:1.0 CAPTURE_BRAM ADDR" *)
+    input  [31:0] i_cap_addr,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:bram:1.0 CAPTURE_BRAM DOUT" *)
+    output [31:0] o_cap_data,
+
+    // Latest-value snapshot bank, see rhd_snapshot.v
+    input         i_snap_rd_en,
+    input  [6:0]  i_snap_rd_addr,
+    output [31:0] o_snap_rd_data,
+
+    // EMG feature engine, see rhd_features.v
+    input         i_feat_ctrl,
+    input  [3:0]  i_feat_win,
+    input  [15:0] i_feat_hop,
+    input  [15:0] i_feat_thresh,
+    output        o_feat_ready,
+    input         i_feat_rd_en,
+    input  [8:0]  i_feat_rd_addr,
+    output [31:0] o_feat_rd_data,
+
+    // Threshold detector, see rhd_detect.v
+    input  [1:0]  i_det_ctrl,
+    input  [63:0] i_det_mask,
+    input  [7:0]  i_det_adapt_k,
+    input  [3:0]  i_det_tau,
+    input  [15:0] i_det_pulse_len,
+    input         i_det_thr_wr,
+    input  [5:0]  i_det_thr_addr,
+    input  [15:0] i_det_thr_data,
+    output        o_detect,       // Pmod JE3 on the Zybo Z7-20
+    output [31:0] o_det_evt_count,
+    input  [DETECT_EVT_BITS-1:0] i_det_evt_addr,
+    output [31:0] o_det_evt_data,
+
+    // Channel statistics, see rhd_stats.v
+    input         i_stats_ctrl,
+    input  [15:0] i_stats_interval,
+    output        o_stats_ready,
+    input         i_stats_rd_en,
+    input  [9:0]  i_stats_rd_addr,
+    output [31:0] o_stats_rd_data,
+
+    // Spectral features, see rhd_spectrum.v
+    input         i_spec_ctrl,
+    input  [15:0] i_spec_hop,
+    input  [31:0] i_spec_bands,
+    output        o_spec_ready,
+    input         i_spec_rd_en,
+    input  [9:0]  i_spec_rd_addr,
+    output [31:0] o_spec_rd_data,
+
+    // Rice compressed stream, see rhd_rice.v. o_cmp_* is an AXI4-Stream
+    // master without back-pressure
+    input         i_rice_ctrl,
+    input  [3:0]  i_rice_k,
+    input  [15:0] i_rice_key_period,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 CMP_AXIS TVALID" *)
+    output        o_cmp_valid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 CMP_AXIS TDATA" *)
+    output [31:0] o_cmp_data,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 CMP_AXIS TLAST" *)
+    output        o_cmp_last,
+
+    // Channel-major block stream, see rhd_transpose.v. o_blk_* is an
+    // AXI4-Stream master without back-pressure
+    input         i_blk_ctrl,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BLK_AXIS TVALID" *)
+    output        o_blk_valid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BLK_AXIS TDATA" *)
+    output [31:0] o_blk_data,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BLK_AXIS TLAST" *)
+    output        o_blk_last,
+
+    // Min/max preview stream, see rhd_preview.v. o_prv_* is an
+    // AXI4-Stream master without back-pressure, ending on o_prv_eof
+    input         i_prv_ctrl,
+    input  [15:0] i_prv_ratio,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 PRV_AXIS TVALID" *)
+    output        o_prv_valid,
+    output [5:0]  o_prv_ch,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 PRV_AXIS TDATA" *)
+    output [31:0] o_prv_data,
+    output        o_prv_sof,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 PRV_AXIS TLAST" *)
+    output        o_prv_eof,
+
+    // Dense packing, see rhd_pack.v. o_beat_* is an AXI4-Stream master
+    // without back-pressure
+    input  [2:0]  i_pack_ctrl,
+    input  [63:0] i_pack_mask,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BEAT_AXIS TVALID" *)
+    output        o_beat_valid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BEAT_AXIS TDATA" *)
+    output [63:0] o_beat_data,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:axis:1.0 BEAT_AXIS TLAST" *)
+    output        o_beat_last,
+
+    // Frame banks, see rhd_banks.v. The read port is a BRAM interface for
+    // an AXI BRAM Controller, addressed in bytes
+    input  [1:0]  i_banks_ctrl,
+    output [31:0] o_banks_status,
+    output        o_bank_ready,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:bram:1.0 BANKS_BRAM EN" *)
+    input         i_banks_en,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:bram:1.0 BANKS_BRAM ADDR" *)
+    input  [31:0] i_banks_addr,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:bram:1.0 BANKS_BRAM DOUT" *)
+    output [31:0] o_banks_data,
+
+    // Trace recorder
+    input  [3:0]                  i_trace_ctrl,
+    output [31:0]                 o_trace_status,
+    input  [TRACE_ADDR_WIDTH-1:0] i_trace_addr,
+    output [31:0]                 o_trace_data
 );
 
     wire [15:0] w_clk_div;
     wire [7:0] w_clks_wait_after_done;
+    wire [23:0] w_cfg;
+    wire w_cfg_idle;
     wire [15:0] w_dout_a;
     wire [15:0] w_dout_b;
+    wire [15:0] w_spi_dout_a;
+    wire [15:0] w_spi_dout_b;
+    wire [5:0] w_trace_event;
+
+    wire w_start;
+    wire [15:0] w_din;
+    wire w_seq_sel;
+    wire w_seq_busy;
+    wire w_seq_start;
+    wire [15:0] w_seq_din;
+    wire [N_AUX*16-1:0] w_aux_cmd;
+    wire [N_AUX*16-1:0] w_aux_settle;
+    wire [N_AUX*16-1:0] w_aux_scrub;
+    wire w_settle_aux_en;
+    wire [15:0] w_settle_aux_cmd;
+    wire w_scrub_aux_en;
+    wire [15:0] w_scrub_aux_cmd;
+    wire w_zc_aux_en;
+    wire [31:0] w_zc_aux_cmd;
+
+    // Raw sample stream from the sequencer
+    wire        w_seq_smp_valid;
+    wire [4:0]  w_seq_smp_ch;
+    wire [31:0] w_seq_smp_data;
+    wire        w_seq_smp_sof;
+    wire        w_seq_smp_eof;
+    wire [15:0] w_seq_smp_flags;
 
-    assign w_clks_wait_after_done = i_ctrl[23:16];
-    assign w_clk_div = i_ctrl[15:0];
+    // Decimated sample stream
+    wire        w_dec_smp_valid;
+    wire [4:0]  w_dec_smp_ch;
+    wire [31:0] w_dec_smp_data;
+    wire        w_dec_smp_sof;
+    wire        w_dec_smp_eof;
+    wire [15:0] w_dec_smp_flags;
+
+    // High-passed sample stream
+    wire        w_hpf_smp_valid;
+    wire [4:0]  w_hpf_smp_ch;
+    wire [31:0] w_hpf_smp_data;
+    wire        w_hpf_smp_sof;
+    wire        w_hpf_smp_eof;
+    wire [15:0] w_hpf_smp_flags;
+
+    // Notch filtered sample stream
+    wire        w_notch_smp_valid;
+    wire [4:0]  w_notch_smp_ch;
+    wire [31:0] w_notch_smp_data;
+    wire        w_notch_smp_sof;
+    wire        w_notch_smp_eof;
+    wire [15:0] w_notch_smp_flags;
+
+    // Calibrated sample stream
+    wire        w_cal_smp_valid;
+    wire [4:0]  w_cal_smp_ch;
+    wire [31:0] w_cal_smp_data;
+    wire        w_cal_smp_sof;
+    wire        w_cal_smp_eof;
+    wire [15:0] w_cal_smp_flags;
+
+    // Common-average referenced sample stream
+    wire        w_car_smp_valid;
+    wire [4:0]  w_car_smp_ch;
+    wire [31:0] w_car_smp_data;
+    wire        w_car_smp_sof;
+    wire        w_car_smp_eof;
+    wire [15:0] w_car_smp_flags;
+
+    reg [23:0] r_cfg;        // Applied i_ctrl
+    reg [23:0] r_cfg_shadow; // Committed i_ctrl
+    reg r_cfg_pending;
+    reg r_commit;
+
+    reg r_start;
+    reg r_done;
+    reg r_cs;
+    reg r_sclk;
+    reg [4:0] r_sclk_falls;
+
+    // The SPI timing only changes between transfers: while the PS drives the
+    // SPI master, i_ctrl goes through as long as no transfer has started
+    // (r_done: idle on the previous cycle). While the sequencer runs, i_ctrl
+    // is only taken on a rising edge of the commit bit, and applied at the
+    // next frame boundary, so a live stream can be retuned without glitches.
+    assign w_cfg_idle = r_done & ~w_seq_busy;
+    assign w_cfg = (~w_seq_sel & r_done) ? i_ctrl[23:0] : r_cfg;
+    assign w_clks_wait_after_done = w_cfg[23:16];
+    assign w_clk_div = w_cfg[15:0];
+    assign o_ctrl_pending = r_cfg_pending;
+
+    // Purpose: Shadow registers of i_ctrl
+    always @(posedge i_clk or negedge i_rst) begin
+        if (~i_rst) begin
+            r_cfg <= 0;
+            r_cfg_shadow <= 0;
+            r_cfg_pending <= 1'b0;
+            r_commit <= 1'b0;
+        end else begin
+            r_commit <= i_ctrl[24];
+
+            if (w_cfg_idle) begin
+                if (~i_seq_en) begin
+                    r_cfg <= i_ctrl[23:0];
+                    r_cfg_pending <= 1'b0;
+                end else if (r_cfg_pending) begin
+                    r_cfg <= r_cfg_shadow;
+                    r_cfg_pending <= 1'b0;
+                end
+            end
+
+            if (i_ctrl[24] & ~r_commit) begin
+                r_cfg_shadow <= i_ctrl[23:0];
+                r_cfg_pending <= 1'b1;
+            end
+        end
+    end
 
     assign o_dout = {w_dout_b, w_dout_a};
 
+    // The sequencer owns the SPI master while enabled or finishing a frame
+    assign w_seq_sel = i_seq_en | w_seq_busy;
+    assign w_start = w_seq_sel ? w_seq_start : i_start;
+    assign w_din = w_seq_sel ? w_seq_din : i_din;
+
+    // The fast settle takes over the first aux slot, the scrubbing the last
+    // one, and the impedance measurement the first two
+    assign w_aux_settle = w_settle_aux_en ? {i_aux_cmd[N_AUX*16-1:16], w_settle_aux_cmd} : i_aux_cmd;
+    assign w_aux_scrub = w_scrub_aux_en ? {w_scrub_aux_cmd, w_aux_settle[N_AUX*16-17:0]} : w_aux_settle;
+    assign w_aux_cmd = w_zc_aux_en ? ((w_aux_scrub >> 32) << 32) | w_zc_aux_cmd : w_aux_scrub;
+
+    rhd_sequencer #(
+        .N_AUX(N_AUX)
+    ) rhd_sequencer_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_en(i_seq_en),
+        .i_frame_period(i_frame_period),
+        .i_aux_cmd(w_aux_cmd),
+        .i_sync_slave(i_sync_slave),
+
+        // Multi-board sync
+        .i_sync_in(i_sync_in),
+        .o_sync_out(o_sync_out),
+
+        // Digital inputs
+        .i_dig_in(i_dig_in),
+
+        // Status
+        .o_busy(w_seq_busy),
+        .o_frame_start(o_frame_start),
+        .o_frame_cnt(o_frame_cnt),
+        .o_overruns(o_overruns),
+        .o_frame_flags(o_frame_flags),
+
+        // SPI master handshake
+        .o_start(w_seq_start),
+        .o_din(w_seq_din),
+        .i_done(o_done),
+        .i_dout(o_dout),
+
+        // Sample stream
+        .o_smp_valid(w_seq_smp_valid),
+        .o_smp_ch(w_seq_smp_ch),
+        .o_smp_data(w_seq_smp_data),
+        .o_smp_sof(w_seq_smp_sof),
+        .o_smp_eof(w_seq_smp_eof),
+        .o_smp_flags(w_seq_smp_flags),
+
+        // Aux results
+        .o_aux_valid(o_aux_valid),
+        .o_aux_slot(o_aux_slot),
+        .o_aux_data(o_aux_data)
+    );
+
+    // Event-locked capture of the output frames
+    rhd_capture #(
+        .FRAME_BITS(CAPTURE_FRAME_BITS)
+    ) rhd_capture_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_cap_ctrl),
+        .i_post_frames(i_cap_post_frames),
+        .i_threshold(i_cap_threshold),
+        .o_status(o_cap_status),
+
+        // External trigger
+        .i_trig(i_cap_trig),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Readback
+        .i_addr(i_cap_addr[CAPTURE_FRAME_BITS+7:2]),
+        .o_data(o_cap_data)
+    );
+
+    // Newest output frame for control loops
+    rhd_snapshot rhd_snapshot_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Read port
+        .i_rd_en(i_snap_rd_en),
+        .i_rd_addr(i_snap_rd_addr),
+        .o_rd_data(o_snap_rd_data)
+    );
+
+    // Impedance measurement, on the raw samples
+    rhd_zcheck rhd_zcheck_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        .i_ctrl(i_zc_ctrl),
+        .i_cfg(i_zc_cfg),
+        .i_phase_inc(i_zc_phase_inc),
+        .i_settle(i_zc_settle),
+        .i_frames(i_zc_frames),
+        .o_status(o_zc_status),
+
+        .i_frame_start(o_frame_start),
+        .o_aux_en(w_zc_aux_en),
+        .o_aux_cmd(w_zc_aux_cmd),
+
+        .i_smp_valid(w_seq_smp_valid),
+        .i_smp_ch(w_seq_smp_ch),
+        .i_smp_data(w_seq_smp_data),
+        .i_smp_eof(w_seq_smp_eof),
+
+        .i_rd_en(i_zc_rd_en),
+        .i_rd_addr(i_zc_rd_addr),
+        .o_rd_data(o_zc_rd_data)
+    );
+
+    // Background read back of the chip registers
+    rhd_scrub #(
+        .SLOT(N_AUX-1)
+    ) rhd_scrub_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        .i_ctrl(i_scrub_ctrl),
+        .i_period(i_scrub_period),
+        .i_mask(i_scrub_mask),
+        .i_shadow_wr(i_scrub_wr),
+        .i_shadow_addr(i_scrub_addr),
+        .i_shadow_data(i_scrub_data),
+        .o_status(o_scrub_status),
+        .o_flags(o_scrub_flags),
+        .o_alert(o_scrub_alert),
+
+        .i_frame_start(o_frame_start),
+        .i_aux_grant(~w_zc_aux_en | (N_AUX > 2)),
+        .o_aux_en(w_scrub_aux_en),
+        .o_aux_cmd(w_scrub_aux_cmd),
+
+        .i_aux_valid(o_aux_valid),
+        .i_aux_slot(o_aux_slot),
+        .i_aux_data(o_aux_data)
+    );
+
+    // Fast settle on saturated channels
+    rhd_settle rhd_settle_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        .i_ctrl(i_settle_ctrl),
+        .i_mask(i_settle_mask),
+        .i_margin(i_settle_margin),
+        .i_hits(i_settle_hits),
+        .i_hold(i_settle_hold),
+        .i_reg0(i_settle_reg0),
+        .o_status(o_settle_status),
+
+        .i_frame_start(o_frame_start),
+        .i_aux_grant(~w_zc_aux_en),
+        .o_aux_en(w_settle_aux_en),
+        .o_aux_cmd(w_settle_aux_cmd),
+
+        .i_smp_valid(w_seq_smp_valid),
+        .i_smp_ch(w_seq_smp_ch),
+        .i_smp_data(w_seq_smp_data),
+        .i_smp_sof(w_seq_smp_sof),
+        .i_smp_eof(w_seq_smp_eof)
+    );
+
+    // Decimation, the stages below run at the decimated rate
+    rhd_decim rhd_decim_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_decim_ctrl),
+
+        // Sample stream in
+        .i_smp_valid(w_seq_smp_valid),
+        .i_smp_ch(w_seq_smp_ch),
+        .i_smp_data(w_seq_smp_data),
+        .i_smp_sof(w_seq_smp_sof),
+        .i_smp_eof(w_seq_smp_eof),
+        .i_smp_flags(w_seq_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(w_dec_smp_valid),
+        .o_smp_ch(w_dec_smp_ch),
+        .o_smp_data(w_dec_smp_data),
+        .o_smp_sof(w_dec_smp_sof),
+        .o_smp_eof(w_dec_smp_eof),
+        .o_smp_flags(w_dec_smp_flags)
+    );
+
+    // DC removal
+    rhd_hpf rhd_hpf_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_hpf_ctrl),
+        .i_coef(i_hpf_coef),
+
+        // Sample stream in
+        .i_smp_valid(w_dec_smp_valid),
+        .i_smp_ch(w_dec_smp_ch),
+        .i_smp_data(w_dec_smp_data),
+        .i_smp_sof(w_dec_smp_sof),
+        .i_smp_eof(w_dec_smp_eof),
+        .i_smp_flags(w_dec_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(w_hpf_smp_valid),
+        .o_smp_ch(w_hpf_smp_ch),
+        .o_smp_data(w_hpf_smp_data),
+        .o_smp_sof(w_hpf_smp_sof),
+        .o_smp_eof(w_hpf_smp_eof),
+        .o_smp_flags(w_hpf_smp_flags)
+    );
+
+    // Powerline notch
+    rhd_notch #(
+        .N_SECTIONS(NOTCH_SECTIONS)
+    ) rhd_notch_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_notch_ctrl),
+
+        // Coefficient table
+        .i_coef_wr(i_notch_coef_wr),
+        .i_coef_addr(i_notch_coef_addr),
+        .i_coef_data(i_notch_coef_data),
+
+        // Sample stream in
+        .i_smp_valid(w_hpf_smp_valid),
+        .i_smp_ch(w_hpf_smp_ch),
+        .i_smp_data(w_hpf_smp_data),
+        .i_smp_sof(w_hpf_smp_sof),
+        .i_smp_eof(w_hpf_smp_eof),
+        .i_smp_flags(w_hpf_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(w_notch_smp_valid),
+        .o_smp_ch(w_notch_smp_ch),
+        .o_smp_data(w_notch_smp_data),
+        .o_smp_sof(w_notch_smp_sof),
+        .o_smp_eof(w_notch_smp_eof),
+        .o_smp_flags(w_notch_smp_flags)
+    );
+
+    // Gain and offset calibration
+    rhd_cal rhd_cal_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_cal_ctrl),
+
+        // Coefficient table
+        .i_coef_wr(i_cal_coef_wr),
+        .i_coef_addr(i_cal_coef_addr),
+        .i_coef_data(i_cal_coef_data),
+
+        // Sample stream in
+        .i_smp_valid(w_notch_smp_valid),
+        .i_smp_ch(w_notch_smp_ch),
+        .i_smp_data(w_notch_smp_data),
+        .i_smp_sof(w_notch_smp_sof),
+        .i_smp_eof(w_notch_smp_eof),
+        .i_smp_flags(w_notch_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(w_cal_smp_valid),
+        .o_smp_ch(w_cal_smp_ch),
+        .o_smp_data(w_cal_smp_data),
+        .o_smp_sof(w_cal_smp_sof),
+        .o_smp_eof(w_cal_smp_eof),
+        .o_smp_flags(w_cal_smp_flags)
+    );
+
+    // Common-average reference, after the stages above since they are linear.
+    // The replay is paced for the spatial filter.
+    rhd_car #(
+        .PAIR_CLKS(SPATIAL_M/SPATIAL_PAR + 2)
+    ) rhd_car_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_car_ctrl),
+        .i_mask(i_car_mask),
+        .o_mean(o_car_mean),
+
+        // Sample stream in
+        .i_smp_valid(w_cal_smp_valid),
+        .i_smp_ch(w_cal_smp_ch),
+        .i_smp_data(w_cal_smp_data),
+        .i_smp_sof(w_cal_smp_sof),
+        .i_smp_eof(w_cal_smp_eof),
+        .i_smp_flags(w_cal_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(w_car_smp_valid),
+        .o_smp_ch(w_car_smp_ch),
+        .o_smp_data(w_car_smp_data),
+        .o_smp_sof(w_car_smp_sof),
+        .o_smp_eof(w_car_smp_eof),
+        .o_smp_flags(w_car_smp_flags)
+    );
+
+    // The sinks below lay out their frames as 32 pairs, so the wrapper keeps
+    // all 64 outputs. An unknown module stops the elaboration otherwise.
+    generate
+        if (SPATIAL_M != 64) begin : g_spatial_m_check
+            rhd_wrapper_requires_SPATIAL_M_64 rhd_spatial_m_check_inst ();
+        end
+    endgenerate
+
+    // Spatial filter matrix
+    rhd_spatial #(
+        .M(SPATIAL_M),
+        .N_PAR(SPATIAL_PAR)
+    ) rhd_spatial_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_spatial_ctrl),
+
+        // Weight matrix
+        .i_coef_wr(i_spatial_coef_wr),
+        .i_coef_addr(i_spatial_coef_addr),
+        .i_coef_data(i_spatial_coef_data),
+
+        // Sample stream in
+        .i_smp_valid(w_car_smp_valid),
+        .i_smp_ch(w_car_smp_ch),
+        .i_smp_data(w_car_smp_data),
+        .i_smp_sof(w_car_smp_sof),
+        .i_smp_eof(w_car_smp_eof),
+        .i_smp_flags(w_car_smp_flags),
+
+        // Sample stream out
+        .o_smp_valid(o_smp_valid),
+        .o_smp_ch(o_smp_ch),
+        .o_smp_data(o_smp_data),
+        .o_smp_sof(o_smp_sof),
+        .o_smp_eof(o_smp_eof),
+        .o_smp_flags(o_smp_flags)
+    );
+
+    // Windowed EMG features of the output frames
+    rhd_features #(
+        .WIN_BITS(FEATURES_WIN_BITS)
+    ) rhd_features_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_feat_ctrl),
+        .i_win(i_feat_win),
+        .i_hop(i_feat_hop),
+        .i_thresh(i_feat_thresh),
+        .o_feat_ready(o_feat_ready),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+
+        // Read port
+        .i_rd_en(i_feat_rd_en),
+        .i_rd_addr(i_feat_rd_addr),
+        .o_rd_data(o_feat_rd_data)
+    );
+
+    // Threshold detection on the calibrated samples, ahead of the frame of
+    // delay of the common-average reference
+    rhd_detect #(
+        .EVT_BITS(DETECT_EVT_BITS)
+    ) rhd_detect_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_det_ctrl),
+        .i_mask(i_det_mask),
+        .i_adapt_k(i_det_adapt_k),
+        .i_tau(i_det_tau),
+        .i_pulse_len(i_det_pulse_len),
+
+        // Fixed thresholds
+        .i_thr_wr(i_det_thr_wr),
+        .i_thr_addr(i_det_thr_addr),
+        .i_thr_data(i_det_thr_data),
+
+        // Sample stream
+        .i_smp_valid(w_cal_smp_valid),
+        .i_smp_ch(w_cal_smp_ch),
+        .i_smp_data(w_cal_smp_data),
+        .i_smp_eof(w_cal_smp_eof),
+
+        // Detection output
+        .o_detect(o_detect),
+
+        // Event ring
+        .o_evt_count(o_det_evt_count),
+        .i_evt_addr(i_det_evt_addr),
+        .o_evt_data(o_det_evt_data)
+    );
+
+    // Statistics of the raw samples, where clipping is still visible
+    rhd_stats rhd_stats_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_stats_ctrl),
+        .i_interval(i_stats_interval),
+        .o_stats_ready(o_stats_ready),
+
+        // Sample stream
+        .i_smp_valid(w_seq_smp_valid),
+        .i_smp_ch(w_seq_smp_ch),
+        .i_smp_data(w_seq_smp_data),
+        .i_smp_sof(w_seq_smp_sof),
+        .i_smp_eof(w_seq_smp_eof),
+
+        // Read port
+        .i_rd_en(i_stats_rd_en),
+        .i_rd_addr(i_stats_rd_addr),
+        .o_rd_data(o_stats_rd_data)
+    );
+
+    // Spectral features of the output frames
+    rhd_spectrum #(
+        .FFT_BITS(SPECTRUM_FFT_BITS)
+    ) rhd_spectrum_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_spec_ctrl),
+        .i_hop(i_spec_hop),
+        .i_bands(i_spec_bands),
+        .o_spec_ready(o_spec_ready),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+
+        // Read port
+        .i_rd_en(i_spec_rd_en),
+        .i_rd_addr(i_spec_rd_addr),
+        .o_rd_data(o_spec_rd_data)
+    );
+
+    // Lossless compression of the output frames
+    rhd_rice rhd_rice_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_rice_ctrl),
+        .i_k(i_rice_k),
+        .i_key_period(i_rice_key_period),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Compressed stream
+        .o_cmp_valid(o_cmp_valid),
+        .o_cmp_data(o_cmp_data),
+        .o_cmp_last(o_cmp_last)
+    );
+
+    // Blocks of output frames, channel-major
+    rhd_transpose #(
+        .FRAME_BITS(TRANSPOSE_FRAME_BITS)
+    ) rhd_transpose_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_blk_ctrl),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Block stream
+        .o_blk_valid(o_blk_valid),
+        .o_blk_data(o_blk_data),
+        .o_blk_last(o_blk_last)
+    );
+
+    // Decimated preview of the output stream, for live display
+    rhd_preview rhd_preview_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_prv_ctrl),
+        .i_ratio(i_prv_ratio),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+
+        // Preview stream
+        .o_prv_valid(o_prv_valid),
+        .o_prv_ch(o_prv_ch),
+        .o_prv_data(o_prv_data),
+        .o_prv_sof(o_prv_sof),
+        .o_prv_eof(o_prv_eof)
+    );
+
+    // Masked channels of the output frames, packed for an AXI HP port
+    rhd_pack rhd_pack_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_pack_ctrl),
+        .i_mask(i_pack_mask),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Beat stream
+        .o_beat_valid(o_beat_valid),
+        .o_beat_data(o_beat_data),
+        .o_beat_last(o_beat_last)
+    );
+
+    // Blocks of output frames for the PS
+    rhd_banks #(
+        .FRAME_BITS(BANK_FRAME_BITS)
+    ) rhd_banks_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        // Control registers
+        .i_ctrl(i_banks_ctrl),
+        .o_status(o_banks_status),
+        .o_bank_ready(o_bank_ready),
+
+        // Sample stream
+        .i_smp_valid(o_smp_valid),
+        .i_smp_ch(o_smp_ch),
+        .i_smp_data(o_smp_data),
+        .i_smp_sof(o_smp_sof),
+        .i_smp_eof(o_smp_eof),
+        .i_smp_flags(o_smp_flags),
+
+        // Read port
+        .i_rd_en(i_banks_en),
+        .i_rd_addr(i_banks_addr[BANK_FRAME_BITS+8:2]),
+        .o_rd_data(o_banks_data)
+    );
+
     spi_master_cs spi_master_cs_inst (
         // Control/Data Signals,
         .i_rst(i_rst), // FPGA Reset
@@ -44,13 +978,13 @@ module rhd_wrapper (
         .i_clk_div(w_clk_div),
 
         // TX (MOSI) Signals
-        .i_din(i_din),          // Byte to transmit
-        .i_start(i_start),      // Data Valid Pulse 
+        .i_din(w_din),          // Byte to transmit
+        .i_start(w_start),      // Data Valid Pulse 
         .o_done(o_done),// Transmit Ready for Byte
 
         // RX (MISO) Signals
-        .o_dout_a(w_dout_a), // Byte received on MISO
-        .o_dout_b(w_dout_b),
+        .o_dout_a(w_spi_dout_a), // Byte received on MISO
+        .o_dout_b(w_spi_dout_b),
 
         // SPI Interface
         .o_sclk(o_sclk),
@@ -59,4 +993,64 @@ module rhd_wrapper (
         .o_cs(o_cs)
     );
 
+    // Synthetic MISO data, without a chip
+    rhd_pattern rhd_pattern_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        .i_ctrl(i_pat_ctrl),
+
+        .i_start(w_trace_event[0]),
+        .i_din(w_din),
+        .i_dout_a(w_spi_dout_a),
+        .i_dout_b(w_spi_dout_b),
+        .o_dout_a(w_dout_a),
+        .o_dout_b(w_dout_b)
+    );
+
+    // Transfer events, see rhd_trace.v
+    // [0] start, [1] CS low, [2] first SCLK, [3] last SCLK, [4] CS high, [5] done
+    assign w_trace_event[0] = w_start & ~r_start;
+    assign w_trace_event[1] = ~o_cs & r_cs;
+    assign w_trace_event[2] = o_sclk & ~r_sclk & (r_sclk_falls == 0);
+    assign w_trace_event[3] = ~o_sclk & r_sclk & (r_sclk_falls == 5'd15);
+    assign w_trace_event[4] = o_cs & ~r_cs;
+    assign w_trace_event[5] = o_done & ~r_done;
+
+    always @(posedge i_clk or negedge i_rst) begin
+        if (~i_rst) begin
+            r_start <= 1'b0;
+            r_done <= 1'b0;
+            r_cs <= 1'b1;
+            r_sclk <= 1'b0;
+            r_sclk_falls <= 0;
+        end else begin
+            r_start <= w_start;
+            r_done <= o_done;
+            r_cs <= o_cs;
+            r_sclk <= o_sclk;
+            if (w_trace_event[1]) begin
+                r_sclk_falls <= 0;
+            end else if (~o_sclk & r_sclk) begin
+                r_sclk_falls <= r_sclk_falls + 1'b1;
+            end
+        end
+    end
+
+    rhd_trace #(
+        .ADDR_WIDTH(TRACE_ADDR_WIDTH),
+        .N_EVENTS(6)
+    ) rhd_trace_inst (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+
+        .i_ctrl(i_trace_ctrl),
+        .o_status(o_trace_status),
+
+        .i_event(w_trace_event),
+
+        .i_addr(i_trace_addr),
+        .o_data(o_trace_data)
+    );
+
 endmodule
\ No newline at end of file
@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////////////////
+// Description: Electrode impedance measurement sequencer
+//              Runs the RHD2164 impedance test on the 64 electrodes, one after
+//              the other, through the first two aux slots of the acquisition
+//              sequencer, without any PS involvement per sample:
+//              slot 0  WRITE(6, DAC value), a sine wave updated every frame
+//              slot 1  WRITE(7, electrode) and WRITE(5, i_cfg), alternately
+//              The test frequency is f_frame * i_phase_inc / 65536.
+//
+//              Each electrode is selected for i_settle frames, then the
+//              response of its channel is demodulated at the test frequency
+//              over i_frames frames:
+//              I = sum(x * 127 * cos(phase)), Q = sum(x * 127 * sin(phase))
+//              where phase is the phase of the DAC value written during the
+//              previous frame, i.e. the one seen by the CONVERT. The amplitude
+//              of the response, in ADC steps, is 2 * sqrt(I^2 + Q^2) /
+//              (127 * i_frames), and i_frames should hold a whole number of
+//              periods of the sine wave. At the end of the sweep, Zcheck en
+//              (bit 0 of register 5) is cleared and the DAC goes back to
+//              mid-scale.
+//
+//              Memory map of the read port (32-bit words):
+//              4n + 0    I[31:0] of electrode n, n = 0 to 63
+//              4n + 1    I[47:32], sign-extended
+//              4n + 2    Q[31:0]
+//              4n + 3    Q[47:32], sign-extended
+//              The read port has one clock cycle of latency, like a BRAM, so
+//              it can sit behind an AXI BRAM Controller (word address = byte
+//              address [9:2]).
+//
+//              Status (o_status):
+//              [31]     sweep running
+//              [30]     sweep done
+//              [5:0]    electrode being measured
+//
+//              i_cfg, i_phase_inc, i_settle and i_frames are latched at the
+//              start of the sweep. The acquisition sequencer must be running
+//              with N_AUX >= 2, and i_settle should leave a few frames for
+//              the select and DAC writes to take effect.
+//
+//              Samples are offset binary (0x8000 = 0).
+//
+//              Control bits (i_ctrl):
+//              [0] run, a rising edge starts a sweep at the next frame,
+//                  clearing it aborts the sweep
+///////////////////////////////////////////////////////////////////////////////
+
+module rhd_zcheck (
+  // Control/Data Signals,
+  input i_rst,     // FPGA Reset
+  input i_clk,     // FPGA Clock
+
+  // Control registers
+  input         i_ctrl,
+  input  [7:0]  i_cfg,       // Register 5 during the sweep
+  input  [15:0] i_phase_inc, // DAC phase step per frame
+  input  [15:0] i_settle,    // Frames before measuring an electrode
+  input  [15:0] i_frames,    // Frames measured per electrode, 0 = 1
+  output [31:0] o_status,
+
+  // Sequencer
+  input             i_frame_start,
+  output reg        o_aux_en,  // Replace aux slots 0 and 1
+  output reg [31:0] o_aux_cmd, // Slot 0 in LSBs
+
+  // Sample stream
+  input        i_smp_valid,
+  input [4:0]  i_smp_ch,
+  input [31:0] i_smp_data,
+  input        i_smp_eof,
+
+  // Read port
+  input             i_rd_en,
+  input [7:0]       i_rd_addr,
+  output reg [31:0] o_rd_data
+);
+
+  localparam PI = 3.14159265358979;
+
+  reg signed [7:0] r_sin [0:255];
+  reg [95:0] r_res [0:63]; // {I, Q} per electrode
+  reg [95:0] r_res_q;
+  reg [1:0] r_rd_word;
+
+  reg r_ctrl_1;
+  reg r_arm;
+  reg r_run;
+  reg r_done;
+  reg [1:0] r_finish; // Frames left to turn the test off
+  reg r_odd;
+
+  reg [7:0] r_cfg;
+  reg [15:0] r_inc;
+  reg [15:0] r_settle;
+  reg [16:0] r_last;   // Last frame of an electrode
+
+  reg [5:0] r_e;
+  reg [16:0] r_fcnt;   // Frame of the current electrode
+  reg [15:0] r_phase;  // Phase of the next DAC value
+  reg [15:0] r_cmd_phase;
+  reg [15:0] r_ref;    // Phase of the DAC value seen by the samples
+
+  reg signed [23:0] r_prod_i;
+  reg signed [23:0] r_prod_q;
+  reg r_mac;
+  reg signed [47:0] r_acc_i;
+  reg signed [47:0] r_acc_q;
+  reg r_end;
+  reg r_end_1;
+
+  wire [15:0] w_x;
+  wire signed [15:0] w_xs;
+  wire signed [7:0] w_sin;
+  wire signed [7:0] w_cos;
+  wire [7:0] w_dac;
+
+  integer i;
+
+  initial begin
+    for (i = 0; i < 256; i = i + 1) begin
+      r_sin[i] = $rtoi($floor(127.0 * $sin(2.0 * PI * i / 256) + 0.5));
+    end
+  end
+
+  assign o_status = {r_run, r_done, 24'b0, r_e};
+
+  // Sample of the electrode being measured
+  assign w_x = r_e[5] ? i_smp_data[31:16] : i_smp_data[15:0];
+  assign w_xs = {~w_x[15], w_x[14:0]};
+
+  assign w_sin = r_sin[r_ref[15:8]];
+  assign w_cos = r_sin[r_ref[15:8] + 8'd64];
+  assign w_dac = 8'd128 + r_sin[r_phase[15:8]];
+
+  // Purpose: Published results, no reset so they map to BRAM
+  always @(posedge i_clk) begin
+    if (r_end_1) begin
+      r_res[r_e] <= {r_acc_i, r_acc_q};
+    end
+    if (i_rd_en) begin
+      r_res_q <= r_res[i_rd_addr[7:2]];
+      r_rd_word <= i_rd_addr[1:0];
+    end
+  end
+
+  // Purpose: Word of the result record
+  always @(*) begin // Combinational
+    case (r_rd_word)
+    2'd0: o_rd_data = r_res_q[79:48];
+    2'd1: o_rd_data = {{16{r_res_q[95]}}, r_res_q[95:80]};
+    2'd2: o_rd_data = r_res_q[31:0];
+    default: o_rd_data = {{16{r_res_q[47]}}, r_res_q[47:32]};
+    endcase
+  end
+
+  // Purpose: Aux commands, updated at each frame start
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_ctrl_1 <= 1'b0;
+      r_arm <= 1'b0;
+      r_odd <= 1'b0;
+      r_cfg <= 0;
+      r_inc <= 0;
+      r_settle <= 0;
+      r_last <= 0;
+      r_phase <= 0;
+      r_cmd_phase <= 0;
+      r_ref <= 0;
+      o_aux_en <= 1'b0;
+      o_aux_cmd <= 0;
+    end else begin
+      r_ctrl_1 <= i_ctrl;
+
+      if (i_ctrl & ~r_ctrl_1) begin
+        r_arm <= 1'b1;
+        r_cfg <= i_cfg;
+        r_inc <= i_phase_inc;
+        r_settle <= i_settle;
+        r_last <= i_settle + ((i_frames == 0) ? 16'd0 : i_frames - 1'b1);
+        r_phase <= 0;
+        r_cmd_phase <= 0;
+      end else if (~i_ctrl | (r_arm & i_frame_start)) begin
+        r_arm <= 1'b0;
+      end
+
+      if (i_frame_start) begin
+        r_odd <= ~r_odd;
+        if (r_run | (r_arm & i_ctrl)) begin
+          o_aux_en <= 1'b1;
+          o_aux_cmd[15:0] <= {2'b10, 6'd6, w_dac};
+          o_aux_cmd[31:16] <= r_odd ? {2'b10, 6'd5, r_cfg}
+                                    : {2'b10, 6'd7, 2'b0, r_run ? r_e : 6'd0};
+          r_cmd_phase <= r_phase;
+          r_ref <= r_cmd_phase;
+          r_phase <= r_phase + r_inc;
+        end else if (r_finish != 0) begin
+          o_aux_en <= 1'b1;
+          o_aux_cmd <= {2'b10, 6'd5, r_cfg[7:1], 1'b0, 2'b10, 6'd6, 8'd128};
+          r_phase <= 0;
+          r_cmd_phase <= 0;
+          r_ref <= 0;
+        end else begin
+          o_aux_en <= 1'b0;
+        end
+      end
+    end
+  end
+
+  // Purpose: Step through the electrodes, demodulate their response
+  always @(posedge i_clk or negedge i_rst) begin
+    if (~i_rst) begin
+      r_run <= 1'b0;
+      r_done <= 1'b0;
+      r_finish <= 0;
+      r_e <= 0;
+      r_fcnt <= 0;
+      r_prod_i <= 0;
+      r_prod_q <= 0;
+      r_mac <= 1'b0;
+      r_acc_i <= 0;
+      r_acc_q <= 0;
+      r_end <= 1'b0;
+      r_end_1 <= 1'b0;
+    end else begin
+      r_mac <= 1'b0;
+      r_end <= 1'b0;
+      r_end_1 <= r_end;
+
+      if (i_frame_start & (r_finish != 0) & ~r_run) begin
+        r_finish <= r_finish - 1'b1;
+      end
+
+      if (r_run & ~i_ctrl) begin
+        // Abort
+        r_run <= 1'b0;
+        r_finish <= 2'd2;
+      end else if (r_arm & i_ctrl & i_frame_start) begin
+        r_run <= 1'b1;
+        r_done <= 1'b0;
+        r_e <= 0;
+        r_fcnt <= 0;
+        r_acc_i <= 0;
+        r_acc_q <= 0;
+      end else if (r_run) begin
+        // Samples of this frame, measured after settling
+        if (i_smp_valid & (i_smp_ch == r_e[4:0]) & (r_fcnt >= r_settle)) begin
+          r_prod_i <= w_xs * w_cos;
+          r_prod_q <= w_xs * w_sin;
+          r_mac <= 1'b1;
+        end
+        if (i_smp_valid & i_smp_eof) begin
+          if (r_fcnt == r_last) begin
+            r_fcnt <= 0;
+            r_end <= 1'b1;
+          end else begin
+            r_fcnt <= r_fcnt + 1'b1;
+          end
+        end
+
+        if (r_mac) begin
+          r_acc_i <= r_acc_i + r_prod_i;
+          r_acc_q <= r_acc_q + r_prod_q;
+        end
+
+        // Results stored, next electrode
+        if (r_end_1) begin
+          r_acc_i <= 0;
+          r_acc_q <= 0;
+          r_e <= r_e + 1'b1;
+          if (&r_e) begin
+            r_run <= 1'b0;
+            r_done <= 1'b1;
+            r_finish <= 2'd2;
+          end
+        end
+      end
+    end
+  end
+
+endmodule // rhd_zcheck
@@ -1,2 +1,24 @@
 cd tests/spi_master_cs;make SIM=icarus WAVES=1; cd ../../
-cd tests/rhd_wrapper;make SIM=icarus WAVES=1; cd ../../
\ No newline at end of file
+cd tests/rhd_wrapper;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_capture;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_snapshot;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_sync;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_hpf;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_notch;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_decim;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_features;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_detect;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_car;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_spatial;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_cal;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_stats;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_spectrum;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_rice;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_transpose;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_preview;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_pack;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_banks;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_zcheck;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_scrub;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_settle;make SIM=icarus WAVES=1; cd ../../
+cd tests/rhd_regs;make SIM=icarus WAVES=1; cd ../../
\ No newline at end of file
@@ -0,0 +1,172 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+FRAMES = 16  # Frames per bank
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+async def send_frame(dut, pairs, flags=0):
+    """Send one frame, return whether a bank became ready"""
+    ready = False
+    dut.i_smp_flags.value = flags
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = pairs[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(2):
+            await RisingEdge(dut.i_clk)
+            ready |= dut.o_bank_ready.value == 1
+    return ready
+
+
+async def read_bank(dut, bank):
+    """Read a whole bank as a burst would, one word per clock cycle"""
+    words = []
+    for a in range(FRAMES * 32):
+        dut.i_rd_en.value = 1
+        dut.i_rd_addr.value = (bank * FRAMES * 32) + a
+        await RisingEdge(dut.i_clk)
+        if a:
+            words.append(dut.o_rd_data.value.integer)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    words.append(dut.o_rd_data.value.integer)
+    return [words[f * 32:(f + 1) * 32] for f in range(FRAMES)]
+
+
+async def read_flags(dut, bank):
+    """Frame flags of a bank"""
+    flags = []
+    for f in range(FRAMES + 1):
+        dut.i_rd_en.value = f < FRAMES
+        dut.i_rd_addr.value = 2 * FRAMES * 32 + bank * FRAMES + f
+        await RisingEdge(dut.i_clk)
+        if f:
+            flags.append(dut.o_rd_data.value.integer)
+    dut.i_rd_en.value = 0
+    return flags
+
+
+async def ack(dut):
+    dut.i_ctrl.value = 0b11
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = 0b01
+    await RisingEdge(dut.i_clk)
+
+
+def status(dut):
+    s = dut.o_status.value.integer
+    return {"bank": s >> 31, "pending": (s >> 30) & 1, "overruns": (s >> 16) & 0x3FFF, "banks": s & 0xFFFF}
+
+
+def random_frames(n):
+    return [[random.getrandbits(32) for _ in range(32)] for _ in range(n)]
+
+
+@cocotb.test()
+async def ping_pong(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+
+    for b in range(4):
+        frames = random_frames(FRAMES)
+        for n, f in enumerate(frames):
+            assert await send_frame(dut, f) == (n == FRAMES - 1)
+        s = status(dut)
+        assert s == {"bank": b % 2, "pending": 1, "overruns": 0, "banks": b + 1}
+        assert await read_bank(dut, s["bank"]) == frames
+        await ack(dut)
+        assert status(dut)["pending"] == 0
+
+
+@cocotb.test()
+async def read_while_filling(dut):
+    """The ready bank is not touched while the other one fills"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    frames = random_frames(FRAMES)
+    for f in frames:
+        await send_frame(dut, f)
+    for f in random_frames(FRAMES // 2):
+        await send_frame(dut, f)
+    assert await read_bank(dut, status(dut)["bank"]) == frames
+
+
+@cocotb.test()
+async def overrun(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    for f in random_frames(2 * FRAMES):
+        await send_frame(dut, f)
+    assert status(dut) == {"bank": 1, "pending": 1, "overruns": 1, "banks": 2}
+
+    await ack(dut)
+    for f in random_frames(FRAMES):
+        await send_frame(dut, f)
+    assert status(dut) == {"bank": 0, "pending": 1, "overruns": 1, "banks": 3}
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    for f in random_frames(FRAMES + 1):
+        assert not await send_frame(dut, f)
+    assert status(dut)["banks"] == 0
+
+
+@cocotb.test()
+async def one_frame_gap(dut):
+    """Disabled for a single frame, filling restarts at frame 0 of the bank"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    for f in random_frames(FRAMES // 2 + 1):
+        await send_frame(dut, f)
+    dut.i_ctrl.value = 0
+    await send_frame(dut, random_frames(1)[0])
+
+    dut.i_ctrl.value = 1
+    frames = random_frames(FRAMES)
+    for n, f in enumerate(frames):
+        assert await send_frame(dut, f) == (n == FRAMES - 1)
+    assert await read_bank(dut, status(dut)["bank"]) == frames
+
+
+@cocotb.test()
+async def frame_flags(dut):
+    """The flags of each frame are stored with it"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    frames = random_frames(FRAMES)
+    flags = [random.getrandbits(16) for _ in range(FRAMES)]
+    for f, fl in zip(frames, flags):
+        await send_frame(dut, f, fl)
+    bank = status(dut)["bank"]
+    assert await read_flags(dut, bank) == flags
+    assert await read_bank(dut, bank) == frames
@@ -0,0 +1,128 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_coef_wr.value = 0
+    dut.i_coef_addr.value = 0
+    dut.i_coef_data.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def cal_model(gains, offsets, samples):
+    out = []
+    for g, o, x in zip(gains, offsets, samples):
+        y = ((x - 0x8000) * g + (o << 14) + 8192) >> 14
+        out.append(min(0x7FFF, max(-0x8000, y)) + 0x8000)
+    return out
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the 64 calibrated channels"""
+    out = [None] * 64
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            if dut.o_smp_valid.value == 1:
+                assert dut.o_smp_ch.value == ch
+                assert dut.o_smp_sof.value == (ch == 0)
+                assert dut.o_smp_eof.value == (ch == 31)
+                data = dut.o_smp_data.value.integer
+                out[ch] = data & 0xFFFF
+                out[ch + 32] = data >> 16
+    assert None not in out
+    return out
+
+
+async def write_table(dut, gains, offsets):
+    for field, values in enumerate((gains, offsets)):
+        for n, v in enumerate(values):
+            dut.i_coef_wr.value = 1
+            dut.i_coef_addr.value = (field << 6) | n
+            dut.i_coef_data.value = v & 0xFFFF
+            await RisingEdge(dut.i_clk)
+    dut.i_coef_wr.value = 0
+
+
+async def commit(dut):
+    dut.i_ctrl.value = 0b11
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = 0b01
+    await RisingEdge(dut.i_clk)
+
+
+@cocotb.test()
+async def unity_after_reset(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    assert await send_frame(dut, samples) == samples
+
+
+@cocotb.test()
+async def bypass(dut):
+    await init_dut(dut)
+    await write_table(dut, [8192] * 64, [100] * 64)
+    dut.i_ctrl.value = 0b10
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = 0
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    assert await send_frame(dut, samples) == samples
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    gains = [random.randint(-32768, 32767) for _ in range(64)]
+    offsets = [random.randint(-2000, 2000) for _ in range(64)]
+    await write_table(dut, gains, offsets)
+    await commit(dut)
+
+    for _ in range(5):
+        samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+        assert await send_frame(dut, samples) == cal_model(gains, offsets, samples)
+
+
+@cocotb.test()
+async def commit_between_frames(dut):
+    await init_dut(dut)
+    unity = [16384] * 64
+    zero = [0] * 64
+    await write_table(dut, unity, zero)
+    await commit(dut)
+    samples = [0x8000 + random.randint(-8000, 8000) for _ in range(64)]
+    assert await send_frame(dut, samples) == samples
+
+    # Written but not committed
+    gains = [random.randint(8000, 24000) for _ in range(64)]
+    offsets = [random.randint(-500, 500) for _ in range(64)]
+    await write_table(dut, gains, offsets)
+    assert await send_frame(dut, samples) == samples
+
+    await commit(dut)
+    assert await send_frame(dut, samples) == cal_model(gains, offsets, samples)
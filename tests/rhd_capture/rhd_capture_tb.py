@@ -0,0 +1,182 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+
+FRAME_BITS = 8
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_post_frames.value = 0
+    dut.i_threshold.value = 0xFFFF
+    dut.i_trig.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    dut.i_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+async def send_frame(dut, value, spike=None, flags=0):
+    """Send the 32 pairs of a frame, every sample is `value` except for `spike`=(ch, sample)"""
+    dut.i_smp_flags.value = flags
+    for ch in range(32):
+        data = (value << 16) | value
+        if spike is not None and spike[0] == ch:
+            data = (value << 16) | spike[1]
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = data
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await RisingEdge(dut.i_clk)
+
+
+async def pulse_ctrl(dut, bit, level=0):
+    dut.i_ctrl.value = level | (1 << bit)
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = level
+
+
+async def read(dut, frame, ch):
+    dut.i_addr.value = (frame << 5) | ch
+    await ClockCycles(dut.i_clk, 2)
+    return dut.o_data.value.integer
+
+
+async def read_flags(dut, frame):
+    dut.i_addr.value = (1 << (FRAME_BITS + 5)) | frame
+    await ClockCycles(dut.i_clk, 2)
+    return dut.o_data.value.integer
+
+
+def status(dut):
+    s = dut.o_status.value.integer
+    return s >> 30, (s >> 29) & 1, (s >> 16) & 0xFFF, s & 0xFFF
+
+
+@cocotb.test()
+async def arm(dut):
+    await init_dut(dut)
+    assert status(dut)[0] == 0
+
+    await pulse_ctrl(dut, 0)
+    await RisingEdge(dut.i_clk)
+    assert status(dut) == (1, 0, 0, 0)
+
+    for f in range(3):
+        await send_frame(dut, 0x8000 + f)
+    assert status(dut) == (1, 0, 0, 3)
+    assert await read(dut, 2, 7) == 0x80028002
+
+
+@cocotb.test()
+async def register_trigger(dut):
+    await init_dut(dut)
+    dut.i_post_frames.value = 3
+    await pulse_ctrl(dut, 0)
+
+    for f in range(10):
+        await send_frame(dut, f)
+    await pulse_ctrl(dut, 1)
+    for f in range(10, 20):
+        await send_frame(dut, f)
+
+    # Trigger landed between frames 9 and 10, so frame 10 is the trigger
+    # frame and 11 to 13 the post-trigger frames
+    state, wrapped, trig, nxt = status(dut)
+    assert state == 3
+    assert wrapped == 0
+    assert trig == 10
+    assert nxt == 14
+    for f in range(14):
+        assert await read(dut, f, 31) == (f << 16) | f
+
+
+@cocotb.test()
+async def frame_flags(dut):
+    """Digital inputs are recorded with their frame"""
+    await init_dut(dut)
+    dut.i_post_frames.value = 2
+    await pulse_ctrl(dut, 0)
+
+    for f in range(6):
+        await send_frame(dut, f, flags=((0xA0 + f) << 8) | (f & 2))
+    await pulse_ctrl(dut, 1)
+    for f in range(6, 10):
+        await send_frame(dut, f, flags=(0xA0 + f) << 8)
+
+    assert status(dut)[3] == 9
+    for f in range(9):
+        assert await read_flags(dut, f) == ((0xA0 + f) << 8) | (f & 2 if f < 6 else 0)
+        assert await read(dut, f, 0) == (f << 16) | f
+
+
+@cocotb.test()
+async def ring_wraps(dut):
+    await init_dut(dut)
+    dut.i_post_frames.value = 1
+    await pulse_ctrl(dut, 0)
+
+    n = (1 << FRAME_BITS) + 5
+    for f in range(n):
+        await send_frame(dut, f & 0xFFFF)
+    await pulse_ctrl(dut, 1)
+    for f in range(n, n + 4):
+        await send_frame(dut, f & 0xFFFF)
+
+    state, wrapped, trig, nxt = status(dut)
+    assert state == 3 and wrapped == 1
+    assert trig == n % (1 << FRAME_BITS)
+    # Oldest frame comes right after the last one written
+    assert await read(dut, nxt, 0) == ((n + 2 - (1 << FRAME_BITS)) * 0x10001)
+
+
+@cocotb.test()
+async def threshold_trigger(dut):
+    await init_dut(dut)
+    dut.i_post_frames.value = 0
+    dut.i_threshold.value = 0x1000
+    await pulse_ctrl(dut, 0, level=1 << 3)
+
+    for f in range(4):
+        await send_frame(dut, 0x8000)
+    assert status(dut)[0] == 1
+    await send_frame(dut, 0x8000, spike=(5, 0x6000))
+    await send_frame(dut, 0x8000)
+
+    state, _, trig, nxt = status(dut)
+    assert state == 3
+    assert trig == 4 and nxt == 5
+
+
+@cocotb.test()
+async def external_trigger(dut):
+    await init_dut(dut)
+    dut.i_post_frames.value = 1
+    await pulse_ctrl(dut, 0, level=1 << 2)
+
+    await send_frame(dut, 0)
+    dut.i_trig.value = 1
+    await send_frame(dut, 1)
+    dut.i_trig.value = 0
+    for f in range(2, 5):
+        await send_frame(dut, f)
+
+    state, _, trig, nxt = status(dut)
+    assert state == 3
+    assert trig == 1 and nxt == 3
@@ -0,0 +1,180 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_mask.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def car_model(samples, mask):
+    """Return the mean (signed) and the 64 referenced channels"""
+    included = [x - 0x8000 for ch, x in enumerate(samples) if (mask >> ch) & 1]
+    total = sum(included)
+    mean = 0
+    if included:
+        mean = abs(total) // len(included)
+        mean = -mean if total < 0 else mean
+    out = [min(0x7FFF, max(-0x8000, x - 0x8000 - mean)) + 0x8000 for x in samples]
+    return mean, out
+
+
+async def collect(dut, frames, flags=None):
+    """Gather the output stream into 64-channel frames, and their flags"""
+    frame = [None] * 64
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_smp_valid.value == 1:
+            ch = dut.o_smp_ch.value.integer
+            data = dut.o_smp_data.value.integer
+            if dut.o_smp_sof.value == 1:
+                frame = [None] * 64
+            assert dut.o_smp_sof.value == (ch == 0)
+            assert dut.o_smp_eof.value == (ch == 31)
+            frame[ch] = data & 0xFFFF
+            frame[ch + 32] = data >> 16
+            if dut.o_smp_eof.value == 1:
+                assert None not in frame
+                frames.append(frame)
+                if flags is not None:
+                    flags.append(dut.o_smp_flags.value.integer)
+
+
+async def send_frame(dut, samples, spacing=6, flags=0):
+    dut.i_smp_flags.value = flags
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, spacing - 1)
+
+
+def offset(mean):
+    return (mean + 0x8000) & 0xFFFF
+
+
+@cocotb.test()
+async def bypass(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    mask = (1 << 64) - 1
+    dut.i_mask.value = mask
+
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_frame(dut, samples)
+    # Straight through, the mean is still computed
+    assert frames == [samples]
+    await ClockCycles(dut.i_clk, 40)
+    assert dut.o_mean.value == offset(car_model(samples, mask)[0])
+
+
+@cocotb.test()
+async def subtracts_mean(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    expected = []
+    for _ in range(6):
+        mask = random.getrandbits(64)
+        dut.i_mask.value = mask
+        samples = [0x8000 + random.randint(-8000, 8000) + 3000 for _ in range(64)]
+        mean, out = car_model(samples, mask)
+        expected.append(out)
+        await send_frame(dut, samples)
+        await ClockCycles(dut.i_clk, 20)
+
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == expected
+    assert dut.o_mean.value == offset(mean)
+
+
+@cocotb.test()
+async def saturates(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    # Mean pulled far down by the first channels only
+    mask = 0xFF
+    dut.i_mask.value = mask
+    samples = [0x0000] * 8 + [0xFFF0] * 56
+    await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == [car_model(samples, mask)[1]]
+    assert frames[0][8:] == [0xFFFF] * 56
+
+
+@cocotb.test()
+async def empty_mask(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == [samples]
+    assert dut.o_mean.value == 0x8000
+
+
+@cocotb.test()
+async def disable_back_to_back(dut):
+    """Frames back to back: the frame that starts during a replay is drained unchanged"""
+    await init_dut(dut)
+    frames = []
+    flags = []
+    cocotb.start_soon(collect(dut, frames, flags))
+    mask = (1 << 64) - 1
+    dut.i_mask.value = mask
+    dut.i_ctrl.value = 1
+
+    expected = []
+    for f in range(6):
+        if f == 3:
+            dut.i_ctrl.value = 0
+        samples = [0x8000 + random.randint(-8000, 8000) + 3000 for _ in range(64)]
+        expected.append(car_model(samples, mask)[1] if f < 3 else samples)
+        await send_frame(dut, samples, flags=0x100 + f)
+
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == expected
+    # Replayed, drained or bypassed, each frame keeps its flags
+    assert flags == [0x100 + f for f in range(6)]
+
+    # And back on
+    dut.i_ctrl.value = 1
+    frames.clear()
+    expected = []
+    for _ in range(3):
+        samples = [0x8000 + random.randint(-8000, 8000) for _ in range(64)]
+        expected.append(car_model(samples, mask)[1])
+        await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == expected
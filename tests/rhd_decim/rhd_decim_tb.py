@@ -0,0 +1,171 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+ORDER = 3
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+class CicModel:
+    def __init__(self, log2_ratio):
+        self.log2_ratio = log2_ratio
+        self.width = 16 + ORDER * 6
+        self.mask = (1 << self.width) - 1
+        self.integ = [[0] * ORDER for _ in range(64)]
+        self.comb = [[0] * ORDER for _ in range(64)]
+        self.phase = 0
+
+    def step(self, samples):
+        """Run one frame, return the 64 output channels or None"""
+        out_frame = self.phase == (1 << self.log2_ratio) - 1
+        self.phase = 0 if out_frame else self.phase + 1
+        out = []
+        for ch, x in enumerate(samples):
+            v = (x - 0x8000) & self.mask
+            for k in range(ORDER):
+                v = (self.integ[ch][k] + v) & self.mask
+                self.integ[ch][k] = v
+            if out_frame:
+                for k in range(ORDER):
+                    c = self.comb[ch][k]
+                    self.comb[ch][k] = v
+                    v = (v - c) & self.mask
+                y = (v >> (ORDER * self.log2_ratio)) & 0xFFFF
+                out.append(y ^ 0x8000)
+        return out if out_frame else None
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the 64 output channels or None if it was dropped"""
+    out = [None] * 64
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            if dut.o_smp_valid.value == 1:
+                assert dut.o_smp_ch.value == ch
+                assert dut.o_smp_sof.value == (ch == 0)
+                assert dut.o_smp_eof.value == (ch == 31)
+                data = dut.o_smp_data.value.integer
+                out[ch] = data & 0xFFFF
+                out[ch + 32] = data >> 16
+    if all(y is None for y in out):
+        return None
+    assert None not in out
+    return out
+
+
+@cocotb.test()
+async def bypass(dut):
+    await init_dut(dut)
+    for _ in range(3):
+        samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+        assert await send_frame(dut, samples) == samples
+
+
+@cocotb.test()
+async def output_rate(dut):
+    await init_dut(dut)
+    for log2_ratio in (1, 3, 6):
+        dut.i_ctrl.value = log2_ratio
+        await ClockCycles(dut.i_clk, 2)
+        ratio = 1 << log2_ratio
+        kept = []
+        for i in range(3 * ratio):
+            if await send_frame(dut, [0x8000] * 64) is not None:
+                kept.append(i)
+        assert kept == [ratio - 1, 2 * ratio - 1, 3 * ratio - 1]
+
+
+@cocotb.test()
+async def flags_merged(dut):
+    """The flags of an output frame are the OR of those of its R input frames"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 2
+    await ClockCycles(dut.i_clk, 2)
+    merged = []
+    for fl in (0x0100, 0x0002, 0x8000, 0x0000, 0x0400, 0, 0, 0):
+        dut.i_smp_flags.value = fl
+        if await send_frame(dut, [0x8000] * 64) is not None:
+            merged.append(dut.o_smp_flags.value.integer)
+    assert merged == [0x8102, 0x0400]
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    for log2_ratio in (2, 3):
+        dut.i_ctrl.value = log2_ratio
+        await ClockCycles(dut.i_clk, 2)
+        model = CicModel(log2_ratio)
+        n_out = 0
+        for _ in range(12 << log2_ratio):
+            samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+            expected = model.step(samples)
+            out = await send_frame(dut, samples)
+            assert (out is None) == (expected is None)
+            if out is not None:
+                n_out += 1
+                # States left over from the previous run are flushed after ORDER outputs
+                if n_out > ORDER:
+                    assert out == expected
+
+
+@cocotb.test()
+async def unity_gain(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 6
+    await ClockCycles(dut.i_clk, 2)
+
+    levels = [random.randint(0, 0xFFFF) for _ in range(64)]
+    outputs = []
+    for _ in range((ORDER + 1) * 64):
+        out = await send_frame(dut, levels)
+        if out is not None:
+            outputs.append(out)
+    assert outputs[-1] == levels
+
+
+@cocotb.test()
+async def ratio_clamped(dut):
+    """A log2 ratio of 7 runs at 64 with the gain of 64 removed"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 7
+    await ClockCycles(dut.i_clk, 2)
+
+    levels = [random.randint(0, 0xFFFF) for _ in range(64)]
+    kept = []
+    outputs = []
+    for i in range((ORDER + 1) * 64):
+        out = await send_frame(dut, levels)
+        if out is not None:
+            kept.append(i)
+            outputs.append(out)
+    assert kept == [64 * (n + 1) - 1 for n in range(ORDER + 1)]
+    assert outputs[-1] == levels
@@ -0,0 +1,206 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+EVT_BITS = 10
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_mask.value = 0
+    dut.i_adapt_k.value = 0
+    dut.i_tau.value = 0
+    dut.i_pulse_len.value = 0
+    dut.i_thr_wr.value = 0
+    dut.i_thr_addr.value = 0
+    dut.i_thr_data.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_evt_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+class DetectModel:
+    def __init__(self):
+        self.mean = [0] * 64
+        self.above = [False] * 64
+        self.thr = [0xFFFF] * 64
+        self.frame = 0
+        self.events = []
+
+    def step(self, samples, ctrl, mask, k, tau):
+        """Run one frame, return the channels that cross"""
+        crossed = []
+        for ch, x in enumerate(samples):
+            ax = abs(x - 0x8000)
+            if ctrl & 2:
+                thr = ((self.mean[ch] >> 8) * k) >> 4
+            else:
+                thr = self.thr[ch]
+            above = ax > thr
+            if above and not self.above[ch] and (mask >> ch) & 1 and ctrl & 1:
+                crossed.append(ch)
+                self.events.append((ch << 26) | (self.frame & 0x3FFFFFF))
+            self.above[ch] = above
+            self.mean[ch] = (self.mean[ch] + (((ax << 8) - self.mean[ch]) >> tau)) & 0xFFFFFF
+        self.frame += 1
+        return crossed
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the channels of the pairs during which o_detect rose"""
+    rose = []
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            prev = dut.o_detect.value.integer
+            await RisingEdge(dut.i_clk)
+            if dut.o_detect.value == 1 and not prev:
+                rose.append(ch)
+    return rose
+
+
+async def flush(dut, model):
+    """Clear the channel states with a silent frame"""
+    dut.i_tau.value = 0
+    await send_frame(dut, [0x8000] * 64)
+    model.step([0x8000] * 64, 0, 0, 0, 0)
+
+
+async def write_thresholds(dut, model, thr):
+    for ch, t in enumerate(thr):
+        dut.i_thr_wr.value = 1
+        dut.i_thr_addr.value = ch
+        dut.i_thr_data.value = t
+        await RisingEdge(dut.i_clk)
+        model.thr[ch] = t
+    dut.i_thr_wr.value = 0
+
+
+async def read_events(dut, first, last):
+    events = []
+    for n in range(first, last):
+        dut.i_evt_addr.value = n % (1 << EVT_BITS)
+        await RisingEdge(dut.i_clk)
+        await RisingEdge(dut.i_clk)
+        events.append(dut.o_evt_data.value.integer)
+    return events
+
+
+def spikes(n_spikes, noise):
+    frame = [0x8000 + random.randint(-noise, noise) for _ in range(64)]
+    for ch in random.sample(range(64), n_spikes):
+        frame[ch] = 0x8000 + random.choice((-1, 1)) * random.randint(5000, 20000)
+    return frame
+
+
+@cocotb.test()
+async def fixed_thresholds(dut):
+    await init_dut(dut)
+    model = DetectModel()
+    await flush(dut, model)
+
+    await write_thresholds(dut, model, [random.randint(1000, 4000) for _ in range(64)])
+    mask = random.getrandbits(64)
+    dut.i_mask.value = mask
+    dut.i_pulse_len.value = 3
+    dut.i_ctrl.value = 1
+
+    for _ in range(10):
+        samples = spikes(4, 500)
+        crossed = model.step(samples, 1, mask, 0, 0)
+        rose = await send_frame(dut, samples)
+        # o_detect follows the pair that crosses
+        assert set(rose) <= set(ch % 32 for ch in crossed)
+        if crossed:
+            assert rose
+
+    assert dut.o_evt_count.value == len(model.events)
+    assert await read_events(dut, 0, len(model.events)) == model.events
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    model = DetectModel()
+    await flush(dut, model)
+
+    await write_thresholds(dut, model, [1000] * 64)
+    dut.i_mask.value = (1 << 64) - 1
+    dut.i_pulse_len.value = 3
+    for _ in range(3):
+        assert await send_frame(dut, spikes(8, 100)) == []
+    assert dut.o_evt_count.value == 0
+
+
+@cocotb.test()
+async def adaptive_thresholds(dut):
+    await init_dut(dut)
+    model = DetectModel()
+    await flush(dut, model)
+
+    mask = (1 << 64) - 1
+    k = 0x50
+    tau = 3
+    dut.i_mask.value = mask
+    dut.i_adapt_k.value = k
+    dut.i_tau.value = tau
+    dut.i_pulse_len.value = 8
+
+    # Learn the noise level first
+    for _ in range(40):
+        samples = spikes(0, 800)
+        model.step(samples, 2, mask, k, tau)
+        await send_frame(dut, samples)
+
+    dut.i_ctrl.value = 3
+    for _ in range(20):
+        samples = spikes(3, 800)
+        model.step(samples, 3, mask, k, tau)
+        await send_frame(dut, samples)
+
+    assert len(model.events) > 0
+    assert dut.o_evt_count.value == len(model.events)
+    assert await read_events(dut, 0, len(model.events)) == model.events
+
+
+@cocotb.test()
+async def pulse_length(dut):
+    await init_dut(dut)
+    model = DetectModel()
+    await flush(dut, model)
+
+    await write_thresholds(dut, model, [1000] * 64)
+    dut.i_mask.value = 1 << 5
+    dut.i_pulse_len.value = 20
+    dut.i_ctrl.value = 1
+
+    samples = [0x8000] * 64
+    samples[5] = 0x8000 + 2000
+    dut.i_smp_valid.value = 1
+    dut.i_smp_ch.value = 5
+    dut.i_smp_data.value = (samples[37] << 16) | samples[5]
+    await RisingEdge(dut.i_clk)
+    dut.i_smp_valid.value = 0
+
+    high = 0
+    for _ in range(40):
+        await RisingEdge(dut.i_clk)
+        high += dut.o_detect.value.integer
+    assert high == 20
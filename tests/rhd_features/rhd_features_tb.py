@@ -0,0 +1,188 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import math
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_win.value = 0
+    dut.i_hop.value = 0
+    dut.i_thresh.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def contrib(x, x1, x2, thr):
+    d1 = x - x1
+    d2 = x1 - x2
+    zc = ((x < 0 < x1) or (x1 < 0 < x)) and abs(d1) >= thr
+    ssc = ((d2 > 0 > d1) or (d1 > 0 > d2)) and (abs(d1) >= thr or abs(d2) >= thr)
+    return abs(x), x * x, abs(d1), int(zc), int(ssc)
+
+
+class FeatureModel:
+    def __init__(self, win, hop, thr):
+        self.win = win
+        self.hop = hop
+        self.thr = thr
+        self.hist = [[] for _ in range(64)]  # Signed samples, including before enable
+        self.frames = 0
+
+    def feed(self, samples):
+        for ch, x in enumerate(samples):
+            self.hist[ch].append(x - 0x8000)
+
+    def enable(self):
+        self.frames = 0
+
+    def step(self, samples):
+        """Run one enabled frame, return whether it publishes a feature frame"""
+        self.feed(samples)
+        k = self.frames
+        self.frames += 1
+        w = 1 << self.win
+        return k >= w - 1 and (k - (w - 1)) % self.hop == 0
+
+
+def features(model):
+    w = 1 << model.win
+    words = []
+    for h in model.hist:
+        c = [contrib(h[n], h[n - 1], h[n - 2], model.thr) for n in range(len(h) - w, len(h))]
+        sa, sq, wl, zc, ssc = (sum(f) for f in zip(*c))
+        words += [sa >> model.win, sq >> model.win, wl, (zc << 16) | ssc]
+    return words
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return whether a feature frame was published"""
+    ready = False
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            ready |= dut.o_feat_ready.value == 1
+    return ready
+
+
+async def read(dut, addr):
+    dut.i_rd_en.value = 1
+    dut.i_rd_addr.value = addr
+    await RisingEdge(dut.i_clk)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    return dut.o_rd_data.value.integer
+
+
+async def read_features(dut):
+    return [await read(dut, a) for a in range(256)]
+
+
+def emg_frame(t):
+    """Noisy oscillations around 0, a different frequency per channel"""
+    return [
+        0x8000 + int(3000 * math.sin(0.3 * t * (1 + ch % 7))) + random.randint(-400, 400)
+        for ch in range(64)
+    ]
+
+
+async def run(dut, model, n_frames, t0=0):
+    gen = await read(dut, 256)
+    for t in range(t0, t0 + n_frames):
+        samples = emg_frame(t)
+        expected = model.step(samples)
+        assert await send_frame(dut, samples) == expected
+        if expected:
+            gen += 1
+            assert await read(dut, 256) == gen
+            assert await read_features(dut) == features(model)
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    model = FeatureModel(win=3, hop=3, thr=200)
+
+    # The samples before enabling are the history of the first window
+    for t in range(2):
+        samples = emg_frame(t)
+        model.feed(samples)
+        assert not await send_frame(dut, samples)
+
+    dut.i_win.value = model.win
+    dut.i_hop.value = model.hop
+    dut.i_thresh.value = model.thr
+    dut.i_ctrl.value = 1
+    await run(dut, model, 30, t0=2)
+
+
+@cocotb.test()
+async def hop_shorter_than_window(dut):
+    await init_dut(dut)
+    model = FeatureModel(win=4, hop=1, thr=0)
+    for t in range(2):
+        samples = emg_frame(t)
+        model.feed(samples)
+        await send_frame(dut, samples)
+
+    dut.i_win.value = model.win
+    dut.i_hop.value = model.hop
+    dut.i_thresh.value = model.thr
+    dut.i_ctrl.value = 1
+    await run(dut, model, 20, t0=2)
+
+
+@cocotb.test()
+async def restart(dut):
+    await init_dut(dut)
+    model = FeatureModel(win=2, hop=2, thr=100)
+    for t in range(2):
+        samples = emg_frame(t)
+        model.feed(samples)
+        await send_frame(dut, samples)
+
+    dut.i_win.value = model.win
+    dut.i_hop.value = model.hop
+    dut.i_thresh.value = model.thr
+    dut.i_ctrl.value = 1
+    await run(dut, model, 8, t0=2)
+
+    # Disabling clears the sums, the new settings apply when enabling again
+    dut.i_ctrl.value = 0
+    for t in range(10, 13):
+        samples = emg_frame(t)
+        model.feed(samples)
+        assert not await send_frame(dut, samples)
+
+    model.win = 3
+    model.hop = 1
+    model.thr = 300
+    model.enable()
+    dut.i_win.value = model.win
+    dut.i_hop.value = model.hop
+    dut.i_thresh.value = model.thr
+    dut.i_ctrl.value = 1
+    await run(dut, model, 12, t0=13)
@@ -0,0 +1,108 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_coef.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+class HpfModel:
+    def __init__(self, coef):
+        self.coef = coef
+        self.state = [0] * 64
+
+    def step(self, ch, x):
+        xs = x - 0x8000
+        s = self.state[ch]
+        y = max(-0x8000, min(0x7FFF, xs - (s >> 16)))
+        self.state[ch] = s + y * self.coef
+        return (y + 0x8000) & 0xFFFF
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the 64 filtered channels"""
+    out = [None] * 64
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            if dut.o_smp_valid.value == 1:
+                assert dut.o_smp_ch.value == ch
+                assert dut.o_smp_sof.value == (ch == 0)
+                assert dut.o_smp_eof.value == (ch == 31)
+                data = dut.o_smp_data.value.integer
+                out[ch] = data & 0xFFFF
+                out[ch + 32] = data >> 16
+    assert None not in out
+    return out
+
+
+@cocotb.test()
+async def bypass(dut):
+    await init_dut(dut)
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    assert await send_frame(dut, samples) == samples
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    coef = 0x0800
+    dut.i_coef.value = coef
+    dut.i_ctrl.value = 1
+    model = HpfModel(coef)
+
+    for _ in range(20):
+        samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+        expected = [model.step(ch, x) for ch, x in enumerate(samples)]
+        assert await send_frame(dut, samples) == expected
+
+
+@cocotb.test()
+async def removes_offset(dut):
+    await init_dut(dut)
+    dut.i_coef.value = 0x2000
+    dut.i_ctrl.value = 1
+
+    offsets = [0x8000 + random.randint(-0x4000, 0x4000) for _ in range(64)]
+    for _ in range(200):
+        out = await send_frame(dut, offsets)
+    assert all(abs(y - 0x8000) <= 8 for y in out)
+
+
+@cocotb.test()
+async def load(dut):
+    await init_dut(dut)
+    dut.i_coef.value = 0x0100
+    offsets = [0x8000 + random.randint(-0x4000, 0x4000) for _ in range(64)]
+
+    # Loading takes the offset out right away
+    dut.i_ctrl.value = 0b11
+    assert await send_frame(dut, offsets) == [0x8000] * 64
+    dut.i_ctrl.value = 0b01
+    assert await send_frame(dut, offsets) == [0x8000] * 64
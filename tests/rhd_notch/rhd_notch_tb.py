@@ -0,0 +1,194 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge
+import math
+import random
+
+N_SECTIONS = 2
+FS = 2000.0
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_coef_wr.value = 0
+    dut.i_coef_addr.value = 0
+    dut.i_coef_data.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def notch_coefs(f0, r=0.95):
+    w0 = 2 * math.pi * f0 / FS
+    c = [1.0, -2 * math.cos(w0), 1.0, -2 * r * math.cos(w0), r * r]
+    return [int(round(v * 16384)) for v in c]
+
+
+class NotchModel:
+    def __init__(self, sections, enabled):
+        self.sections = sections
+        self.enabled = enabled
+        self.state = {}
+
+    def step(self, ch, x):
+        x -= 0x8000
+        for s, c in enumerate(self.sections):
+            if not self.enabled[s]:
+                continue
+            x1, x2, y1, y2 = self.state.get((s, ch), (0, 0, 0, 0))
+            acc = c[0] * x + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2
+            y = max(-0x8000, min(0x7FFF, (acc + 8192) >> 14))
+            self.state[(s, ch)] = (x, x1, y, y1)
+            x = y
+        return (x + 0x8000) & 0xFFFF
+
+
+async def write_coefs(dut, section, coefs):
+    for tap, c in enumerate(coefs):
+        dut.i_coef_wr.value = 1
+        dut.i_coef_addr.value = (section << 3) | tap
+        dut.i_coef_data.value = c & 0xFFFF
+        await RisingEdge(dut.i_clk)
+    dut.i_coef_wr.value = 0
+    await RisingEdge(dut.i_clk)
+
+
+async def commit(dut):
+    en = dut.i_ctrl.value.integer & ((1 << N_SECTIONS) - 1)
+    dut.i_ctrl.value = en | (1 << N_SECTIONS)
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = en
+    await RisingEdge(dut.i_clk)
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the 64 filtered channels"""
+    out = [None] * 64
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(14 * N_SECTIONS + 2):
+            await RisingEdge(dut.i_clk)
+            if dut.o_smp_valid.value == 1:
+                assert dut.o_smp_ch.value == ch
+                data = dut.o_smp_data.value.integer
+                out[ch] = data & 0xFFFF
+                out[ch + 32] = data >> 16
+    assert None not in out
+    return out
+
+
+def sine(f, n, amp=8000):
+    return (0x8000 + int(round(amp * math.sin(2 * math.pi * f * n / FS)))) & 0xFFFF
+
+
+@cocotb.test()
+async def passthrough_after_reset(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 0b11
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    assert await send_frame(dut, samples) == samples
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    sections = [notch_coefs(50), notch_coefs(100)]
+    for s, c in enumerate(sections):
+        await write_coefs(dut, s, c)
+    dut.i_ctrl.value = 0b01
+    await commit(dut)
+    model = NotchModel(sections, [True, False])
+
+    for _ in range(10):
+        samples = [random.randint(0x4000, 0xC000) for _ in range(64)]
+        expected = [model.step(ch, x) for ch, x in enumerate(samples)]
+        assert await send_frame(dut, samples) == expected
+
+
+@cocotb.test()
+async def rejects_powerline(dut):
+    await init_dut(dut)
+    await write_coefs(dut, 0, notch_coefs(50))
+    await write_coefs(dut, 1, notch_coefs(100))
+    dut.i_ctrl.value = 0b11
+    await commit(dut)
+
+    # Channel 0: 50 Hz, channel 1: 100 Hz, channel 2: 300 Hz
+    peak = [0, 0, 0]
+    for n in range(400):
+        samples = [0x8000] * 64
+        samples[0] = sine(50, n)
+        samples[1] = sine(100, n)
+        samples[2] = sine(300, n)
+        out = await send_frame(dut, samples)
+        if n >= 300:
+            peak = [max(p, abs(out[c] - 0x8000)) for c, p in enumerate(peak)]
+
+    dut._log.info(f"Peak amplitudes after settling: {peak}")
+    assert peak[0] < 8000 / 20
+    assert peak[1] < 8000 / 20
+    assert peak[2] > 8000 * 0.8
+
+
+@cocotb.test()
+async def coefs_apply_at_frame_start(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 0b01
+    # Gain of 0.5 on section 0
+    await write_coefs(dut, 0, [8192, 0, 0, 0, 0])
+    await commit(dut)
+    samples = [0x9000] * 64
+
+    # Not applied before a start of frame
+    for ch in range(4):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = 8 + ch
+        dut.i_smp_data.value = 0x90009000
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        for _ in range(14 * N_SECTIONS + 2):
+            await RisingEdge(dut.i_clk)
+            if dut.o_smp_valid.value == 1:
+                assert dut.o_smp_data.value == 0x90009000
+
+    assert await send_frame(dut, samples) == [0x8800] * 64
+
+
+@cocotb.test()
+async def coefs_wait_for_commit(dut):
+    """An update written across several frames only applies once committed"""
+    await init_dut(dut)
+    dut.i_ctrl.value = 0b01
+    samples = [0x9000] * 64
+
+    # Gain of 0.5 then 0.25, written a word per frame
+    await write_coefs(dut, 0, [8192])
+    assert await send_frame(dut, samples) == samples
+    await write_coefs(dut, 0, [4096])
+    assert await send_frame(dut, samples) == samples
+
+    await commit(dut)
+    assert await send_frame(dut, samples) == [0x8400] * 64
+
+    # Still applied to the following frames
+    await write_coefs(dut, 0, [16384])
+    assert await send_frame(dut, samples) == [0x8400] * 64
@@ -0,0 +1,136 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+ORDER = [(i >> 1) + (i & 1) * 32 for i in range(64)]  # Stream order of the channels
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_mask.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def pack_model(frames, mask, align, flags=False):
+    """(data, last) of the beats of the given frames, f[64] being the flags of frame f"""
+    beats = []
+    pending = []
+    for f in frames:
+        if flags:
+            pending.append(f[64])
+        pending += [f[ch] for ch in ORDER if (mask >> ch) & 1]
+        while len(pending) >= 4:
+            beat, pending = pending[:4], pending[4:]
+            beats.append([beat, align and not pending])
+        if align and pending:
+            beats.append([pending + [0] * (4 - len(pending)), True])
+            pending = []
+    return [(sum(s << (16 * i) for i, s in enumerate(b)), last) for b, last in beats]
+
+
+async def send_frame(dut, samples):
+    dut.i_smp_flags.value = samples[64]
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 2)
+
+
+async def collect(dut, beats):
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_beat_valid.value == 1:
+            beats.append((dut.o_beat_data.value.integer, dut.o_beat_last.value == 1))
+
+
+async def run(dut, mask, align, n_frames, flags=False):
+    beats = []
+    cocotb.start_soon(collect(dut, beats))
+    dut.i_mask.value = mask
+    dut.i_ctrl.value = 1 | (align << 1) | (flags << 2)
+    frames = [[random.randint(0, 0xFFFF) for _ in range(65)] for _ in range(n_frames)]
+    for f in frames:
+        await send_frame(dut, f)
+    await ClockCycles(dut.i_clk, 4)
+    assert beats == pack_model(frames, mask, align, flags)
+    return beats
+
+
+@cocotb.test()
+async def all_channels(dut):
+    await init_dut(dut)
+    beats = await run(dut, (1 << 64) - 1, False, 3)
+    assert len(beats) == 3 * 16
+
+
+@cocotb.test()
+async def sparse_mask(dut):
+    await init_dut(dut)
+    mask = random.getrandbits(64)
+    await run(dut, mask, False, 5)
+
+
+@cocotb.test()
+async def aligned_frames(dut):
+    await init_dut(dut)
+    await run(dut, random.getrandbits(64), True, 5)
+
+
+@cocotb.test()
+async def aligned_three_left(dut):
+    """Frames of 7 samples end on a beat of 3"""
+    await init_dut(dut)
+    await run(dut, 0b1111111, True, 3)
+
+
+@cocotb.test()
+async def aligned_one_left(dut):
+    """Frames of 5 samples end on a beat of 1, after a full one in the same pair"""
+    await init_dut(dut)
+    await run(dut, (1 << 63) | (1 << 40) | (1 << 33) | (1 << 31) | 1, True, 3)
+
+
+@cocotb.test()
+async def frame_flags(dut):
+    await init_dut(dut)
+    await run(dut, random.getrandbits(64), False, 5, flags=True)
+
+
+@cocotb.test()
+async def frame_flags_aligned(dut):
+    """Frames of the flags, both samples of pair 0 and channel 5, then of the flags alone"""
+    await init_dut(dut)
+    await run(dut, (1 << 32) | 1 | (1 << 5), True, 3, flags=True)
+    await run(dut, 0, True, 2, flags=True)
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    beats = []
+    cocotb.start_soon(collect(dut, beats))
+    dut.i_mask.value = (1 << 64) - 1
+    for _ in range(2):
+        await send_frame(dut, [random.randint(0, 0xFFFF) for _ in range(65)])
+    assert beats == []
@@ -0,0 +1,105 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+ORDER = [(i >> 1) + (i & 1) * 32 for i in range(64)]  # Stream order of the channels
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_ratio.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def preview_model(frames):
+    """{max, min} of each channel over the given frames"""
+    return [(max(f[ch] for f in frames) << 16) | min(f[ch] for f in frames) for ch in range(64)]
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return the preview words sent during it, by channel"""
+    out = {}
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            if dut.o_prv_valid.value == 1:
+                c = dut.o_prv_ch.value.integer
+                assert c == ORDER[len(out)]
+                assert dut.o_prv_sof.value == (c == 0)
+                assert dut.o_prv_eof.value == (c == 63)
+                out[c] = dut.o_prv_data.value.integer
+    return [out[c] for c in range(64)] if out else None
+
+
+def random_frame():
+    return [random.randint(0, 0xFFFF) for _ in range(64)]
+
+
+async def run(dut, ratio, n_previews):
+    for _ in range(n_previews):
+        frames = [random_frame() for _ in range(ratio)]
+        for f in frames[:-1]:
+            assert await send_frame(dut, f) is None
+        assert await send_frame(dut, frames[-1]) == preview_model(frames)
+
+
+@cocotb.test()
+async def min_max(dut):
+    await init_dut(dut)
+    dut.i_ratio.value = 10
+    dut.i_ctrl.value = 1
+    await run(dut, 10, 3)
+
+
+@cocotb.test()
+async def every_frame(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    await run(dut, 1, 3)
+
+
+@cocotb.test()
+async def ratio_change(dut):
+    await init_dut(dut)
+    dut.i_ratio.value = 4
+    dut.i_ctrl.value = 1
+    frames = [random_frame() for _ in range(4)]
+    for f in frames[:2]:
+        await send_frame(dut, f)
+
+    # Applied once the current interval is over
+    dut.i_ratio.value = 3
+    for f in frames[2:3]:
+        assert await send_frame(dut, f) is None
+    assert await send_frame(dut, frames[3]) == preview_model(frames)
+    await run(dut, 3, 2)
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    dut.i_ratio.value = 1
+    for _ in range(3):
+        assert await send_frame(dut, random_frame()) is None
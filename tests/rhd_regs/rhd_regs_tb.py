@@ -0,0 +1,545 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge
+import random
+
+N_AUX = 3
+NOTCH_SECTIONS = 2
+DETECT_EVT_BITS = 10
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_axi_awaddr.value = 0
+    dut.i_axi_awvalid.value = 0
+    dut.i_axi_wdata.value = 0
+    dut.i_axi_wstrb.value = 0xF
+    dut.i_axi_wvalid.value = 0
+    dut.i_axi_bready.value = 0
+    dut.i_axi_araddr.value = 0
+    dut.i_axi_arvalid.value = 0
+    dut.i_axi_rready.value = 0
+    dut.i_frame_cnt.value = 0
+    dut.i_overruns.value = 0
+    dut.i_frame_flags.value = 0
+    dut.i_aux_valid.value = 0
+    dut.i_aux_slot.value = 0
+    dut.i_aux_data.value = 0
+    dut.i_feat_ready.value = 0
+    dut.i_feat_rd_data.value = 0
+    dut.i_stats_ready.value = 0
+    dut.i_stats_rd_data.value = 0
+    dut.i_spec_ready.value = 0
+    dut.i_spec_rd_data.value = 0
+    dut.i_cap_status.value = 0
+    dut.i_snap_rd_data.value = 0
+    dut.i_det_evt_count.value = 0
+    dut.i_det_evt_data.value = 0
+    dut.i_car_mean.value = 0
+    dut.i_zc_status.value = 0
+    dut.i_zc_rd_data.value = 0
+    dut.i_scrub_alert.value = 0
+    dut.i_scrub_status.value = 0
+    dut.i_scrub_flags.value = 0
+    dut.i_settle_status.value = 0
+    clock = Clock(dut.i_clk, 20, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+    await RisingEdge(dut.i_clk)
+
+
+async def bram(dut, en, addr, data, mem, log=None):
+    """Read port with one clock cycle of latency, `data` = mem(`addr`) after `en`"""
+    while True:
+        await RisingEdge(dut.i_clk)
+        if en.value:
+            a = addr.value.integer
+            data.value = mem(a)
+            if log is not None:
+                log.append(a)
+
+
+async def axi_write(dut, addr, data):
+    dut.i_axi_awaddr.value = addr
+    dut.i_axi_awvalid.value = 1
+    dut.i_axi_wdata.value = data
+    dut.i_axi_wvalid.value = 1
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_axi_awready.value and dut.o_axi_wready.value:
+            break
+    dut.i_axi_awvalid.value = 0
+    dut.i_axi_wvalid.value = 0
+    dut.i_axi_bready.value = 1
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_axi_bvalid.value:
+            break
+    assert dut.o_axi_bresp.value.integer == 0
+    dut.i_axi_bready.value = 0
+
+
+async def axi_read(dut, addr):
+    dut.i_axi_araddr.value = addr
+    dut.i_axi_arvalid.value = 1
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_axi_arready.value:
+            break
+    dut.i_axi_arvalid.value = 0
+    dut.i_axi_rready.value = 1
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_axi_rvalid.value:
+            break
+    assert dut.o_axi_rresp.value.integer == 0
+    data = dut.o_axi_rdata.value.integer
+    dut.i_axi_rready.value = 0
+    return data
+
+
+async def check_registers(dut, regs):
+    """Write and read back `regs` = [(offset, port, width[, lsb])], read-only when the port is an input"""
+    for offset, port, width, *lsb in regs:
+        lsb = lsb[0] if lsb else 0
+        mask = (1 << width) - 1
+        value = random.randint(0, 0xFFFFFFFF)
+        signal = getattr(dut, port)
+        if port.startswith("i_"):
+            signal.value = value & mask
+        else:
+            await axi_write(dut, offset, value)
+            assert (signal.value.integer >> lsb) & mask == value & mask
+        assert await axi_read(dut, offset) == value & mask
+
+
+@cocotb.test()
+async def sequencer_registers(dut):
+    await init_dut(dut)
+    assert dut.o_seq_en.value == 0
+
+    await axi_write(dut, 0x004, 5000)
+    for n in range(N_AUX):
+        await axi_write(dut, 0x020 + 4 * n, 0xE800 + n)
+    await axi_write(dut, 0x000, 1)
+    assert dut.o_seq_en.value == 1
+    assert dut.o_frame_period.value.integer == 5000
+    aux = dut.o_aux_cmd.value.integer
+    assert [(aux >> (16 * n)) & 0xFFFF for n in range(N_AUX)] == [0xE800 + n for n in range(N_AUX)]
+
+    assert await axi_read(dut, 0x000) == 1
+    assert await axi_read(dut, 0x004) == 5000
+    for n in range(N_AUX):
+        assert await axi_read(dut, 0x020 + 4 * n) == 0xE800 + n
+
+    dut.i_frame_cnt.value = 0x12345678
+    dut.i_overruns.value = 7
+    assert await axi_read(dut, 0x008) == 0x12345678
+    assert await axi_read(dut, 0x00C) == 7
+    dut.i_frame_flags.value = 0xA503
+    assert await axi_read(dut, 0x010) == 0xA503
+
+    await axi_write(dut, 0x000, 0b10)
+    assert dut.o_seq_en.value == 0
+    assert dut.o_sync_slave.value == 1
+    assert await axi_read(dut, 0x000) == 0b10
+
+    # Aux results, kept per slot until the next one
+    for n in range(N_AUX):
+        dut.i_aux_slot.value = n
+        dut.i_aux_data.value = 0x4900 + n
+        await pulse(dut, dut.i_aux_valid)
+    for n in range(N_AUX):
+        assert await axi_read(dut, 0x060 + 4 * n) == 0x4900 + n
+    assert await axi_read(dut, 0x060 + 4 * N_AUX) == 0
+
+    # Past the aux slots and unmapped registers
+    assert await axi_read(dut, 0x020 + 4 * N_AUX) == 0
+    await axi_write(dut, 0x03C, 0xFFFF)
+    assert dut.o_aux_cmd.value.integer == aux
+    assert await axi_read(dut, 0x0FC) == 0
+
+
+@cocotb.test()
+async def capture_registers(dut):
+    await init_dut(dut)
+
+    await axi_write(dut, 0x044, 100)
+    await axi_write(dut, 0x048, 0x1000)
+    await axi_write(dut, 0x040, 0b1101)
+    assert dut.o_cap_ctrl.value.integer == 0b1101
+    assert dut.o_cap_post_frames.value.integer == 100
+    assert dut.o_cap_threshold.value.integer == 0x1000
+    assert await axi_read(dut, 0x040) == 0b1101
+    assert await axi_read(dut, 0x044) == 100
+    assert await axi_read(dut, 0x048) == 0x1000
+
+    dut.i_cap_status.value = 0xC0010020
+    assert await axi_read(dut, 0x04C) == 0xC0010020
+
+
+@cocotb.test()
+async def back_to_back(dut):
+    """Reads and writes issued together, with the ready signals held"""
+    await init_dut(dut)
+
+    dut.i_axi_bready.value = 1
+    dut.i_axi_rready.value = 1
+    dut.i_axi_awaddr.value = 0x004
+    dut.i_axi_wdata.value = 0
+    dut.i_axi_awvalid.value = 1
+    dut.i_axi_wvalid.value = 1
+    dut.i_axi_araddr.value = 0x004
+    dut.i_axi_arvalid.value = 1
+
+    writes = 0
+    reads = []
+    for _ in range(40):
+        await RisingEdge(dut.i_clk)
+        if dut.o_axi_awready.value:
+            writes += 1
+            dut.i_axi_wdata.value = writes
+        if dut.o_axi_rvalid.value:
+            reads.append(dut.o_axi_rdata.value.integer)
+
+    dut.i_axi_awvalid.value = 0
+    dut.i_axi_wvalid.value = 0
+    dut.i_axi_arvalid.value = 0
+
+    # Every write is answered, every read returns a value that was written
+    assert writes > 5
+    assert len(reads) > 5
+    assert all(r <= writes for r in reads)
+    assert reads == sorted(reads)
+
+
+@cocotb.test()
+async def snapshot_window(dut):
+    await init_dut(dut)
+    reads = []
+    cocotb.start_soon(bram(dut, dut.o_snap_rd_en, dut.o_snap_rd_addr, dut.i_snap_rd_data,
+                           lambda a: 0x50000 + a, reads))
+
+    for a in [0, 1, 64, 65, 127]:
+        assert await axi_read(dut, 0x1000 + 4 * a) == 0x50000 + a
+
+    # One read of the port per access, none from the other pages
+    assert await axi_read(dut, 0x000) == 0
+    await axi_write(dut, 0x1000, 1)
+    assert reads == [0, 1, 64, 65, 127]
+
+
+@cocotb.test()
+async def hpf_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x080, "o_hpf_ctrl", 2),
+        (0x084, "o_hpf_coef", 16),
+    ])
+
+
+async def write_port(dut, wr, addr, data, log):
+    """Record the (address, data) of the writes of a write port"""
+    while True:
+        await RisingEdge(dut.i_clk)
+        if wr.value:
+            log.append((addr.value.integer, data.value.integer))
+
+
+@cocotb.test()
+async def notch_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x0C0, "o_notch_ctrl", NOTCH_SECTIONS + 1),
+    ])
+
+    writes = []
+    cocotb.start_soon(write_port(dut, dut.o_notch_coef_wr, dut.o_notch_coef_addr,
+                                 dut.o_notch_coef_data, writes))
+    coefs = [((s << 3) | t, random.randint(0, 0xFFFF)) for s in range(NOTCH_SECTIONS) for t in range(5)]
+    for addr, data in coefs:
+        await axi_write(dut, 0x2000 + 4 * addr, 0xABCD0000 | data)
+    await axi_write(dut, 0x0C0, 0)
+    assert writes == coefs
+    assert await axi_read(dut, 0x2000) == 0
+
+
+@cocotb.test()
+async def decim_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x100, "o_decim_ctrl", 3),
+    ])
+
+
+@cocotb.test()
+async def features_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x140, "o_feat_ctrl", 1),
+        (0x144, "o_feat_win", 4),
+        (0x148, "o_feat_hop", 16),
+        (0x14C, "o_feat_thresh", 16),
+    ])
+
+    reads = []
+    cocotb.start_soon(bram(dut, dut.o_feat_rd_en, dut.o_feat_rd_addr, dut.i_feat_rd_data,
+                           lambda a: 0xFEA70000 + a, reads))
+    for a in [0, 255, 256, 511]:
+        assert await axi_read(dut, 0x3000 + 4 * a) == 0xFEA70000 + a
+    assert reads == [0, 255, 256, 511]
+
+
+async def pulse(dut, signal):
+    signal.value = 1
+    await RisingEdge(dut.i_clk)
+    signal.value = 0
+
+
+@cocotb.test()
+async def events(dut):
+    await init_dut(dut)
+    assert dut.o_irq.value == 0
+
+    # Latched while the interrupt is masked
+    await pulse(dut, dut.i_feat_ready)
+    assert await axi_read(dut, 0x018) == 0b1
+    assert dut.o_irq.value == 0
+    await axi_write(dut, 0x01C, 0b1)
+    assert await axi_read(dut, 0x01C) == 0b1
+    assert dut.o_irq.value == 1
+
+    # Cleared by writing 1, writing 0 leaves it
+    await axi_write(dut, 0x018, 0)
+    assert await axi_read(dut, 0x018) == 0b1
+    await axi_write(dut, 0x018, 0b1)
+    assert await axi_read(dut, 0x018) == 0
+    assert dut.o_irq.value == 0
+
+    await pulse(dut, dut.i_feat_ready)
+    await RisingEdge(dut.i_clk)
+    assert dut.o_irq.value == 1
+
+
+@cocotb.test()
+async def detect_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x180, "o_det_ctrl", 2),
+        (0x184, "o_det_mask", 32, 0),
+        (0x188, "o_det_mask", 32, 32),
+        (0x18C, "o_det_adapt_k", 8),
+        (0x190, "o_det_tau", 4),
+        (0x194, "o_det_pulse_len", 16),
+        (0x198, "i_det_evt_count", 32),
+    ])
+
+    writes = []
+    cocotb.start_soon(write_port(dut, dut.o_det_thr_wr, dut.o_det_thr_addr,
+                                 dut.o_det_thr_data, writes))
+    thresholds = [(ch, random.randint(0, 0xFFFF)) for ch in (0, 31, 32, 63)]
+    for ch, thr in thresholds:
+        await axi_write(dut, 0x4000 + 4 * ch, thr)
+    await axi_write(dut, 0x5000, 0)
+    assert writes == thresholds
+
+    # Event ring, without a read enable
+    async def ring():
+        while True:
+            await RisingEdge(dut.i_clk)
+            dut.i_det_evt_data.value = (0x3F << 26) | dut.o_det_evt_addr.value.integer
+
+    cocotb.start_soon(ring())
+    for a in [0, 1, (1 << DETECT_EVT_BITS) - 1]:
+        assert await axi_read(dut, 0x5000 + 4 * a) == (0x3F << 26) | a
+
+
+@cocotb.test()
+async def car_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x1C0, "o_car_ctrl", 1),
+        (0x1C4, "o_car_mask", 32, 0),
+        (0x1C8, "o_car_mask", 32, 32),
+        (0x1CC, "i_car_mean", 16),
+    ])
+
+
+@cocotb.test()
+async def spatial_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x200, "o_spatial_ctrl", 2),
+    ])
+
+    writes = []
+    cocotb.start_soon(write_port(dut, dut.o_spatial_coef_wr, dut.o_spatial_coef_addr,
+                                 dut.o_spatial_coef_data, writes))
+    weights = [((m << 6) | n, random.randint(0, 0xFFFF)) for m, n in ((0, 0), (0, 63), (31, 5), (63, 63))]
+    for addr, w in weights:
+        await axi_write(dut, 0xC000 + 4 * addr, w)
+    await axi_write(dut, 0xB000, 0)
+    assert writes == weights
+
+
+@cocotb.test()
+async def cal_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x240, "o_cal_ctrl", 2),
+    ])
+
+    writes = []
+    cocotb.start_soon(write_port(dut, dut.o_cal_coef_wr, dut.o_cal_coef_addr,
+                                 dut.o_cal_coef_data, writes))
+    coefs = [((field << 6) | ch, random.randint(0, 0xFFFF)) for field in (0, 1) for ch in (0, 63)]
+    for addr, c in coefs:
+        await axi_write(dut, 0x6000 + 4 * addr, c)
+    await axi_write(dut, 0x2000, 0)
+    assert writes == coefs
+
+
+@cocotb.test()
+async def stats_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x280, "o_stats_ctrl", 1),
+        (0x284, "o_stats_interval", 16),
+    ])
+
+    reads = []
+    cocotb.start_soon(bram(dut, dut.o_stats_rd_en, dut.o_stats_rd_addr, dut.i_stats_rd_data,
+                           lambda a: 0x57A70000 + a, reads))
+    for a in [0, 511, 512, 1023]:
+        assert await axi_read(dut, 0x7000 + 4 * a) == 0x57A70000 + a
+    assert reads == [0, 511, 512, 1023]
+
+    await pulse(dut, dut.i_stats_ready)
+    assert await axi_read(dut, 0x018) == 0b10
+
+
+@cocotb.test()
+async def spectrum_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x2C0, "o_spec_ctrl", 1),
+        (0x2C4, "o_spec_hop", 16),
+        (0x2C8, "o_spec_bands", 32),
+    ])
+
+    reads = []
+    cocotb.start_soon(bram(dut, dut.o_spec_rd_en, dut.o_spec_rd_addr, dut.i_spec_rd_data,
+                           lambda a: 0x5BEC0000 + a, reads))
+    for a in [0, 7, 512, 1023]:
+        assert await axi_read(dut, 0x8000 + 4 * a) == 0x5BEC0000 + a
+    assert reads == [0, 7, 512, 1023]
+
+    await pulse(dut, dut.i_spec_ready)
+    assert await axi_read(dut, 0x018) == 0b100
+
+
+@cocotb.test()
+async def rice_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x300, "o_rice_ctrl", 1),
+        (0x304, "o_rice_k", 4),
+        (0x308, "o_rice_key_period", 16),
+    ])
+
+
+@cocotb.test()
+async def blk_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x340, "o_blk_ctrl", 1),
+    ])
+
+
+@cocotb.test()
+async def prv_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x380, "o_prv_ctrl", 1),
+        (0x384, "o_prv_ratio", 16),
+    ])
+
+
+@cocotb.test()
+async def pack_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x3C0, "o_pack_ctrl", 3),
+        (0x3C4, "o_pack_mask", 32, 0),
+        (0x3C8, "o_pack_mask", 32, 32),
+    ])
+
+
+@cocotb.test()
+async def zcheck_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x440, "o_zc_ctrl", 1),
+        (0x444, "o_zc_cfg", 8),
+        (0x448, "o_zc_phase_inc", 16),
+        (0x44C, "o_zc_settle", 16),
+        (0x450, "o_zc_frames", 16),
+        (0x454, "i_zc_status", 32),
+    ])
+
+    reads = []
+    cocotb.start_soon(bram(dut, dut.o_zc_rd_en, dut.o_zc_rd_addr, dut.i_zc_rd_data,
+                           lambda a: 0x2C4E0000 + a, reads))
+    for a in [0, 1, 128, 255]:
+        assert await axi_read(dut, 0x9000 + 4 * a) == 0x2C4E0000 + a
+    assert reads == [0, 1, 128, 255]
+
+
+@cocotb.test()
+async def scrub_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x480, "o_scrub_ctrl", 2),
+        (0x484, "o_scrub_period", 16),
+        (0x488, "o_scrub_mask", 27),
+        (0x48C, "i_scrub_status", 32),
+        (0x490, "i_scrub_flags", 27),
+    ])
+
+    writes = []
+    cocotb.start_soon(write_port(dut, dut.o_scrub_wr, dut.o_scrub_addr, dut.o_scrub_data, writes))
+    shadow = [(a, random.randint(0, 0xFF)) for a in range(27)]
+    for addr, data in shadow:
+        await axi_write(dut, 0xA000 + 4 * addr, 0x5C000000 | data)
+    await axi_write(dut, 0x480, 0)
+    assert writes == shadow
+
+    await pulse(dut, dut.i_scrub_alert)
+    assert await axi_read(dut, 0x018) == 0b1000
+
+
+@cocotb.test()
+async def settle_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x4C0, "o_settle_ctrl", 1),
+        (0x4C4, "o_settle_mask", 32, 0),
+        (0x4C8, "o_settle_mask", 32, 32),
+        (0x4CC, "o_settle_margin", 16),
+        (0x4D0, "o_settle_hits", 8),
+        (0x4D4, "o_settle_hold", 16),
+        (0x4D8, "o_settle_reg0", 8),
+        (0x4DC, "i_settle_status", 32),
+    ])
+
+
+@cocotb.test()
+async def pattern_registers(dut):
+    await init_dut(dut)
+    await check_registers(dut, [
+        (0x500, "o_pat_ctrl", 3),
+    ])
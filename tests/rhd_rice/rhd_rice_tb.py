@@ -0,0 +1,223 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import ctypes
+import math
+import os
+import random
+import subprocess
+import tempfile
+
+ORDER = [(i >> 1) + (i & 1) * 32 for i in range(64)]  # Stream order of the channels
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_k.value = 0
+    dut.i_key_period.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+class RiceEncoder:
+    def __init__(self, k, key_period):
+        self.k = k
+        self.key_period = key_period
+        self.prev = [0] * 64
+        self.frame = 0
+
+    def encode(self, samples, flags):
+        """Words of one frame"""
+        key = self.frame == 0 or (self.key_period != 0 and self.frame % self.key_period == 0)
+        bits = format((0xA5 << 24) | (self.k << 17) | (key << 16) | (self.frame & 0xFFFF), "032b")
+        bits += format(flags, "016b")
+        for ch in ORDER:
+            x = samples[ch]
+            if key:
+                bits += format(x, "016b")
+            else:
+                d = (x - self.prev[ch]) & 0xFFFF
+                u = ((d << 1) ^ (0xFFFF if d & 0x8000 else 0)) & 0xFFFF
+                q = u >> self.k
+                if q >= 16:
+                    bits += "1" * 16 + format(u, "016b")
+                else:
+                    bits += "1" * q + "0"
+                    if self.k:
+                        bits += format(u & ((1 << self.k) - 1), "0{}b".format(self.k))
+            self.prev[ch] = x
+        self.frame += 1
+        bits += "0" * (-len(bits) % 32)
+        return [int(bits[i:i + 32], 2) for i in range(0, len(bits), 32)]
+
+
+class RiceState(ctypes.Structure):
+    _fields_ = [("prev", ctypes.c_uint16 * 64), ("synced", ctypes.c_int)]
+
+
+class RiceFrame(ctypes.Structure):
+    _fields_ = [
+        ("frame", ctypes.c_uint16),
+        ("flags", ctypes.c_uint16),
+        ("key", ctypes.c_int),
+        ("valid", ctypes.c_int),
+        ("samples", ctypes.c_uint16 * 64),
+    ]
+
+
+def load_decoder():
+    """Build vitis/rhd_rice.c as a shared library"""
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "vitis", "rhd_rice.c")
+    lib = os.path.join(tempfile.mkdtemp(), "librhd_rice.so")
+    subprocess.run(["gcc", "-shared", "-fPIC", "-O2", "-o", lib, src], check=True)
+    c = ctypes.CDLL(lib)
+    c.rhd_rice_init.argtypes = [ctypes.POINTER(RiceState)]
+    c.rhd_rice_init.restype = None
+    c.rhd_rice_decode_frame.argtypes = [
+        ctypes.POINTER(RiceState),
+        ctypes.POINTER(ctypes.c_uint32),
+        ctypes.c_size_t,
+        ctypes.POINTER(RiceFrame),
+    ]
+    c.rhd_rice_decode_frame.restype = ctypes.c_int
+    return c
+
+
+RHD_RICE = load_decoder()
+
+
+class RiceDecoder:
+    """vitis/rhd_rice.c, the decoder of the PS"""
+
+    def __init__(self):
+        self.state = RiceState()
+        self.flags = None  # Of the last frame decoded
+        RHD_RICE.rhd_rice_init(ctypes.byref(self.state))
+
+    def decode(self, words):
+        """Return (samples, number of words), samples being None before a key frame"""
+        buf = (ctypes.c_uint32 * len(words))(*words)
+        out = RiceFrame()
+        n = RHD_RICE.rhd_rice_decode_frame(ctypes.byref(self.state), buf, len(words), ctypes.byref(out))
+        assert n > 0
+        self.flags = out.flags
+        return (list(out.samples) if out.valid else None), n
+
+    def truncated(self, words):
+        """Return code of the decoder on a frame cut short"""
+        state = RiceState()
+        ctypes.memmove(ctypes.byref(state), ctypes.byref(self.state), ctypes.sizeof(state))
+        buf = (ctypes.c_uint32 * len(words))(*words)
+        out = RiceFrame()
+        return RHD_RICE.rhd_rice_decode_frame(ctypes.byref(state), buf, len(words) - 1, ctypes.byref(out))
+
+
+async def send_frame(dut, samples, flags):
+    dut.i_smp_flags.value = flags
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 4)
+    await ClockCycles(dut.i_clk, 4)
+
+
+async def collect(dut, frames):
+    """Gather the compressed stream into frames of words"""
+    words = []
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_cmp_valid.value == 1:
+            words.append(dut.o_cmp_data.value.integer)
+            if dut.o_cmp_last.value == 1:
+                frames.append(words)
+                words = []
+
+
+def emg_frame(t):
+    return [
+        0x8000 + int(1000 * math.sin(0.05 * t * (1 + ch % 5))) + random.randint(-100, 100)
+        for ch in range(64)
+    ]
+
+
+async def run(dut, enc, samples):
+    """Return the frames of words and the frame flags they were sent with"""
+    flags = [random.getrandbits(16) for _ in samples]
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_k.value = enc.k
+    dut.i_key_period.value = enc.key_period
+    dut.i_ctrl.value = 1
+    for s, fl in zip(samples, flags):
+        await send_frame(dut, s, fl)
+    await ClockCycles(dut.i_clk, 10)
+    assert frames == [enc.encode(s, fl) for s, fl in zip(samples, flags)]
+    return frames, flags
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    samples = [emg_frame(t) for t in range(20)]
+    frames, flags = await run(dut, RiceEncoder(k=8, key_period=8), samples)
+
+    # Lossless, and the deltas take at most 12 bits instead of 16
+    dec = RiceDecoder()
+    for words, s, fl in zip(frames, samples, flags):
+        assert dec.truncated(words) == -2
+        assert dec.decode(words) == (s, len(words))
+        assert dec.flags == fl
+    assert all(len(f) <= 26 for n, f in enumerate(frames) if n % 8)
+
+
+@cocotb.test()
+async def escapes(dut):
+    """Full-scale jumps do not fit the unary part"""
+    await init_dut(dut)
+    samples = [[random.randint(0, 0xFFFF) for _ in range(64)] for _ in range(6)]
+    frames, _ = await run(dut, RiceEncoder(k=2, key_period=0), samples)
+    dec = RiceDecoder()
+    for words, s in zip(frames, samples):
+        assert dec.decode(words)[0] == s
+
+
+@cocotb.test()
+async def start_anywhere(dut):
+    """Decoding starts at the first key frame seen"""
+    await init_dut(dut)
+    samples = [emg_frame(t) for t in range(12)]
+    frames, flags = await run(dut, RiceEncoder(k=6, key_period=4), samples)
+
+    dec = RiceDecoder()
+    for n, (words, s) in enumerate(zip(frames[2:], samples[2:]), start=2):
+        decoded, length = dec.decode(words)
+        assert length == len(words)
+        assert decoded == (s if n >= 4 else None)
+        assert dec.flags == flags[n]
+
+
+@cocotb.test()
+async def every_frame_key(dut):
+    await init_dut(dut)
+    samples = [emg_frame(t) for t in range(3)]
+    frames, _ = await run(dut, RiceEncoder(k=0, key_period=1), samples)
+    assert all(len(f) == 34 for f in frames)
@@ -0,0 +1,174 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+REGS = list(range(18)) + list(range(40, 45)) + list(range(60, 64))  # Shadow table entries
+ROM = {40: ord("I"), 41: ord("N"), 42: ord("T"), 43: ord("A"), 44: ord("N"), 60: 1, 61: 0, 62: 64, 63: 4}
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_period.value = 0
+    dut.i_mask.value = 0
+    dut.i_shadow_wr.value = 0
+    dut.i_shadow_addr.value = 0
+    dut.i_shadow_data.value = 0
+    dut.i_frame_start.value = 0
+    dut.i_aux_grant.value = 1
+    dut.i_aux_valid.value = 0
+    dut.i_aux_slot.value = 0
+    dut.i_aux_data.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def random_chip():
+    regs = {r: random.randint(0, 0xFF) for r in range(18)}
+    regs.update(ROM)
+    return regs
+
+
+async def write_shadow(dut, regs):
+    for n, r in enumerate(REGS):
+        dut.i_shadow_wr.value = 1
+        dut.i_shadow_addr.value = n
+        dut.i_shadow_data.value = regs[r]
+        await RisingEdge(dut.i_clk)
+    dut.i_shadow_wr.value = 0
+    await RisingEdge(dut.i_clk)
+
+
+async def aux_result(dut, slot, data):
+    """Send an aux result, return o_alert"""
+    dut.i_aux_valid.value = 1
+    dut.i_aux_slot.value = slot
+    dut.i_aux_data.value = data
+    await RisingEdge(dut.i_clk)
+    dut.i_aux_valid.value = 0
+    await RisingEdge(dut.i_clk)
+    alert = dut.o_alert.value.integer
+    await ClockCycles(dut.i_clk, 2)
+    return alert
+
+
+async def run_frames(dut, chip, n, reads, taken=()):
+    """Frames of the sequencer with 3 aux slots, the READs of slot 2 are answered by chip.
+    During the frames of taken, slot 2 is used by another module"""
+    prev = [0, 0, None]
+    alerts = 0
+    for k in range(n):
+        dut.i_frame_start.value = 1
+        await RisingEdge(dut.i_clk)
+        dut.i_frame_start.value = 0
+        dut.i_aux_grant.value = 0 if k in taken else 1
+        await RisingEdge(dut.i_clk)
+        cmd = dut.o_aux_cmd.value.integer if dut.o_aux_en.value == 1 else None
+        if k in taken:
+            cmd = None
+
+        # Results of the last aux slots of the previous frame, during the CONVERTs
+        for slot in (1, 2):
+            if slot == 2 and prev[2] is not None:
+                assert prev[2] >> 14 == 0b11  # READ
+                data = chip[(prev[2] >> 8) & 0x3F]
+            else:
+                data = random.randint(0, 0xFFFF)
+            alerts += await aux_result(dut, slot, data)
+        await ClockCycles(dut.i_clk, 20)
+        alerts += await aux_result(dut, 0, random.randint(0, 0xFFFF))
+
+        if cmd is not None:
+            reads.append((cmd >> 8) & 0x3F)
+        prev = [0, 0, cmd]
+    return alerts
+
+
+def status(dut):
+    s = dut.o_status.value.integer
+    return {"bad": s >> 31, "mismatches": (s >> 16) & 0x7FFF, "passes": s & 0xFFFF}
+
+
+@cocotb.test()
+async def clean(dut):
+    await init_dut(dut)
+    chip = random_chip()
+    await write_shadow(dut, chip)
+    dut.i_mask.value = (1 << 27) - 1
+    dut.i_ctrl.value = 1
+
+    reads = []
+    assert await run_frames(dut, chip, 2 * 27 + 1, reads) == 0
+    assert reads == (REGS * 3)[:2 * 27 + 1]
+    assert status(dut) == {"bad": 0, "mismatches": 0, "passes": 2}
+    assert dut.o_flags.value == 0
+
+
+@cocotb.test()
+async def mismatch(dut):
+    await init_dut(dut)
+    chip = random_chip()
+    await write_shadow(dut, chip)
+    dut.i_mask.value = ((1 << 27) - 1) & ~(1 << 5)  # Register 5 not checked
+    dut.i_ctrl.value = 1
+
+    # Chip reset by a brown-out
+    chip[3] ^= 0x10
+    chip[5] ^= 0x01
+    chip[60] ^= 0x01
+    reads = []
+    assert await run_frames(dut, chip, 2 * 27 + 1, reads) == 4
+    assert status(dut) == {"bad": 1, "mismatches": 4, "passes": 2}
+    assert dut.o_flags.value == (1 << 3) | (1 << 23)
+
+    # Clear
+    dut.i_ctrl.value = 0b11
+    await ClockCycles(dut.i_clk, 2)
+    assert status(dut) == {"bad": 0, "mismatches": 0, "passes": 0}
+    assert dut.o_flags.value == 0
+
+
+@cocotb.test()
+async def slot_taken(dut):
+    await init_dut(dut)
+    chip = random_chip()
+    await write_shadow(dut, chip)
+    dut.i_mask.value = (1 << 27) - 1
+    dut.i_ctrl.value = 1
+
+    # Impedance sweep frames, their slot 2 results are not READs
+    taken = (3, 4, 10, 30)
+    reads = []
+    assert await run_frames(dut, chip, 2 * 27 + 1 + len(taken), reads, taken) == 0
+    assert reads == (REGS * 3)[:2 * 27 + 1]
+    assert status(dut) == {"bad": 0, "mismatches": 0, "passes": 2}
+    assert dut.o_flags.value == 0
+
+
+@cocotb.test()
+async def period(dut):
+    await init_dut(dut)
+    chip = random_chip()
+    await write_shadow(dut, chip)
+    dut.i_mask.value = (1 << 27) - 1
+    dut.i_period.value = 2
+    dut.i_ctrl.value = 1
+
+    reads = []
+    await run_frames(dut, chip, 12, reads)
+    assert reads == REGS[:4]
+    assert status(dut)["mismatches"] == 0
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    reads = []
+    await run_frames(dut, random_chip(), 5, reads)
+    assert reads == []
@@ -0,0 +1,146 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+SET = 0x8000 | 0x20 | 0x0C  # WRITE(0, reg0 | fast settle)
+CLEAR = 0x8000 | 0x0C       # WRITE(0, reg0)
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_mask.value = 0
+    dut.i_margin.value = 0
+    dut.i_hits.value = 0
+    dut.i_hold.value = 0
+    dut.i_reg0.value = 0
+    dut.i_frame_start.value = 0
+    dut.i_aux_grant.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def random_frame(rails=()):
+    """Samples around 0, the channels of rails stuck at 0xFFFF"""
+    return [0xFFFF if ch in rails else 0x8000 + random.randint(-20000, 20000) for ch in range(64)]
+
+
+async def run_frame(dut, samples):
+    """One frame of the sequencer, return the command of aux slot 0 if replaced"""
+    dut.i_frame_start.value = 1
+    await RisingEdge(dut.i_clk)
+    dut.i_frame_start.value = 0
+    await ClockCycles(dut.i_clk, 4)
+
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 4)
+        if ch == 29:
+            # Aux slot 0, after CONVERT(31) whose result comes two transfers later
+            aux = dut.o_aux_cmd.value.integer if dut.o_aux_en.value == 1 else None
+    await ClockCycles(dut.i_clk, 4)
+    return aux
+
+
+async def setup(dut, hits, hold, mask=(1 << 64) - 1):
+    await init_dut(dut)
+    dut.i_mask.value = mask
+    dut.i_margin.value = 100
+    dut.i_hits.value = hits
+    dut.i_hold.value = hold
+    dut.i_reg0.value = 0x0C
+    dut.i_aux_grant.value = 1
+    dut.i_ctrl.value = 1
+
+
+@cocotb.test()
+async def saturation(dut):
+    await setup(dut, 3, 4)
+    aux = []
+    for f in range(12):
+        rails = (40,) if 2 <= f < 5 else ()
+        aux.append(await run_frame(dut, random_frame(rails)))
+        if f == 4:
+            assert dut.o_status.value.integer == (1 << 31) | (40 << 16) | 1
+
+    # Triggered during frame 4, released in the 5th frame after it
+    assert aux == [None] * 4 + [SET] * 5 + [CLEAR] + [None] * 2
+    assert dut.o_status.value.integer == (40 << 16) | 1
+
+
+@cocotb.test()
+async def last_convert(dut):
+    """A trigger on channel 31 comes after aux slot 0, so it applies from the next frame"""
+    await setup(dut, 1, 2)
+    aux = [await run_frame(dut, random_frame(rails)) for rails in [(), (31,), (), (), (), ()]]
+    assert aux == [None, None, SET, SET, CLEAR, None]
+
+
+@cocotb.test()
+async def near_rail(dut):
+    await setup(dut, 2, 1)
+    frame = random_frame()
+    frame[7] = 50  # Within the margin of 0x0000
+    aux = [await run_frame(dut, frame) for _ in range(4)]
+    assert aux == [None, SET, SET, CLEAR]
+    assert (dut.o_status.value >> 16) & 0x3F == 7
+
+
+@cocotb.test()
+async def not_sustained(dut):
+    await setup(dut, 3, 4)
+    aux = []
+    for f in range(8):
+        rails = (12,) if f % 3 else ()  # Never 3 frames in a row
+        aux.append(await run_frame(dut, random_frame(rails)))
+    assert aux == [None] * 8
+
+
+@cocotb.test()
+async def masked(dut):
+    await setup(dut, 1, 4, mask=((1 << 64) - 1) & ~(1 << 63))
+    aux = [await run_frame(dut, random_frame((63,))) for _ in range(4)]
+    assert aux == [None] * 4
+    assert dut.o_status.value == 0
+
+
+@cocotb.test()
+async def disabled(dut):
+    await setup(dut, 1, 4)
+    dut.i_ctrl.value = 0
+    aux = [await run_frame(dut, random_frame((0, 32))) for _ in range(4)]
+    assert aux == [None] * 4
+
+
+@cocotb.test()
+async def slot_taken(dut):
+    """Aux slot 0 taken by an impedance sweep: the hold and the release wait for it"""
+    await setup(dut, 1, 1)
+    aux = []
+    for f in range(8):
+        # Slot 0 taken during frames 1, 3 and 4
+        dut.i_aux_grant.value = f not in (1, 3, 4)
+        aux.append(await run_frame(dut, random_frame((40,) if f == 0 else ())))
+
+    # Frame 1 does not count towards the hold, the release goes out in frame 5
+    assert aux == [SET, SET, SET, CLEAR, CLEAR, CLEAR, None, None]
+    assert dut.o_status.value.integer == (40 << 16) | 1
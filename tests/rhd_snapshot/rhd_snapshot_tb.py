@@ -0,0 +1,92 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+async def send_pairs(dut, samples, channels):
+    """Send the pairs of `channels`, `samples` holds the 64 channel values"""
+    for ch in channels:
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_eof.value = 0
+        await RisingEdge(dut.i_clk)
+
+
+async def read(dut, addr):
+    dut.i_rd_en.value = 1
+    dut.i_rd_addr.value = addr
+    await RisingEdge(dut.i_clk)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    return dut.o_rd_data.value.integer
+
+
+async def read_bank(dut):
+    return [await read(dut, a) for a in range(66)]
+
+
+@cocotb.test()
+async def latest_frame(dut):
+    await init_dut(dut)
+
+    for gen in range(1, 4):
+        samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+        await send_pairs(dut, samples, range(32))
+        bank = await read_bank(dut)
+        assert bank[0] == gen
+        assert [w >> 16 for w in bank[1:]] == [gen] * 65
+        assert [w & 0xFFFF for w in bank[1:65]] == samples
+
+
+@cocotb.test()
+async def frame_is_atomic(dut):
+    await init_dut(dut)
+
+    old = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_pairs(dut, old, range(32))
+
+    # Half a frame does not show up until the frame is complete
+    new = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_pairs(dut, new, range(16))
+    bank = await read_bank(dut)
+    assert bank[0] == 1
+    assert [w & 0xFFFF for w in bank[1:65]] == old
+
+    await send_pairs(dut, new, range(16, 32))
+    bank = await read_bank(dut)
+    assert bank[0] == 2
+    assert [w & 0xFFFF for w in bank[1:65]] == new
+
+
+@cocotb.test()
+async def frame_flags(dut):
+    await init_dut(dut)
+
+    samples = [0] * 64
+    dut.i_smp_flags.value = 0xA500
+    await send_pairs(dut, samples, range(32))
+    dut.i_smp_flags.value = 0x3C00
+    assert (await read(dut, 65)) == (1 << 16) | 0xA500
@@ -0,0 +1,223 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+M = 64
+SPACING = 20  # Clock cycles between pairs, at least M/N_PAR+1
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_coef_wr.value = 0
+    dut.i_coef_addr.value = 0
+    dut.i_coef_data.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def spatial_model(weights, samples):
+    x = [s - 0x8000 for s in samples]
+    out = []
+    for row in weights:
+        y = (sum(w * v for w, v in zip(row, x)) + 8192) >> 14
+        out.append(min(0x7FFF, max(-0x8000, y)) + 0x8000)
+    return out
+
+
+async def collect(dut, frames, flags=None):
+    """Gather the output stream into M-channel frames, and their flags"""
+    frame = [None] * M
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_smp_valid.value == 1:
+            k = dut.o_smp_ch.value.integer
+            data = dut.o_smp_data.value.integer
+            if dut.o_smp_sof.value == 1:
+                frame = [None] * M
+            frame[k] = data & 0xFFFF
+            frame[k + M // 2] = data >> 16
+            if dut.o_smp_eof.value == 1:
+                assert k == M // 2 - 1
+                assert None not in frame
+                frames.append(frame)
+                if flags is not None:
+                    flags.append(dut.o_smp_flags.value.integer)
+
+
+async def send_frame(dut, samples, flags=0):
+    dut.i_smp_flags.value = flags
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, SPACING - 1)
+
+
+async def write_weights(dut, weights):
+    for m, row in enumerate(weights):
+        for n, w in enumerate(row):
+            dut.i_coef_wr.value = 1
+            dut.i_coef_addr.value = (m << 6) | n
+            dut.i_coef_data.value = w & 0xFFFF
+            await RisingEdge(dut.i_clk)
+    dut.i_coef_wr.value = 0
+
+
+async def commit(dut):
+    dut.i_ctrl.value = 0b11
+    await RisingEdge(dut.i_clk)
+    dut.i_ctrl.value = 0b01
+    await RisingEdge(dut.i_clk)
+
+
+def bipolar():
+    """Differences of neighbouring electrodes, the last row left out"""
+    weights = [[0] * 64 for _ in range(M)]
+    for m in range(M - 1):
+        weights[m][m] = 16384
+        weights[m][m + 1] = -16384
+    return weights
+
+
+@cocotb.test()
+async def identity_after_reset(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == [samples]
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+
+    weights = [[random.randint(-6000, 6000) for _ in range(64)] for _ in range(M)]
+    await write_weights(dut, weights)
+    dut.i_ctrl.value = 1
+    await commit(dut)
+
+    expected = []
+    for _ in range(3):
+        samples = [0x8000 + random.randint(-4000, 4000) for _ in range(64)]
+        expected.append(spatial_model(weights, samples))
+        await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == expected
+
+
+@cocotb.test()
+async def commit_between_frames(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    # Bank 0 still holds the identity or the matrix of a previous test
+    identity = [[16384 if n == m else 0 for n in range(64)] for m in range(M)]
+    await write_weights(dut, identity)
+    await commit(dut)
+    samples = [0x8000 + random.randint(-4000, 4000) for _ in range(64)]
+    await send_frame(dut, samples)
+
+    # Not committed yet, the next frame still uses the identity
+    await write_weights(dut, bipolar())
+    await send_frame(dut, samples)
+    await commit(dut)
+    await send_frame(dut, samples)
+    await ClockCycles(dut.i_clk, 200)
+
+    assert frames == [samples, samples, spatial_model(bipolar(), samples)]
+
+
+@cocotb.test()
+async def bypass(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+
+    samples = [random.randint(0, 0xFFFF) for _ in range(64)]
+    await send_frame(dut, samples)
+    assert frames == [samples]
+
+
+async def send_frames(dut, frames, flags=None):
+    """Send frames back to back, the next one starting while the outputs are sent"""
+    for n, samples in enumerate(frames):
+        await send_frame(dut, samples, 0 if flags is None else flags[n])
+
+
+@cocotb.test()
+async def commit_back_to_back(dut):
+    await init_dut(dut)
+    frames = []
+    cocotb.start_soon(collect(dut, frames))
+    dut.i_ctrl.value = 1
+
+    identity = [[16384 if n == m else 0 for n in range(64)] for m in range(M)]
+    await write_weights(dut, identity)
+    await commit(dut)
+    await write_weights(dut, bipolar())
+
+    samples = [[0x8000 + random.randint(-4000, 4000) for _ in range(64)] for _ in range(4)]
+    await send_frames(dut, samples[:2])
+    await commit(dut)
+    await send_frames(dut, samples[2:])
+    await ClockCycles(dut.i_clk, 200)
+
+    assert frames == samples[:2] + [spatial_model(bipolar(), x) for x in samples[2:]]
+
+
+@cocotb.test()
+async def disable_back_to_back(dut):
+    await init_dut(dut)
+    frames = []
+    flags = []
+    cocotb.start_soon(collect(dut, frames, flags))
+    dut.i_ctrl.value = 1
+
+    await write_weights(dut, bipolar())
+    await commit(dut)
+
+    samples = [[0x8000 + random.randint(-4000, 4000) for _ in range(64)] for _ in range(6)]
+    sent_flags = [random.getrandbits(16) for _ in range(6)]
+    await send_frames(dut, samples[:3], sent_flags[:3])
+    dut.i_ctrl.value = 0
+    await send_frames(dut, samples[3:], sent_flags[3:])
+    await ClockCycles(dut.i_clk, 200)
+
+    # The bypassed frames follow the outputs of the last filtered one, with their flags
+    assert frames == [spatial_model(bipolar(), x) for x in samples[:3]] + samples[3:]
+    assert flags == sent_flags
+
+    # And back on
+    frames.clear()
+    dut.i_ctrl.value = 1
+    await send_frames(dut, samples[:2])
+    await ClockCycles(dut.i_clk, 200)
+    assert frames == [spatial_model(bipolar(), x) for x in samples[:2]]
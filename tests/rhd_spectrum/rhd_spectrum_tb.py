@@ -0,0 +1,188 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import math
+import random
+
+L = 8
+N = 1 << L
+PI = 3.141592653589793
+
+HANN = [math.floor(65536.0 * (0.5 - 0.5 * math.cos(2.0 * PI * n / N)) + 0.5) for n in range(N)]
+TW_RE = [math.floor(65536.0 * math.cos(2.0 * PI * k / N) + 0.5) for k in range(N // 2)]
+TW_IM = [math.floor(-65536.0 * math.sin(2.0 * PI * k / N) + 0.5) for k in range(N // 2)]
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_hop.value = 0
+    dut.i_bands.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def bitrev(n):
+    return int(format(n, "0{}b".format(L))[::-1], 2)
+
+
+def fft_model(x):
+    """Windowed radix-2 FFT with the rounding of the hardware"""
+    re = [0] * N
+    im = [0] * N
+    for n in range(N):
+        re[bitrev(n)] = (x[n] * HANN[n] + 32768) >> 16
+    for s in range(L):
+        half = 1 << s
+        for c in range(N // 2):
+            a = ((c >> s) << (s + 1)) | (c & (half - 1))
+            b = a | half
+            k = (c << (L - 1 - s)) & (N // 2 - 1)
+            t_re = (re[b] * TW_RE[k] - im[b] * TW_IM[k] + 32768) >> 16
+            t_im = (re[b] * TW_IM[k] + im[b] * TW_RE[k] + 32768) >> 16
+            re[a], re[b] = re[a] + t_re, re[a] - t_re
+            im[a], im[b] = im[a] + t_im, im[a] - t_im
+    return re, im
+
+
+def spectrum_model(frames, bands):
+    """Memory map of the features of the window made of the given frames"""
+    edges = [0] + [(bands >> (8 * b)) & 0xFF for b in range(4)]
+    words = []
+    for ch in range(64):
+        re, im = fft_model([f[ch] - 0x8000 for f in frames])
+        p = {k: re[k] ** 2 + im[k] ** 2 for k in range(1, N // 2)}
+        tot = sum(p.values())
+        cum = 0
+        mdf = 0
+        for k in range(1, N // 2):
+            cum += p[k]
+            if 2 * cum >= tot:
+                mdf = k
+                break
+        mnf = ((sum(k * v for k, v in p.items()) << 8) // tot) if tot else 0
+        band = [sum(v for k, v in p.items() if edges[b] < k <= edges[b + 1]) for b in range(4)]
+        words += [mnf, mdf, tot >> (2 * L)] + [v >> (2 * L) for v in band] + [0]
+    return words
+
+
+async def send_frame(dut, samples):
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 2)
+
+
+async def wait_ready(dut):
+    while dut.o_spec_ready.value != 1:
+        await RisingEdge(dut.i_clk)
+
+
+async def read(dut, addr):
+    dut.i_rd_en.value = 1
+    dut.i_rd_addr.value = addr
+    await RisingEdge(dut.i_clk)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    return dut.o_rd_data.value.integer
+
+
+async def read_features(dut):
+    return [await read(dut, a) for a in range(512)]
+
+
+def emg_frame(t):
+    """A tone per channel, at a different bin, over some noise"""
+    return [
+        0x8000 + int(6000 * math.sin(2 * PI * t * (3 + ch) / N)) + random.randint(-800, 800)
+        for ch in range(64)
+    ]
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    bands = (120 << 24) | (60 << 16) | (30 << 8) | 10
+    dut.i_hop.value = 1000
+    dut.i_bands.value = bands
+    dut.i_ctrl.value = 1
+
+    frames = [emg_frame(t) for t in range(N)]
+    for f in frames:
+        await send_frame(dut, f)
+    await wait_ready(dut)
+    await ClockCycles(dut.i_clk, 2)
+
+    assert await read(dut, 512) == 1
+    assert await read(dut, 513) == 0
+    words = await read_features(dut)
+    assert words == spectrum_model(frames, bands)
+
+    # The tone of each channel is its median frequency
+    for ch in range(64):
+        assert words[8 * ch + 1] == 3 + ch
+
+
+@cocotb.test()
+async def overlapping_windows(dut):
+    await init_dut(dut)
+    hop = 64
+    bands = (127 << 24) | (90 << 16) | (40 << 8) | 20
+    dut.i_hop.value = hop
+    dut.i_bands.value = bands
+    dut.i_ctrl.value = 1
+
+    frames = [emg_frame(t) for t in range(N)]
+    for f in frames:
+        await send_frame(dut, f)
+    await wait_ready(dut)
+
+    # The next window shares N - hop frames with the first one
+    for t in range(N, N + hop):
+        frames.append(emg_frame(t))
+        await send_frame(dut, frames[-1])
+    await wait_ready(dut)
+    await ClockCycles(dut.i_clk, 2)
+
+    assert await read(dut, 512) == 2
+    assert await read_features(dut) == spectrum_model(frames[-N:], bands)
+
+
+@cocotb.test()
+async def skipped_windows(dut):
+    await init_dut(dut)
+    dut.i_hop.value = 1
+    dut.i_ctrl.value = 1
+
+    frames = [emg_frame(t) for t in range(N)]
+    for f in frames:
+        await send_frame(dut, f)
+
+    # Due every frame, but the engine is busy with the first window
+    for t in range(N, N + 5):
+        await send_frame(dut, emg_frame(t))
+    await wait_ready(dut)
+    await ClockCycles(dut.i_clk, 2)
+
+    assert await read(dut, 512) == 1
+    assert await read(dut, 513) == 5
+    assert await read_features(dut) == spectrum_model(frames, 0)
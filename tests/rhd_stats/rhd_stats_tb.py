@@ -0,0 +1,142 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_interval.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def stats_model(frames):
+    """Memory map of the statistics of the given frames"""
+    words = []
+    for ch in range(64):
+        x = [f[ch] for f in frames]
+        xs = [v - 0x8000 for v in x]
+        sumsq = sum(v * v for v in xs)
+        words += [
+            (max(x) << 16) | min(x),
+            sum(xs) & 0xFFFFFFFF,
+            sumsq & 0xFFFFFFFF,
+            sumsq >> 32,
+            (x.count(0xFFFF) << 16) | x.count(0),
+            0,
+            0,
+            0,
+        ]
+    return words
+
+
+async def send_frame(dut, samples):
+    """Send one frame, return whether statistics were published"""
+    ready = False
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        for _ in range(4):
+            await RisingEdge(dut.i_clk)
+            ready |= dut.o_stats_ready.value == 1
+    return ready
+
+
+async def read(dut, addr):
+    dut.i_rd_en.value = 1
+    dut.i_rd_addr.value = addr
+    await RisingEdge(dut.i_clk)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    return dut.o_rd_data.value.integer
+
+
+async def read_stats(dut):
+    return [await read(dut, a) for a in range(512)]
+
+
+def random_frame(clip=0.0):
+    """Samples around 0, hitting the rails with probability clip"""
+    frame = []
+    for _ in range(64):
+        if random.random() < clip:
+            frame.append(random.choice([0x0000, 0xFFFF]))
+        else:
+            frame.append(0x8000 + random.randint(-20000, 20000))
+    return frame
+
+
+async def run(dut, interval, n_intervals, clip=0.0):
+    gen = await read(dut, 512)
+    for _ in range(n_intervals):
+        frames = [random_frame(clip) for _ in range(interval)]
+        for k, f in enumerate(frames):
+            assert await send_frame(dut, f) == (k == interval - 1)
+        gen += 1
+        assert await read(dut, 512) == gen
+        assert await read_stats(dut) == stats_model(frames)
+
+
+@cocotb.test()
+async def matches_model(dut):
+    await init_dut(dut)
+    dut.i_interval.value = 5
+    dut.i_ctrl.value = 1
+    await run(dut, 5, 3)
+
+
+@cocotb.test()
+async def rail_hits(dut):
+    await init_dut(dut)
+    dut.i_interval.value = 8
+    dut.i_ctrl.value = 1
+    await run(dut, 8, 2, clip=0.3)
+
+
+@cocotb.test()
+async def every_frame(dut):
+    await init_dut(dut)
+    dut.i_ctrl.value = 1
+    await run(dut, 1, 4)
+
+
+@cocotb.test()
+async def restart(dut):
+    await init_dut(dut)
+    dut.i_interval.value = 4
+    dut.i_ctrl.value = 1
+    await run(dut, 4, 1)
+
+    # Stopped mid-interval, nothing is published
+    await send_frame(dut, random_frame())
+    dut.i_ctrl.value = 0
+    gen = await read(dut, 512)
+    for _ in range(6):
+        assert not await send_frame(dut, random_frame())
+    assert await read(dut, 512) == gen
+
+    # The interval starts over with the new length
+    dut.i_interval.value = 3
+    dut.i_ctrl.value = 1
+    await run(dut, 3, 2)
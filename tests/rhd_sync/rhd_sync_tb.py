@@ -0,0 +1,66 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+from cocotb.utils import get_sim_time
+
+PERIOD = 20000
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl_m.value = (4 << 16) | 10
+    dut.i_ctrl_s.value = (4 << 16) | 10
+    dut.i_frame_period.value = PERIOD
+    dut.i_seq_en_m.value = 0
+    dut.i_seq_en_s.value = 0
+    dut.i_miso.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+@cocotb.test()
+async def slave_follows_master(dut):
+    await init_dut(dut)
+    dut.i_seq_en_s.value = 1
+    await ClockCycles(dut.i_clk, 10)
+    dut.i_seq_en_m.value = 1
+
+    # The slave does not start any frame before the master does
+    await RisingEdge(dut.o_frame_start_m)
+    assert dut.o_frame_cnt_s.value == 0
+
+    offsets = []
+    for _ in range(4):
+        t_m = get_sim_time(units="ns")
+        await RisingEdge(dut.o_frame_start_s)
+        offsets.append(get_sim_time(units="ns") - t_m)
+        assert dut.o_frame_cnt_s.value == dut.o_frame_cnt_m.value
+        await RisingEdge(dut.o_frame_start_m)
+
+    dut._log.info(f"slave frame start offsets: {offsets} ns")
+    # Constant offset, a few clock cycles for the synchronizer
+    assert len(set(offsets)) == 1
+    assert offsets[0] < 10 * 125
+
+    assert dut.o_frame_flags_m.value & 1 == 0
+    assert dut.o_frame_flags_s.value & 1 == 1
+
+
+@cocotb.test()
+async def slave_missed_sync(dut):
+    await init_dut(dut)
+    # Master frames come twice as fast as the slave can sample them
+    dut.i_frame_period.value = 1000
+    dut.i_ctrl_s.value = (4 << 16) | 20
+    dut.i_seq_en_s.value = 1
+    dut.i_seq_en_m.value = 1
+
+    await RisingEdge(dut.o_frame_start_s)
+    await RisingEdge(dut.o_frame_start_s)
+    await ClockCycles(dut.i_clk, 2)
+    assert dut.o_frame_flags_s.value & 2 == 2
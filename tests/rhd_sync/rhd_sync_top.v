@@ -0,0 +1,223 @@
+// Two boards side by side, the slave's frame timer follows the master's sync output
+module rhd_sync_top (
+    input i_rst,
+    input i_clk,
+
+    input [24:0] i_ctrl_m,
+    input [24:0] i_ctrl_s,
+    input [31:0] i_frame_period,
+    input        i_seq_en_m,
+    input        i_seq_en_s,
+    input        i_miso,
+
+    output        o_frame_start_m,
+    output        o_frame_start_s,
+    output [31:0] o_frame_cnt_m,
+    output [31:0] o_frame_cnt_s,
+    output [15:0] o_frame_flags_m,
+    output [15:0] o_frame_flags_s,
+    output        o_sync_out_m,
+    output        o_sync_out_s
+);
+
+    rhd_wrapper master (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+        .i_ctrl(i_ctrl_m),
+        .i_start(1'b0),
+        .i_din(16'b0),
+        .i_miso(i_miso),
+        .i_pat_ctrl(3'b0),
+        .i_seq_en(i_seq_en_m),
+        .i_frame_period(i_frame_period),
+        .i_aux_cmd(48'b0),
+        .i_sync_slave(1'b0),
+        .i_sync_in(1'b0),
+        .o_sync_out(o_sync_out_m),
+        .i_dig_in(8'b0),
+        .i_zc_ctrl(1'b0),
+        .i_zc_cfg(8'b0),
+        .i_zc_phase_inc(16'b0),
+        .i_zc_settle(16'b0),
+        .i_zc_frames(16'b0),
+        .i_zc_rd_en(1'b0),
+        .i_zc_rd_addr(8'b0),
+        .i_scrub_ctrl(2'b0),
+        .i_scrub_period(16'b0),
+        .i_scrub_mask(27'b0),
+        .i_scrub_wr(1'b0),
+        .i_scrub_addr(5'b0),
+        .i_scrub_data(8'b0),
+        .i_settle_ctrl(1'b0),
+        .i_settle_mask(64'b0),
+        .i_settle_margin(16'b0),
+        .i_settle_hits(8'b0),
+        .i_settle_hold(16'b0),
+        .i_settle_reg0(8'b0),
+        .o_frame_start(o_frame_start_m),
+        .o_frame_cnt(o_frame_cnt_m),
+        .o_frame_flags(o_frame_flags_m),
+        .i_cap_ctrl(4'b0),
+        .i_cap_post_frames(16'b0),
+        .i_cap_threshold(16'b0),
+        .i_cap_trig(1'b0),
+        .i_cap_addr(32'b0),
+        .i_snap_rd_en(1'b0),
+        .i_snap_rd_addr(7'b0),
+        .i_decim_ctrl(3'b0),
+        .i_hpf_ctrl(2'b0),
+        .i_hpf_coef(16'b0),
+        .i_notch_ctrl(3'b0),
+        .i_notch_coef_wr(1'b0),
+        .i_notch_coef_addr(5'b0),
+        .i_notch_coef_data(16'b0),
+        .i_feat_ctrl(1'b0),
+        .i_feat_win(4'b0),
+        .i_feat_hop(16'b0),
+        .i_feat_thresh(16'b0),
+        .i_feat_rd_en(1'b0),
+        .i_feat_rd_addr(9'b0),
+        .i_det_ctrl(2'b0),
+        .i_det_mask(64'b0),
+        .i_det_adapt_k(8'b0),
+        .i_det_tau(4'b0),
+        .i_det_pulse_len(16'b0),
+        .i_det_thr_wr(1'b0),
+        .i_det_thr_addr(6'b0),
+        .i_det_thr_data(16'b0),
+        .i_det_evt_addr(10'b0),
+        .i_cal_ctrl(2'b0),
+        .i_cal_coef_wr(1'b0),
+        .i_cal_coef_addr(7'b0),
+        .i_cal_coef_data(16'b0),
+        .i_car_ctrl(1'b0),
+        .i_car_mask(64'b0),
+        .i_spatial_ctrl(2'b0),
+        .i_spatial_coef_wr(1'b0),
+        .i_spatial_coef_addr(12'b0),
+        .i_spatial_coef_data(16'b0),
+        .i_stats_ctrl(1'b0),
+        .i_stats_interval(16'b0),
+        .i_stats_rd_en(1'b0),
+        .i_stats_rd_addr(10'b0),
+        .i_spec_ctrl(1'b0),
+        .i_spec_hop(16'b0),
+        .i_spec_bands(32'b0),
+        .i_spec_rd_en(1'b0),
+        .i_spec_rd_addr(10'b0),
+        .i_rice_ctrl(1'b0),
+        .i_rice_k(4'b0),
+        .i_rice_key_period(16'b0),
+        .i_blk_ctrl(1'b0),
+        .i_prv_ctrl(1'b0),
+        .i_prv_ratio(16'b0),
+        .i_pack_ctrl(3'b0),
+        .i_pack_mask(64'b0),
+        .i_banks_ctrl(2'b0),
+        .i_banks_en(1'b0),
+        .i_banks_addr(32'b0),
+        .i_trace_ctrl(4'b0),
+        .i_trace_addr(10'b0)
+    );
+
+    rhd_wrapper slave (
+        .i_rst(i_rst),
+        .i_clk(i_clk),
+        .i_ctrl(i_ctrl_s),
+        .i_start(1'b0),
+        .i_din(16'b0),
+        .i_miso(i_miso),
+        .i_pat_ctrl(3'b0),
+        .i_seq_en(i_seq_en_s),
+        .i_frame_period(32'b0), // Ignored as a slave
+        .i_aux_cmd(48'b0),
+        .i_sync_slave(1'b1),
+        .i_sync_in(o_sync_out_m),
+        .o_sync_out(o_sync_out_s),
+        .i_dig_in(8'b0),
+        .i_zc_ctrl(1'b0),
+        .i_zc_cfg(8'b0),
+        .i_zc_phase_inc(16'b0),
+        .i_zc_settle(16'b0),
+        .i_zc_frames(16'b0),
+        .i_zc_rd_en(1'b0),
+        .i_zc_rd_addr(8'b0),
+        .i_scrub_ctrl(2'b0),
+        .i_scrub_period(16'b0),
+        .i_scrub_mask(27'b0),
+        .i_scrub_wr(1'b0),
+        .i_scrub_addr(5'b0),
+        .i_scrub_data(8'b0),
+        .i_settle_ctrl(1'b0),
+        .i_settle_mask(64'b0),
+        .i_settle_margin(16'b0),
+        .i_settle_hits(8'b0),
+        .i_settle_hold(16'b0),
+        .i_settle_reg0(8'b0),
+        .o_frame_start(o_frame_start_s),
+        .o_frame_cnt(o_frame_cnt_s),
+        .o_frame_flags(o_frame_flags_s),
+        .i_cap_ctrl(4'b0),
+        .i_cap_post_frames(16'b0),
+        .i_cap_threshold(16'b0),
+        .i_cap_trig(1'b0),
+        .i_cap_addr(32'b0),
+        .i_snap_rd_en(1'b0),
+        .i_snap_rd_addr(7'b0),
+        .i_decim_ctrl(3'b0),
+        .i_hpf_ctrl(2'b0),
+        .i_hpf_coef(16'b0),
+        .i_notch_ctrl(3'b0),
+        .i_notch_coef_wr(1'b0),
+        .i_notch_coef_addr(5'b0),
+        .i_notch_coef_data(16'b0),
+        .i_feat_ctrl(1'b0),
+        .i_feat_win(4'b0),
+        .i_feat_hop(16'b0),
+        .i_feat_thresh(16'b0),
+        .i_feat_rd_en(1'b0),
+        .i_feat_rd_addr(9'b0),
+        .i_det_ctrl(2'b0),
+        .i_det_mask(64'b0),
+        .i_det_adapt_k(8'b0),
+        .i_det_tau(4'b0),
+        .i_det_pulse_len(16'b0),
+        .i_det_thr_wr(1'b0),
+        .i_det_thr_addr(6'b0),
+        .i_det_thr_data(16'b0),
+        .i_det_evt_addr(10'b0),
+        .i_cal_ctrl(2'b0),
+        .i_cal_coef_wr(1'b0),
+        .i_cal_coef_addr(7'b0),
+        .i_cal_coef_data(16'b0),
+        .i_car_ctrl(1'b0),
+        .i_car_mask(64'b0),
+        .i_spatial_ctrl(2'b0),
+        .i_spatial_coef_wr(1'b0),
+        .i_spatial_coef_addr(12'b0),
+        .i_spatial_coef_data(16'b0),
+        .i_stats_ctrl(1'b0),
+        .i_stats_interval(16'b0),
+        .i_stats_rd_en(1'b0),
+        .i_stats_rd_addr(10'b0),
+        .i_spec_ctrl(1'b0),
+        .i_spec_hop(16'b0),
+        .i_spec_bands(32'b0),
+        .i_spec_rd_en(1'b0),
+        .i_spec_rd_addr(10'b0),
+        .i_rice_ctrl(1'b0),
+        .i_rice_k(4'b0),
+        .i_rice_key_period(16'b0),
+        .i_blk_ctrl(1'b0),
+        .i_prv_ctrl(1'b0),
+        .i_prv_ratio(16'b0),
+        .i_pack_ctrl(3'b0),
+        .i_pack_mask(64'b0),
+        .i_banks_ctrl(2'b0),
+        .i_banks_en(1'b0),
+        .i_banks_addr(32'b0),
+        .i_trace_ctrl(4'b0),
+        .i_trace_addr(10'b0)
+    );
+
+endmodule
@@ -0,0 +1,140 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import random
+
+N = 64  # Frames per block
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_sof.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_smp_flags.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+def transpose_model(frames):
+    """Words of the block made of the given frames, the flags being the 65th channel"""
+    words = []
+    for ch in range(65):
+        for i in range(N // 2):
+            words.append((frames[2 * i + 1][ch] << 16) | frames[2 * i][ch])
+    return words
+
+
+async def send_frame(dut, samples):
+    """Send the 64 channels of a frame, with samples[64] as its flags"""
+    dut.i_smp_flags.value = samples[64]
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (samples[ch + 32] << 16) | samples[ch]
+        dut.i_smp_sof.value = ch == 0
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_sof.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 2)
+
+
+async def collect(dut, blocks):
+    """Gather the block stream, checking that it never pauses"""
+    words = []
+    while True:
+        await RisingEdge(dut.i_clk)
+        if dut.o_blk_valid.value == 1:
+            words.append(dut.o_blk_data.value.integer)
+            if dut.o_blk_last.value == 1:
+                assert len(words) == 32 * N + N // 2
+                blocks.append(words)
+                words = []
+        else:
+            assert words == []
+
+
+def random_frames(n):
+    return [[random.randint(0, 0xFFFF) for _ in range(65)] for _ in range(n)]
+
+
+@cocotb.test()
+async def channel_major(dut):
+    await init_dut(dut)
+    blocks = []
+    cocotb.start_soon(collect(dut, blocks))
+    dut.i_ctrl.value = 1
+
+    frames = random_frames(3 * N)
+    for f in frames:
+        await send_frame(dut, f)
+    await ClockCycles(dut.i_clk, 33 * N + 10)
+
+    assert blocks == [transpose_model(frames[b * N:(b + 1) * N]) for b in range(3)]
+
+
+@cocotb.test()
+async def disabled(dut):
+    await init_dut(dut)
+    blocks = []
+    cocotb.start_soon(collect(dut, blocks))
+
+    for f in random_frames(N + 2):
+        await send_frame(dut, f)
+    await ClockCycles(dut.i_clk, 33 * N + 10)
+    assert blocks == []
+
+
+@cocotb.test()
+async def partial_block_dropped(dut):
+    await init_dut(dut)
+    blocks = []
+    cocotb.start_soon(collect(dut, blocks))
+    dut.i_ctrl.value = 1
+
+    for f in random_frames(N // 2):
+        await send_frame(dut, f)
+    dut.i_ctrl.value = 0
+    for f in random_frames(3):
+        await send_frame(dut, f)
+
+    # A new block starts with the first frame once enabled again
+    dut.i_ctrl.value = 1
+    frames = random_frames(N)
+    for f in frames:
+        await send_frame(dut, f)
+    await ClockCycles(dut.i_clk, 33 * N + 10)
+
+    assert blocks == [transpose_model(frames)]
+
+
+@cocotb.test()
+async def one_frame_gap(dut):
+    """Disabled for a single frame, the first frame once enabled again starts the block"""
+    await init_dut(dut)
+    blocks = []
+    cocotb.start_soon(collect(dut, blocks))
+    dut.i_ctrl.value = 1
+
+    for f in random_frames(N // 2 + 1):
+        await send_frame(dut, f)
+    dut.i_ctrl.value = 0
+    await send_frame(dut, random_frames(1)[0])
+
+    dut.i_ctrl.value = 1
+    frames = random_frames(N)
+    for f in frames:
+        await send_frame(dut, f)
+    await ClockCycles(dut.i_clk, 33 * N + 10)
+
+    assert blocks == [transpose_model(frames)]
@@ -2,12 +2,101 @@ import cocotb
 from cocotb.clock import Clock
 import cocotb.triggers
 from cocotb.triggers import Edge, RisingEdge, Timer, FallingEdge, ClockCycles
+from cocotb.utils import get_sim_time
 import random
 
 
 async def init_dut(dut):
     dut.i_rst.value = 0
     dut.i_ctrl.value = (4 << 16) | 10
+    dut.i_start.value = 0
+    dut.i_pat_ctrl.value = 0
+    dut.i_trace_ctrl.value = 0
+    dut.i_trace_addr.value = 0
+    dut.i_seq_en.value = 0
+    dut.i_frame_period.value = 0
+    dut.i_aux_cmd.value = 0
+    dut.i_cap_ctrl.value = 0
+    dut.i_cap_post_frames.value = 0
+    dut.i_cap_threshold.value = 0
+    dut.i_cap_trig.value = 0
+    dut.i_cap_addr.value = 0
+    dut.i_snap_rd_en.value = 0
+    dut.i_snap_rd_addr.value = 0
+    dut.i_sync_slave.value = 0
+    dut.i_sync_in.value = 0
+    dut.i_dig_in.value = 0
+    dut.i_zc_ctrl.value = 0
+    dut.i_zc_cfg.value = 0
+    dut.i_zc_phase_inc.value = 0
+    dut.i_zc_settle.value = 0
+    dut.i_zc_frames.value = 0
+    dut.i_zc_rd_en.value = 0
+    dut.i_zc_rd_addr.value = 0
+    dut.i_scrub_ctrl.value = 0
+    dut.i_scrub_period.value = 0
+    dut.i_scrub_mask.value = 0
+    dut.i_scrub_wr.value = 0
+    dut.i_scrub_addr.value = 0
+    dut.i_scrub_data.value = 0
+    dut.i_settle_ctrl.value = 0
+    dut.i_settle_mask.value = 0
+    dut.i_settle_margin.value = 0
+    dut.i_settle_hits.value = 0
+    dut.i_settle_hold.value = 0
+    dut.i_settle_reg0.value = 0
+    dut.i_decim_ctrl.value = 0
+    dut.i_hpf_ctrl.value = 0
+    dut.i_hpf_coef.value = 0
+    dut.i_notch_ctrl.value = 0
+    dut.i_notch_coef_wr.value = 0
+    dut.i_notch_coef_addr.value = 0
+    dut.i_notch_coef_data.value = 0
+    dut.i_feat_ctrl.value = 0
+    dut.i_feat_win.value = 0
+    dut.i_feat_hop.value = 0
+    dut.i_feat_thresh.value = 0
+    dut.i_feat_rd_en.value = 0
+    dut.i_feat_rd_addr.value = 0
+    dut.i_det_ctrl.value = 0
+    dut.i_det_mask.value = 0
+    dut.i_det_adapt_k.value = 0
+    dut.i_det_tau.value = 0
+    dut.i_det_pulse_len.value = 0
+    dut.i_det_thr_wr.value = 0
+    dut.i_det_thr_addr.value = 0
+    dut.i_det_thr_data.value = 0
+    dut.i_det_evt_addr.value = 0
+    dut.i_cal_ctrl.value = 0
+    dut.i_cal_coef_wr.value = 0
+    dut.i_cal_coef_addr.value = 0
+    dut.i_cal_coef_data.value = 0
+    dut.i_car_ctrl.value = 0
+    dut.i_car_mask.value = 0
+    dut.i_spatial_ctrl.value = 0
+    dut.i_spatial_coef_wr.value = 0
+    dut.i_spatial_coef_addr.value = 0
+    dut.i_spatial_coef_data.value = 0
+    dut.i_stats_ctrl.value = 0
+    dut.i_stats_interval.value = 0
+    dut.i_stats_rd_en.value = 0
+    dut.i_stats_rd_addr.value = 0
+    dut.i_spec_ctrl.value = 0
+    dut.i_spec_hop.value = 0
+    dut.i_spec_bands.value = 0
+    dut.i_spec_rd_en.value = 0
+    dut.i_spec_rd_addr.value = 0
+    dut.i_rice_ctrl.value = 0
+    dut.i_rice_k.value = 0
+    dut.i_rice_key_period.value = 0
+    dut.i_blk_ctrl.value = 0
+    dut.i_prv_ctrl.value = 0
+    dut.i_prv_ratio.value = 0
+    dut.i_pack_ctrl.value = 0
+    dut.i_pack_mask.value = 0
+    dut.i_banks_ctrl.value = 0
+    dut.i_banks_en.value = 0
+    dut.i_banks_addr.value = 0
     clock = Clock(dut.i_clk, 125, units="ns")  # Create a 1us period clock on port clk
     cocotb.start_soon(clock.start(start_high=False))
 
@@ -38,6 +127,16 @@ async def miso_sim(dut, data):
     await RisingEdge(dut.o_done)
 
 
+async def mosi_word(dut):
+    """Capture the next word sent on MOSI"""
+    word = 0
+    await FallingEdge(dut.o_cs)
+    for j in range(16):
+        await RisingEdge(dut.o_sclk)
+        word |= dut.o_mosi.value << (15 - j)
+    return word
+
+
 @cocotb.test()
 async def start(dut):
     await init_dut(dut)
@@ -129,3 +228,243 @@ async def read_spi(dut):
             f"({i}) a: Expected {hex(a)}, rx'd {hex(rx_a)}. b: Expected {hex(b)}, rx'd {hex(rx_b)}"
         )
         assert rx_a == a and rx_b == b
+
+
+@cocotb.test()
+async def trace_transfer(dut):
+    await init_dut(dut)
+
+    # Arm, triggering on the next start
+    dut.i_trace_ctrl.value = 0b1000
+    await RisingEdge(dut.i_clk)
+    dut.i_trace_ctrl.value = 0b1001
+    await RisingEdge(dut.i_clk)
+    assert (dut.o_trace_status.value >> 30) == 1  # armed
+
+    await start_transfer(dut, 0x0000)
+    await RisingEdge(dut.o_done)
+    await ClockCycles(dut.i_clk, 2)
+
+    status = dut.o_trace_status.value.integer
+    n = status & 0x7FF
+    assert (status >> 30) == 2  # running
+    assert n == 6
+
+    events = []
+    stamps = []
+    for i in range(n):
+        dut.i_trace_addr.value = i
+        await ClockCycles(dut.i_clk, 2)
+        entry = dut.o_trace_data.value.integer
+        events.append(entry >> 26)
+        stamps.append(entry & ((1 << 26) - 1))
+
+    dut._log.info(f"events {events}, timestamps {stamps}")
+    # start, CS low, first SCLK, last SCLK, CS high, done
+    assert events == [1 << k for k in range(6)]
+    assert stamps[0] == 0
+    assert all(a < b for a, b in zip(stamps, stamps[1:]))
+
+    # Stop
+    dut.i_trace_ctrl.value = 0b1101
+    await ClockCycles(dut.i_clk, 2)
+    assert (dut.o_trace_status.value >> 30) == 3
+
+
+@cocotb.test()
+async def sequencer_frame(dut):
+    await init_dut(dut)
+    dut.i_miso.value = 1
+
+    aux = [0xE800, 0xE900, 0xFF00]  # READ(40), READ(41), READ(63)
+    dut.i_aux_cmd.value = (aux[2] << 32) | (aux[1] << 16) | aux[0]
+    dut.i_seq_en.value = 1
+
+    # CONVERT(0) to CONVERT(31), then the aux commands
+    words = [await mosi_word(dut) for _ in range(35)]
+    assert words == [c << 8 for c in range(32)] + aux
+
+    # The results of the second frame all come out during that frame
+    samples = []
+    while len(samples) < 32:
+        await RisingEdge(dut.i_clk)
+        if dut.o_smp_valid.value == 1:
+            samples.append(
+                (
+                    dut.o_smp_ch.value.integer,
+                    dut.o_smp_sof.value.integer,
+                    dut.o_smp_eof.value.integer,
+                    dut.o_smp_data.value.integer,
+                )
+            )
+
+    assert [s[0] for s in samples] == list(range(32))
+    assert [s[1] for s in samples] == [1] + [0] * 31
+    assert [s[2] for s in samples] == [0] * 31 + [1]
+    assert all(s[3] == 0xFFFFFFFF for s in samples)
+    assert dut.o_frame_cnt.value == 2
+
+    # Disabling completes the frame, then gives the SPI master back
+    dut.i_seq_en.value = 0
+    await ClockCycles(dut.i_clk, 2000)
+    assert dut.o_frame_cnt.value == 2
+    word = cocotb.start_soon(mosi_word(dut))
+    await start_transfer(dut, 0x1234)
+    assert await word == 0x1234
+
+
+@cocotb.test()
+async def sequencer_frame_period(dut):
+    await init_dut(dut)
+    period = 20000
+    dut.i_frame_period.value = period
+    dut.i_seq_en.value = 1
+
+    await RisingEdge(dut.o_frame_start)
+    t0 = get_sim_time(units="ns")
+    await RisingEdge(dut.o_frame_start)
+    assert get_sim_time(units="ns") - t0 == period * 125
+    assert dut.o_overruns.value == 0
+
+    # Much shorter than a frame
+    dut.i_frame_period.value = 1000
+    await RisingEdge(dut.o_frame_start)
+    await RisingEdge(dut.o_frame_start)
+    assert dut.o_overruns.value > 0
+
+
+@cocotb.test()
+async def digital_inputs(dut):
+    await init_dut(dut)
+    dut.i_dig_in.value = 0xA5
+    await ClockCycles(dut.i_clk, 4)
+    dut.i_seq_en.value = 1
+
+    await RisingEdge(dut.o_frame_start)
+    await RisingEdge(dut.i_clk)
+    dut.i_dig_in.value = 0x3C  # Changes during the frame
+    await RisingEdge(dut.o_smp_eof)
+    assert (dut.o_frame_flags.value >> 8) == 0xA5
+    assert (dut.o_smp_flags.value >> 8) == 0xA5
+
+    await RisingEdge(dut.o_frame_start)
+    await RisingEdge(dut.o_smp_eof)
+    assert (dut.o_frame_flags.value >> 8) == 0x3C
+    assert (dut.o_smp_flags.value >> 8) == 0x3C
+
+
+@cocotb.test()
+async def digital_inputs_delayed(dut):
+    """The flags follow their frame through the common-average reference, which
+    sends it during the next frame"""
+    await init_dut(dut)
+    dut.i_car_ctrl.value = 1
+    dut.i_car_mask.value = (1 << 64) - 1
+    dut.i_dig_in.value = 0xA5
+    await ClockCycles(dut.i_clk, 4)
+    dut.i_seq_en.value = 1
+
+    await RisingEdge(dut.o_frame_start)
+    await RisingEdge(dut.i_clk)
+    dut.i_dig_in.value = 0x3C
+    flags = []
+    for _ in range(2):
+        await RisingEdge(dut.o_smp_eof)
+        flags.append(dut.o_smp_flags.value >> 8)
+    assert flags == [0xA5, 0x3C]
+
+
+async def sclk_halves(dut, halves):
+    """(frame count, clock cycles between SCLK rising and falling edges)"""
+    while True:
+        await RisingEdge(dut.o_sclk)
+        t0 = get_sim_time(units="ns")
+        await FallingEdge(dut.o_sclk)
+        halves.append((dut.o_frame_cnt.value.integer, (get_sim_time(units="ns") - t0) // 125))
+
+
+@cocotb.test()
+async def sequencer_retune(dut):
+    await init_dut(dut)
+    halves = []
+    cocotb.start_soon(sclk_halves(dut, halves))
+    dut.i_seq_en.value = 1
+
+    # Ignored until committed
+    await RisingEdge(dut.o_frame_start)
+    dut.i_ctrl.value = (4 << 16) | 6
+    await RisingEdge(dut.o_frame_start)
+
+    # Committed in the middle of frame 2, applied from frame 3
+    await ClockCycles(dut.i_clk, 2000)
+    dut.i_ctrl.value = (1 << 24) | (4 << 16) | 6
+    await ClockCycles(dut.i_clk, 2)
+    assert dut.o_ctrl_pending.value == 1
+    await RisingEdge(dut.o_frame_start)
+    await RisingEdge(dut.i_clk)
+    assert dut.o_ctrl_pending.value == 0
+    await RisingEdge(dut.o_frame_start)
+
+    assert {h for f, h in halves if f <= 2} == {10}
+    assert {h for f, h in halves if f == 3} == {6}
+
+
+def prbs_step(s):
+    return (s >> 1) ^ (0xB400 if s & 1 else 0)
+
+
+async def collect_samples(dut, n):
+    samples = []
+    while len(samples) < n:
+        await RisingEdge(dut.i_clk)
+        if dut.o_smp_valid.value == 1:
+            samples.append((dut.o_smp_ch.value.integer, dut.o_smp_data.value.integer))
+    return samples
+
+
+@cocotb.test()
+async def pattern_channel(dut):
+    await init_dut(dut)
+    dut.i_pat_ctrl.value = 1 | (3 << 1)
+    dut.i_seq_en.value = 1
+    for ch, data in await collect_samples(dut, 2 * 32):
+        assert data == ((((ch + 32) * 0x101) << 16) | (ch * 0x101))
+
+
+@cocotb.test()
+async def pattern_prbs(dut):
+    await init_dut(dut)
+    dut.i_pat_ctrl.value = 1 | (2 << 1)
+    dut.i_seq_en.value = 1
+    s = 0xACE1
+    for n, (ch, data) in enumerate(await collect_samples(dut, 3 * 32)):
+        assert ch == n % 32
+        a = prbs_step(s)
+        s = prbs_step(a)
+        assert data == (s << 16) | a
+
+
+@cocotb.test()
+async def pattern_ramp(dut):
+    await init_dut(dut)
+    dut.i_pat_ctrl.value = 1 | (1 << 1)
+    dut.i_seq_en.value = 1
+    for n, (ch, data) in enumerate(await collect_samples(dut, 3 * 32)):
+        f = n // 32 + 1
+        assert data == (((f + 1024 * (ch + 32)) & 0xFFFF) << 16) | (f + 1024 * ch)
+
+
+@cocotb.test()
+async def pattern_manual(dut):
+    """The result of a transfer is the one of the command two transfers back"""
+    await init_dut(dut)
+    dut.i_miso.value = 1
+    dut.i_pat_ctrl.value = 1
+    await ClockCycles(dut.i_clk, 2)
+
+    results = []
+    for cmd in [0x0500, 0xE800, 0x0600, 0x0700, 0x0800]:
+        await start_transfer(dut, cmd)
+        await RisingEdge(dut.o_done)
+        results.append(dut.o_dout.value.integer)
+    assert results == [0, 0, 0xFFFF0000, 0, 0xFFFE0001]
@@ -0,0 +1,166 @@
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, ClockCycles
+import math
+import random
+
+SIN = [int(math.floor(127.0 * math.sin(2.0 * math.pi * i / 256) + 0.5)) for i in range(256)]
+
+
+async def init_dut(dut):
+    dut.i_rst.value = 0
+    dut.i_ctrl.value = 0
+    dut.i_cfg.value = 0
+    dut.i_phase_inc.value = 0
+    dut.i_settle.value = 0
+    dut.i_frames.value = 0
+    dut.i_frame_start.value = 0
+    dut.i_smp_valid.value = 0
+    dut.i_smp_ch.value = 0
+    dut.i_smp_data.value = 0
+    dut.i_smp_eof.value = 0
+    dut.i_rd_en.value = 0
+    dut.i_rd_addr.value = 0
+    clock = Clock(dut.i_clk, 125, units="ns")
+    cocotb.start_soon(clock.start(start_high=False))
+
+    for _ in range(2):
+        await RisingEdge(dut.i_clk)
+
+    dut.i_rst.value = 1
+
+
+class Chip:
+    """Impedance test registers of the RHD2164, and the response of the electrodes"""
+
+    def __init__(self, gains):
+        self.gains = gains
+        self.regs = {5: 0, 6: 128, 7: 0}
+
+    def sample(self, e):
+        x = 0x8000 + random.randint(-50, 50)
+        if (self.regs[5] & 1) and e == self.regs[7]:
+            x = 0x8000 + self.gains[e] * (self.regs[6] - 128)
+        return x
+
+    def command(self, cmd):
+        assert cmd >> 14 == 0b10  # WRITE
+        self.regs[(cmd >> 8) & 0x3F] = cmd & 0xFF
+
+
+async def run_frame(dut, chip):
+    """One frame of the sequencer, return the aux commands"""
+    dut.i_frame_start.value = 1
+    await RisingEdge(dut.i_clk)
+    dut.i_frame_start.value = 0
+    await RisingEdge(dut.i_clk)
+    aux = None
+    if dut.o_aux_en.value == 1:
+        c = dut.o_aux_cmd.value.integer
+        aux = [c & 0xFFFF, c >> 16]
+
+    for ch in range(32):
+        dut.i_smp_valid.value = 1
+        dut.i_smp_ch.value = ch
+        dut.i_smp_data.value = (chip.sample(ch + 32) << 16) | chip.sample(ch)
+        dut.i_smp_eof.value = ch == 31
+        await RisingEdge(dut.i_clk)
+        dut.i_smp_valid.value = 0
+        dut.i_smp_eof.value = 0
+        await ClockCycles(dut.i_clk, 3)
+
+    # Aux slots come after the CONVERTs
+    if aux:
+        for c in aux:
+            chip.command(c)
+    await ClockCycles(dut.i_clk, 4)
+    return aux
+
+
+def zcheck_model(gains, inc, settle, frames):
+    """(I, Q) of each electrode"""
+    res = []
+    for e in range(64):
+        i = q = 0
+        for j in range(settle, settle + frames):
+            p = (((e * (settle + frames) + j - 1) * inc) >> 8) & 0xFF
+            x = gains[e] * SIN[p]
+            i += x * SIN[(p + 64) & 0xFF]
+            q += x * SIN[p]
+        res.append((i, q))
+    return res
+
+
+async def read(dut, addr):
+    dut.i_rd_en.value = 1
+    dut.i_rd_addr.value = addr
+    await RisingEdge(dut.i_clk)
+    dut.i_rd_en.value = 0
+    await RisingEdge(dut.i_clk)
+    return dut.o_rd_data.value.integer
+
+
+async def read_result(dut, e):
+    w = [await read(dut, 4 * e + k) for k in range(4)]
+    i = (w[1] << 32) | w[0]
+    q = (w[3] << 32) | w[2]
+    return (i - (1 << 64) if i >> 63 else i, q - (1 << 64) if q >> 63 else q)
+
+
+@cocotb.test()
+async def sweep(dut):
+    await init_dut(dut)
+    inc, settle, frames = 4096, 4, 16  # 16 frames per period
+    gains = [random.randint(1, 100) for _ in range(64)]
+    chip = Chip(gains)
+
+    dut.i_cfg.value = 0x41
+    dut.i_phase_inc.value = inc
+    dut.i_settle.value = settle
+    dut.i_frames.value = frames
+    dut.i_ctrl.value = 1
+    await RisingEdge(dut.i_clk)
+    assert await run_frame(dut, chip) is not None
+    assert dut.o_status.value >> 30 == 0b10
+
+    k = 1
+    while dut.o_status.value >> 31:
+        aux = await run_frame(dut, chip)
+        assert aux[0] == 0x8600 | (128 + SIN[((k * inc) >> 8) & 0xFF]) & 0xFF
+        k += 1
+    assert k == 64 * (settle + frames)
+    assert dut.o_status.value >> 30 == 0b01
+
+    # Zcheck turned off
+    assert await run_frame(dut, chip) == [0x8680, 0x8540]
+    assert await run_frame(dut, chip) == [0x8680, 0x8540]
+    assert await run_frame(dut, chip) is None
+
+    expected = zcheck_model(gains, inc, settle, frames)
+    for e in range(64):
+        i, q = await read_result(dut, e)
+        assert (i, q) == expected[e]
+        amp = 2 * math.sqrt(i * i + q * q) / (127 * frames)
+        assert abs(amp - gains[e] * 127) < gains[e] * 2
+
+
+@cocotb.test()
+async def abort(dut):
+    await init_dut(dut)
+    chip = Chip([10] * 64)
+    dut.i_cfg.value = 0x41
+    dut.i_phase_inc.value = 4096
+    dut.i_settle.value = 2
+    dut.i_frames.value = 2
+    dut.i_ctrl.value = 1
+    for _ in range(10):
+        await run_frame(dut, chip)
+    assert dut.o_status.value.integer == (1 << 31) | 2
+
+    dut.i_ctrl.value = 0
+    await ClockCycles(dut.i_clk, 2)
+    assert dut.o_status.value >> 30 == 0
+    assert await run_frame(dut, chip) == [0x8680, 0x8540]
+    assert await run_frame(dut, chip) == [0x8680, 0x8540]
+    assert await run_frame(dut, chip) is None
+    assert chip.regs[5] == 0x40
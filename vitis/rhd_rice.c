@@ -0,0 +1,116 @@
+#include "rhd_rice.h"
+
+typedef struct {
+    const uint32_t *words;
+    size_t n_words;
+    size_t pos; // Bit position, MSB of words[0] first
+} bit_reader_t;
+
+static int read_bit(bit_reader_t *br, uint32_t *bit)
+{
+    size_t w = br->pos >> 5;
+    if (w >= br->n_words) {
+        return -1;
+    }
+    *bit = (br->words[w] >> (31 - (br->pos & 31))) & 1;
+    br->pos++;
+    return 0;
+}
+
+static int read_bits(bit_reader_t *br, unsigned n, uint32_t *value)
+{
+    uint32_t bit;
+    *value = 0;
+    while (n--) {
+        if (read_bit(br, &bit)) {
+            return -1;
+        }
+        *value = (*value << 1) | bit;
+    }
+    return 0;
+}
+
+// Rice code of parameter k, with the 16 ones escape
+static int read_code(bit_reader_t *br, unsigned k, uint16_t *u)
+{
+    uint32_t q = 0;
+    uint32_t bit = 1;
+    uint32_t low;
+
+    while (q < 16) {
+        if (read_bit(br, &bit)) {
+            return -1;
+        }
+        if (!bit) {
+            break;
+        }
+        q++;
+    }
+    if (q == 16) {
+        if (read_bits(br, 16, &low)) {
+            return -1;
+        }
+        *u = (uint16_t)low;
+        return 0;
+    }
+    if (read_bits(br, k, &low)) {
+        return -1;
+    }
+    *u = (uint16_t)((q << k) | low);
+    return 0;
+}
+
+void rhd_rice_init(rhd_rice_state_t *state)
+{
+    for (int ch = 0; ch < RHD_RICE_CHANNELS; ch++) {
+        state->prev[ch] = 0;
+    }
+    state->synced = 0;
+}
+
+int rhd_rice_decode_frame(rhd_rice_state_t *state, const uint32_t *words, size_t n_words,
+                          rhd_rice_frame_t *out)
+{
+    if (n_words == 0 || (words[0] >> 24) != RHD_RICE_MAGIC) {
+        return -1;
+    }
+
+    unsigned k = (words[0] >> 17) & 0xF;
+    out->key = (words[0] >> 16) & 1;
+    out->frame = words[0] & 0xFFFF;
+    if (out->key) {
+        state->synced = 1;
+    }
+    out->valid = state->synced;
+
+    bit_reader_t br = {words, n_words, 32};
+
+    uint32_t flags;
+    if (read_bits(&br, 16, &flags)) {
+        return -2;
+    }
+    out->flags = (uint16_t)flags;
+
+    // Channels come in stream order, 0, 32, 1, 33, ...
+    for (int i = 0; i < RHD_RICE_CHANNELS; i++) {
+        int ch = (i >> 1) + (i & 1) * (RHD_RICE_CHANNELS / 2);
+        uint32_t x;
+        if (out->key) {
+            if (read_bits(&br, 16, &x)) {
+                return -2;
+            }
+        } else {
+            uint16_t u;
+            if (read_code(&br, k, &u)) {
+                return -2;
+            }
+            uint16_t d = (uint16_t)((u >> 1) ^ (uint16_t)(0 - (u & 1)));
+            x = (uint16_t)(state->prev[ch] + d);
+        }
+        state->prev[ch] = (uint16_t)x;
+        out->samples[ch] = (uint16_t)x;
+    }
+
+    // The frame ends on a word boundary
+    return (int)((br.pos + 31) >> 5);
+}
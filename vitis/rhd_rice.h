@@ -0,0 +1,42 @@
+#ifndef RHD_RICE_H
+#define RHD_RICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ Decoder of the compressed stream of hdl/rhd_rice.v.
+
+ The state holds the previous sample of each channel. Call rhd_rice_init once,
+ then rhd_rice_decode_frame on each frame in order. Decoding can start at any
+ frame: the samples are valid from the first key frame on.
+*/
+
+#define RHD_RICE_CHANNELS 64
+#define RHD_RICE_MAGIC 0xA5
+
+typedef struct {
+    uint16_t prev[RHD_RICE_CHANNELS];
+    int synced; // A key frame has been decoded
+} rhd_rice_state_t;
+
+typedef struct {
+    uint16_t frame; // Frame counter of the header
+    uint16_t flags; // Frame flags, digital inputs in [15:8]
+    int key;
+    int valid;      // 0 until the first key frame
+    uint16_t samples[RHD_RICE_CHANNELS]; // Offset binary, by channel
+} rhd_rice_frame_t;
+
+void rhd_rice_init(rhd_rice_state_t *state);
+
+/*
+ Decodes the frame starting at words[0].
+
+ Returns the number of words of the frame, -1 if words[0] is not a frame
+ header or -2 if the frame runs past n_words.
+*/
+int rhd_rice_decode_frame(rhd_rice_state_t *state, const uint32_t *words, size_t n_words,
+                          rhd_rice_frame_t *out);
+
+#endif // RHD_RICE_H
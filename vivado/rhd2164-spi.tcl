@@ -40,7 +40,7 @@ if { [string first $scripts_vivado_version $current_vivado_version] == -1 } {
 
 # The design that will be created by this Tcl script contains the following 
 # module references:
-# rhd_wrapper
+# rhd_regs, rhd_wrapper
 
 # Please add the sources of those modules before sourcing this Tcl script.
 
@@ -131,9 +131,14 @@ set bCheckIPsPassed 1
 set bCheckIPs 1
 if { $bCheckIPs == 1 } {
    set list_check_ips "\ 
+xilinx.com:ip:axi_bram_ctrl:4.1\
+xilinx.com:ip:axi_dma:7.1\
 xilinx.com:ip:axi_gpio:2.0\
+xilinx.com:ip:axi_interconnect:2.1\
+xilinx.com:ip:axis_data_fifo:2.0\
 xilinx.com:ip:processing_system7:5.5\
 xilinx.com:ip:proc_sys_reset:5.0\
+xilinx.com:ip:xlconcat:2.1\
 "
 
    set list_ips_missing ""
@@ -159,6 +164,7 @@ xilinx.com:ip:proc_sys_reset:5.0\
 set bCheckModules 1
 if { $bCheckModules == 1 } {
    set list_check_mods "\ 
+rhd_regs\
 rhd_wrapper\
 "
 
@@ -228,21 +234,84 @@ proc create_root_design { parentCell } {
 
 
   # Create ports
+  set i_cap_trig [ create_bd_port -dir I i_cap_trig ]
   set i_miso [ create_bd_port -dir I i_miso ]
+  set i_dig_in [ create_bd_port -dir I -from 7 -to 0 i_dig_in ]
+  set i_sync_in [ create_bd_port -dir I i_sync_in ]
   set o_cs [ create_bd_port -dir O o_cs ]
+  set o_detect [ create_bd_port -dir O o_detect ]
   set o_mosi [ create_bd_port -dir O o_mosi ]
   set o_sclk [ create_bd_port -dir O o_sclk ]
+  set o_sync_out [ create_bd_port -dir O o_sync_out ]
+
+  # Create instance: axi_bram_ctrl_banks, and set properties
+  set axi_bram_ctrl_banks [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_bram_ctrl:4.1 axi_bram_ctrl_banks ]
+  set_property -dict [ list \
+   CONFIG.DATA_WIDTH {32} \
+   CONFIG.SINGLE_PORT_BRAM {1} \
+ ] $axi_bram_ctrl_banks
+
+  # Create instance: axi_bram_ctrl_cap, and set properties
+  set axi_bram_ctrl_cap [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_bram_ctrl:4.1 axi_bram_ctrl_cap ]
+  set_property -dict [ list \
+   CONFIG.DATA_WIDTH {32} \
+   CONFIG.SINGLE_PORT_BRAM {1} \
+ ] $axi_bram_ctrl_cap
+
+  # Create instance: axi_dma_beat, and set properties
+  set axi_dma_beat [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_dma:7.1 axi_dma_beat ]
+  set_property -dict [ list \
+   CONFIG.c_include_mm2s {0} \
+   CONFIG.c_include_sg {0} \
+   CONFIG.c_m_axi_s2mm_data_width {64} \
+   CONFIG.c_s_axis_s2mm_tdata_width {64} \
+   CONFIG.c_sg_length_width {26} \
+ ] $axi_dma_beat
+
+  # Create instance: axi_dma_blk, and set properties
+  set axi_dma_blk [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_dma:7.1 axi_dma_blk ]
+  set_property -dict [ list \
+   CONFIG.c_include_mm2s {0} \
+   CONFIG.c_include_sg {0} \
+   CONFIG.c_sg_length_width {26} \
+ ] $axi_dma_blk
+
+  # Create instance: axi_dma_cmp, and set properties
+  set axi_dma_cmp [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_dma:7.1 axi_dma_cmp ]
+  set_property -dict [ list \
+   CONFIG.c_include_mm2s {0} \
+   CONFIG.c_include_sg {0} \
+   CONFIG.c_sg_length_width {26} \
+ ] $axi_dma_cmp
+
+  # Create instance: axi_dma_prv, and set properties
+  set axi_dma_prv [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_dma:7.1 axi_dma_prv ]
+  set_property -dict [ list \
+   CONFIG.c_include_mm2s {0} \
+   CONFIG.c_include_sg {0} \
+   CONFIG.c_sg_length_width {26} \
+ ] $axi_dma_prv
+
+  # Create instance: axi_gpio_banks, and set properties
+  set axi_gpio_banks [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_banks ]
+  set_property -dict [ list \
+   CONFIG.C_ALL_INPUTS_2 {1} \
+   CONFIG.C_ALL_OUTPUTS {1} \
+   CONFIG.C_GPIO2_WIDTH {32} \
+   CONFIG.C_GPIO_WIDTH {2} \
+   CONFIG.C_IS_DUAL {1} \
+ ] $axi_gpio_banks
 
   # Create instance: axi_gpio_cfg, and set properties
   set axi_gpio_cfg [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_cfg ]
   set_property -dict [ list \
    CONFIG.C_ALL_INPUTS {0} \
-   CONFIG.C_ALL_INPUTS_2 {0} \
+   CONFIG.C_ALL_INPUTS_2 {1} \
    CONFIG.C_ALL_OUTPUTS {1} \
    CONFIG.C_ALL_OUTPUTS_2 {0} \
-   CONFIG.C_GPIO2_WIDTH {32} \
-   CONFIG.C_GPIO_WIDTH {24} \
-   CONFIG.C_IS_DUAL {0} \
+   CONFIG.C_GPIO2_WIDTH {1} \
+   CONFIG.C_GPIO_WIDTH {25} \
+   CONFIG.C_IS_DUAL {1} \
  ] $axi_gpio_cfg
 
   # Create instance: axi_gpio_ctrl, and set properties
@@ -266,6 +335,57 @@ proc create_root_design { parentCell } {
    CONFIG.C_IS_DUAL {1} \
  ] $axi_gpio_data
 
+  # Create instance: axi_gpio_trace, and set properties
+  set axi_gpio_trace [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_trace ]
+  set_property -dict [ list \
+   CONFIG.C_ALL_INPUTS_2 {1} \
+   CONFIG.C_ALL_OUTPUTS {1} \
+   CONFIG.C_GPIO2_WIDTH {32} \
+   CONFIG.C_GPIO_WIDTH {4} \
+   CONFIG.C_IS_DUAL {1} \
+ ] $axi_gpio_trace
+
+  # Create instance: axi_gpio_trace_data, and set properties
+  set axi_gpio_trace_data [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_trace_data ]
+  set_property -dict [ list \
+   CONFIG.C_ALL_INPUTS_2 {1} \
+   CONFIG.C_ALL_OUTPUTS {1} \
+   CONFIG.C_GPIO2_WIDTH {32} \
+   CONFIG.C_GPIO_WIDTH {10} \
+   CONFIG.C_IS_DUAL {1} \
+ ] $axi_gpio_trace_data
+
+  # Create instance: axi_mem_intercon, and set properties
+  set axi_mem_intercon [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_interconnect:2.1 axi_mem_intercon ]
+  set_property -dict [ list \
+   CONFIG.NUM_MI {1} \
+   CONFIG.NUM_SI {4} \
+ ] $axi_mem_intercon
+
+  # Create instance: axis_data_fifo_beat, and set properties
+  set axis_data_fifo_beat [ create_bd_cell -type ip -vlnv xilinx.com:ip:axis_data_fifo:2.0 axis_data_fifo_beat ]
+  set_property -dict [ list \
+   CONFIG.FIFO_DEPTH {4096} \
+ ] $axis_data_fifo_beat
+
+  # Create instance: axis_data_fifo_blk, and set properties
+  set axis_data_fifo_blk [ create_bd_cell -type ip -vlnv xilinx.com:ip:axis_data_fifo:2.0 axis_data_fifo_blk ]
+  set_property -dict [ list \
+   CONFIG.FIFO_DEPTH {4096} \
+ ] $axis_data_fifo_blk
+
+  # Create instance: axis_data_fifo_cmp, and set properties
+  set axis_data_fifo_cmp [ create_bd_cell -type ip -vlnv xilinx.com:ip:axis_data_fifo:2.0 axis_data_fifo_cmp ]
+  set_property -dict [ list \
+   CONFIG.FIFO_DEPTH {4096} \
+ ] $axis_data_fifo_cmp
+
+  # Create instance: axis_data_fifo_prv, and set properties
+  set axis_data_fifo_prv [ create_bd_cell -type ip -vlnv xilinx.com:ip:axis_data_fifo:2.0 axis_data_fifo_prv ]
+  set_property -dict [ list \
+   CONFIG.FIFO_DEPTH {4096} \
+ ] $axis_data_fifo_prv
+
   # Create instance: processing_system7_0, and set properties
   set processing_system7_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:processing_system7:5.5 processing_system7_0 ]
   set_property -dict [ list \
@@ -374,6 +494,7 @@ proc create_root_design { parentCell } {
    CONFIG.PCW_I2C_RESET_ENABLE {1} \
    CONFIG.PCW_IOPLL_CTRL_FBDIV {30} \
    CONFIG.PCW_IO_IO_PLL_FREQMHZ {1000.000} \
+   CONFIG.PCW_IRQ_F2P_INTR {1} \
    CONFIG.PCW_IRQ_F2P_MODE {DIRECT} \
    CONFIG.PCW_MIO_0_DIRECTION {inout} \
    CONFIG.PCW_MIO_0_IOTYPE {LVCMOS 3.3V} \
@@ -749,15 +870,28 @@ gpio[0]#qspi0_ss_b#qspi0_io[0]#qspi0_io[1]#qspi0_io[2]#qspi0_io[3]/HOLD_B#qspi0_
    CONFIG.PCW_USB_RESET_SELECT {Share reset pin} \
    CONFIG.PCW_USE_AXI_NONSECURE {0} \
    CONFIG.PCW_USE_CROSS_TRIGGER {0} \
+   CONFIG.PCW_USE_FABRIC_INTERRUPT {1} \
    CONFIG.PCW_USE_M_AXI_GP0 {1} \
+   CONFIG.PCW_USE_S_AXI_HP0 {1} \
  ] $processing_system7_0
 
   # Create instance: ps7_0_axi_periph, and set properties
   set ps7_0_axi_periph [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_interconnect:2.1 ps7_0_axi_periph ]
   set_property -dict [ list \
-   CONFIG.NUM_MI {3} \
+   CONFIG.NUM_MI {13} \
  ] $ps7_0_axi_periph
 
+  # Create instance: rhd_regs_0, and set properties
+  set block_name rhd_regs
+  set block_cell_name rhd_regs_0
+  if { [catch {set rhd_regs_0 [create_bd_cell -type module -reference $block_name $block_cell_name] } errmsg] } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2095 -severity "ERROR" "Unable to add referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   } elseif { $rhd_regs_0 eq "" } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2096 -severity "ERROR" "Unable to referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   }
+  
   # Create instance: rhd_wrapper_0, and set properties
   set block_name rhd_wrapper
   set block_cell_name rhd_wrapper_0
@@ -772,32 +906,197 @@ gpio[0]#qspi0_ss_b#qspi0_io[0]#qspi0_io[1]#qspi0_io[2]#qspi0_io[3]/HOLD_B#qspi0_
   # Create instance: rst_ps7_0_50M, and set properties
   set rst_ps7_0_50M [ create_bd_cell -type ip -vlnv xilinx.com:ip:proc_sys_reset:5.0 rst_ps7_0_50M ]
 
+  # Create instance: xlconcat_irq, and set properties
+  set xlconcat_irq [ create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 xlconcat_irq ]
+  set_property -dict [ list \
+   CONFIG.NUM_PORTS {6} \
+ ] $xlconcat_irq
+
   # Create interface connections
+  connect_bd_intf_net -intf_net axi_bram_ctrl_banks_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_banks/BRAM_PORTA] [get_bd_intf_pins rhd_wrapper_0/BANKS_BRAM]
+  connect_bd_intf_net -intf_net axi_bram_ctrl_cap_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_cap/BRAM_PORTA] [get_bd_intf_pins rhd_wrapper_0/CAPTURE_BRAM]
+  connect_bd_intf_net -intf_net axi_dma_beat_M_AXI_S2MM [get_bd_intf_pins axi_dma_beat/M_AXI_S2MM] [get_bd_intf_pins axi_mem_intercon/S03_AXI]
+  connect_bd_intf_net -intf_net axi_dma_blk_M_AXI_S2MM [get_bd_intf_pins axi_dma_blk/M_AXI_S2MM] [get_bd_intf_pins axi_mem_intercon/S01_AXI]
+  connect_bd_intf_net -intf_net axi_dma_cmp_M_AXI_S2MM [get_bd_intf_pins axi_dma_cmp/M_AXI_S2MM] [get_bd_intf_pins axi_mem_intercon/S00_AXI]
+  connect_bd_intf_net -intf_net axi_dma_prv_M_AXI_S2MM [get_bd_intf_pins axi_dma_prv/M_AXI_S2MM] [get_bd_intf_pins axi_mem_intercon/S02_AXI]
+  connect_bd_intf_net -intf_net axi_mem_intercon_M00_AXI [get_bd_intf_pins axi_mem_intercon/M00_AXI] [get_bd_intf_pins processing_system7_0/S_AXI_HP0]
+  connect_bd_intf_net -intf_net axis_data_fifo_beat_M_AXIS [get_bd_intf_pins axi_dma_beat/S_AXIS_S2MM] [get_bd_intf_pins axis_data_fifo_beat/M_AXIS]
+  connect_bd_intf_net -intf_net axis_data_fifo_blk_M_AXIS [get_bd_intf_pins axi_dma_blk/S_AXIS_S2MM] [get_bd_intf_pins axis_data_fifo_blk/M_AXIS]
+  connect_bd_intf_net -intf_net axis_data_fifo_cmp_M_AXIS [get_bd_intf_pins axi_dma_cmp/S_AXIS_S2MM] [get_bd_intf_pins axis_data_fifo_cmp/M_AXIS]
+  connect_bd_intf_net -intf_net axis_data_fifo_prv_M_AXIS [get_bd_intf_pins axi_dma_prv/S_AXIS_S2MM] [get_bd_intf_pins axis_data_fifo_prv/M_AXIS]
   connect_bd_intf_net -intf_net processing_system7_0_DDR [get_bd_intf_ports DDR] [get_bd_intf_pins processing_system7_0/DDR]
   connect_bd_intf_net -intf_net processing_system7_0_FIXED_IO [get_bd_intf_ports FIXED_IO] [get_bd_intf_pins processing_system7_0/FIXED_IO]
   connect_bd_intf_net -intf_net processing_system7_0_M_AXI_GP0 [get_bd_intf_pins processing_system7_0/M_AXI_GP0] [get_bd_intf_pins ps7_0_axi_periph/S00_AXI]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M00_AXI [get_bd_intf_pins axi_gpio_cfg/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M00_AXI]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M01_AXI [get_bd_intf_pins axi_gpio_ctrl/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M01_AXI]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M02_AXI [get_bd_intf_pins axi_gpio_data/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M02_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M03_AXI [get_bd_intf_pins axi_gpio_banks/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M03_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M04_AXI [get_bd_intf_pins axi_bram_ctrl_banks/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M04_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M05_AXI [get_bd_intf_pins axi_gpio_trace/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M05_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M06_AXI [get_bd_intf_pins axi_gpio_trace_data/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M06_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M07_AXI [get_bd_intf_pins ps7_0_axi_periph/M07_AXI] [get_bd_intf_pins rhd_regs_0/S_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M08_AXI [get_bd_intf_pins axi_bram_ctrl_cap/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M08_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M09_AXI [get_bd_intf_pins axi_dma_cmp/S_AXI_LITE] [get_bd_intf_pins ps7_0_axi_periph/M09_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M10_AXI [get_bd_intf_pins axi_dma_blk/S_AXI_LITE] [get_bd_intf_pins ps7_0_axi_periph/M10_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M11_AXI [get_bd_intf_pins axi_dma_prv/S_AXI_LITE] [get_bd_intf_pins ps7_0_axi_periph/M11_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M12_AXI [get_bd_intf_pins axi_dma_beat/S_AXI_LITE] [get_bd_intf_pins ps7_0_axi_periph/M12_AXI]
+  connect_bd_intf_net -intf_net rhd_wrapper_0_BEAT_AXIS [get_bd_intf_pins axis_data_fifo_beat/S_AXIS] [get_bd_intf_pins rhd_wrapper_0/BEAT_AXIS]
+  connect_bd_intf_net -intf_net rhd_wrapper_0_BLK_AXIS [get_bd_intf_pins axis_data_fifo_blk/S_AXIS] [get_bd_intf_pins rhd_wrapper_0/BLK_AXIS]
+  connect_bd_intf_net -intf_net rhd_wrapper_0_CMP_AXIS [get_bd_intf_pins axis_data_fifo_cmp/S_AXIS] [get_bd_intf_pins rhd_wrapper_0/CMP_AXIS]
+  connect_bd_intf_net -intf_net rhd_wrapper_0_PRV_AXIS [get_bd_intf_pins axis_data_fifo_prv/S_AXIS] [get_bd_intf_pins rhd_wrapper_0/PRV_AXIS]
 
   # Create port connections
+  connect_bd_net -net axi_dma_beat_s2mm_introut [get_bd_pins axi_dma_beat/s2mm_introut] [get_bd_pins xlconcat_irq/In5]
+  connect_bd_net -net axi_dma_blk_s2mm_introut [get_bd_pins axi_dma_blk/s2mm_introut] [get_bd_pins xlconcat_irq/In3]
+  connect_bd_net -net axi_dma_cmp_s2mm_introut [get_bd_pins axi_dma_cmp/s2mm_introut] [get_bd_pins xlconcat_irq/In2]
+  connect_bd_net -net axi_dma_prv_s2mm_introut [get_bd_pins axi_dma_prv/s2mm_introut] [get_bd_pins xlconcat_irq/In4]
   connect_bd_net -net axi_gpio_0_gpio_io_o [get_bd_pins axi_gpio_cfg/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_ctrl]
   connect_bd_net -net axi_gpio_1_gpio_io_o [get_bd_pins axi_gpio_ctrl/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_start]
   connect_bd_net -net axi_gpio_2_gpio_io_o [get_bd_pins axi_gpio_data/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_din]
+  connect_bd_net -net axi_gpio_banks_gpio_io_o [get_bd_pins axi_gpio_banks/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_banks_ctrl]
+  connect_bd_net -net axi_gpio_trace_gpio_io_o [get_bd_pins axi_gpio_trace/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_trace_ctrl]
+  connect_bd_net -net axi_gpio_trace_data_gpio_io_o [get_bd_pins axi_gpio_trace_data/gpio_io_o] [get_bd_pins rhd_wrapper_0/i_trace_addr]
+  connect_bd_net -net i_cap_trig_1 [get_bd_ports i_cap_trig] [get_bd_pins rhd_wrapper_0/i_cap_trig]
+  connect_bd_net -net i_dig_in_1 [get_bd_ports i_dig_in] [get_bd_pins rhd_wrapper_0/i_dig_in]
   connect_bd_net -net i_miso_1 [get_bd_ports i_miso] [get_bd_pins rhd_wrapper_0/i_miso]
-  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins axi_gpio_cfg/s_axi_aclk] [get_bd_pins axi_gpio_ctrl/s_axi_aclk] [get_bd_pins axi_gpio_data/s_axi_aclk] [get_bd_pins processing_system7_0/FCLK_CLK0] [get_bd_pins processing_system7_0/M_AXI_GP0_ACLK] [get_bd_pins ps7_0_axi_periph/ACLK] [get_bd_pins ps7_0_axi_periph/M00_ACLK] [get_bd_pins ps7_0_axi_periph/M01_ACLK] [get_bd_pins ps7_0_axi_periph/M02_ACLK] [get_bd_pins ps7_0_axi_periph/S00_ACLK] [get_bd_pins rhd_wrapper_0/i_clk] [get_bd_pins rst_ps7_0_50M/slowest_sync_clk]
+  connect_bd_net -net i_sync_in_1 [get_bd_ports i_sync_in] [get_bd_pins rhd_wrapper_0/i_sync_in]
+  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins axi_bram_ctrl_banks/s_axi_aclk] [get_bd_pins axi_bram_ctrl_cap/s_axi_aclk] [get_bd_pins axi_dma_beat/m_axi_s2mm_aclk] [get_bd_pins axi_dma_beat/s_axi_lite_aclk] [get_bd_pins axi_dma_blk/m_axi_s2mm_aclk] [get_bd_pins axi_dma_blk/s_axi_lite_aclk] [get_bd_pins axi_dma_cmp/m_axi_s2mm_aclk] [get_bd_pins axi_dma_cmp/s_axi_lite_aclk] [get_bd_pins axi_dma_prv/m_axi_s2mm_aclk] [get_bd_pins axi_dma_prv/s_axi_lite_aclk] [get_bd_pins axi_gpio_banks/s_axi_aclk] [get_bd_pins axi_gpio_cfg/s_axi_aclk] [get_bd_pins axi_gpio_ctrl/s_axi_aclk] [get_bd_pins axi_gpio_data/s_axi_aclk] [get_bd_pins axi_gpio_trace/s_axi_aclk] [get_bd_pins axi_gpio_trace_data/s_axi_aclk] [get_bd_pins axi_mem_intercon/ACLK] [get_bd_pins axi_mem_intercon/M00_ACLK] [get_bd_pins axi_mem_intercon/S00_ACLK] [get_bd_pins axi_mem_intercon/S01_ACLK] [get_bd_pins axi_mem_intercon/S02_ACLK] [get_bd_pins axi_mem_intercon/S03_ACLK] [get_bd_pins axis_data_fifo_beat/s_axis_aclk] [get_bd_pins axis_data_fifo_blk/s_axis_aclk] [get_bd_pins axis_data_fifo_cmp/s_axis_aclk] [get_bd_pins axis_data_fifo_prv/s_axis_aclk] [get_bd_pins processing_system7_0/FCLK_CLK0] [get_bd_pins processing_system7_0/M_AXI_GP0_ACLK] [get_bd_pins processing_system7_0/S_AXI_HP0_ACLK] [get_bd_pins ps7_0_axi_periph/ACLK] [get_bd_pins ps7_0_axi_periph/M00_ACLK] [get_bd_pins ps7_0_axi_periph/M01_ACLK] [get_bd_pins ps7_0_axi_periph/M02_ACLK] [get_bd_pins ps7_0_axi_periph/M03_ACLK] [get_bd_pins ps7_0_axi_periph/M04_ACLK] [get_bd_pins ps7_0_axi_periph/M05_ACLK] [get_bd_pins ps7_0_axi_periph/M06_ACLK] [get_bd_pins ps7_0_axi_periph/M07_ACLK] [get_bd_pins ps7_0_axi_periph/M08_ACLK] [get_bd_pins ps7_0_axi_periph/M09_ACLK] [get_bd_pins ps7_0_axi_periph/M10_ACLK] [get_bd_pins ps7_0_axi_periph/M11_ACLK] [get_bd_pins ps7_0_axi_periph/M12_ACLK] [get_bd_pins ps7_0_axi_periph/S00_ACLK] [get_bd_pins rhd_regs_0/i_clk] [get_bd_pins rhd_wrapper_0/i_clk] [get_bd_pins rst_ps7_0_50M/slowest_sync_clk]
   connect_bd_net -net processing_system7_0_FCLK_RESET0_N [get_bd_pins processing_system7_0/FCLK_RESET0_N] [get_bd_pins rst_ps7_0_50M/ext_reset_in]
+  connect_bd_net -net rhd_regs_0_o_aux_cmd [get_bd_pins rhd_regs_0/o_aux_cmd] [get_bd_pins rhd_wrapper_0/i_aux_cmd]
+  connect_bd_net -net rhd_regs_0_o_blk_ctrl [get_bd_pins rhd_regs_0/o_blk_ctrl] [get_bd_pins rhd_wrapper_0/i_blk_ctrl]
+  connect_bd_net -net rhd_regs_0_o_cal_coef_addr [get_bd_pins rhd_regs_0/o_cal_coef_addr] [get_bd_pins rhd_wrapper_0/i_cal_coef_addr]
+  connect_bd_net -net rhd_regs_0_o_cal_coef_data [get_bd_pins rhd_regs_0/o_cal_coef_data] [get_bd_pins rhd_wrapper_0/i_cal_coef_data]
+  connect_bd_net -net rhd_regs_0_o_cal_coef_wr [get_bd_pins rhd_regs_0/o_cal_coef_wr] [get_bd_pins rhd_wrapper_0/i_cal_coef_wr]
+  connect_bd_net -net rhd_regs_0_o_cal_ctrl [get_bd_pins rhd_regs_0/o_cal_ctrl] [get_bd_pins rhd_wrapper_0/i_cal_ctrl]
+  connect_bd_net -net rhd_regs_0_o_cap_ctrl [get_bd_pins rhd_regs_0/o_cap_ctrl] [get_bd_pins rhd_wrapper_0/i_cap_ctrl]
+  connect_bd_net -net rhd_regs_0_o_cap_post_frames [get_bd_pins rhd_regs_0/o_cap_post_frames] [get_bd_pins rhd_wrapper_0/i_cap_post_frames]
+  connect_bd_net -net rhd_regs_0_o_cap_threshold [get_bd_pins rhd_regs_0/o_cap_threshold] [get_bd_pins rhd_wrapper_0/i_cap_threshold]
+  connect_bd_net -net rhd_regs_0_o_car_ctrl [get_bd_pins rhd_regs_0/o_car_ctrl] [get_bd_pins rhd_wrapper_0/i_car_ctrl]
+  connect_bd_net -net rhd_regs_0_o_car_mask [get_bd_pins rhd_regs_0/o_car_mask] [get_bd_pins rhd_wrapper_0/i_car_mask]
+  connect_bd_net -net rhd_regs_0_o_decim_ctrl [get_bd_pins rhd_regs_0/o_decim_ctrl] [get_bd_pins rhd_wrapper_0/i_decim_ctrl]
+  connect_bd_net -net rhd_regs_0_o_det_adapt_k [get_bd_pins rhd_regs_0/o_det_adapt_k] [get_bd_pins rhd_wrapper_0/i_det_adapt_k]
+  connect_bd_net -net rhd_regs_0_o_det_ctrl [get_bd_pins rhd_regs_0/o_det_ctrl] [get_bd_pins rhd_wrapper_0/i_det_ctrl]
+  connect_bd_net -net rhd_regs_0_o_det_evt_addr [get_bd_pins rhd_regs_0/o_det_evt_addr] [get_bd_pins rhd_wrapper_0/i_det_evt_addr]
+  connect_bd_net -net rhd_regs_0_o_det_mask [get_bd_pins rhd_regs_0/o_det_mask] [get_bd_pins rhd_wrapper_0/i_det_mask]
+  connect_bd_net -net rhd_regs_0_o_det_pulse_len [get_bd_pins rhd_regs_0/o_det_pulse_len] [get_bd_pins rhd_wrapper_0/i_det_pulse_len]
+  connect_bd_net -net rhd_regs_0_o_det_tau [get_bd_pins rhd_regs_0/o_det_tau] [get_bd_pins rhd_wrapper_0/i_det_tau]
+  connect_bd_net -net rhd_regs_0_o_det_thr_addr [get_bd_pins rhd_regs_0/o_det_thr_addr] [get_bd_pins rhd_wrapper_0/i_det_thr_addr]
+  connect_bd_net -net rhd_regs_0_o_det_thr_data [get_bd_pins rhd_regs_0/o_det_thr_data] [get_bd_pins rhd_wrapper_0/i_det_thr_data]
+  connect_bd_net -net rhd_regs_0_o_det_thr_wr [get_bd_pins rhd_regs_0/o_det_thr_wr] [get_bd_pins rhd_wrapper_0/i_det_thr_wr]
+  connect_bd_net -net rhd_regs_0_o_feat_ctrl [get_bd_pins rhd_regs_0/o_feat_ctrl] [get_bd_pins rhd_wrapper_0/i_feat_ctrl]
+  connect_bd_net -net rhd_regs_0_o_feat_hop [get_bd_pins rhd_regs_0/o_feat_hop] [get_bd_pins rhd_wrapper_0/i_feat_hop]
+  connect_bd_net -net rhd_regs_0_o_feat_rd_addr [get_bd_pins rhd_regs_0/o_feat_rd_addr] [get_bd_pins rhd_wrapper_0/i_feat_rd_addr]
+  connect_bd_net -net rhd_regs_0_o_feat_rd_en [get_bd_pins rhd_regs_0/o_feat_rd_en] [get_bd_pins rhd_wrapper_0/i_feat_rd_en]
+  connect_bd_net -net rhd_regs_0_o_feat_thresh [get_bd_pins rhd_regs_0/o_feat_thresh] [get_bd_pins rhd_wrapper_0/i_feat_thresh]
+  connect_bd_net -net rhd_regs_0_o_feat_win [get_bd_pins rhd_regs_0/o_feat_win] [get_bd_pins rhd_wrapper_0/i_feat_win]
+  connect_bd_net -net rhd_regs_0_o_frame_period [get_bd_pins rhd_regs_0/o_frame_period] [get_bd_pins rhd_wrapper_0/i_frame_period]
+  connect_bd_net -net rhd_regs_0_o_hpf_coef [get_bd_pins rhd_regs_0/o_hpf_coef] [get_bd_pins rhd_wrapper_0/i_hpf_coef]
+  connect_bd_net -net rhd_regs_0_o_hpf_ctrl [get_bd_pins rhd_regs_0/o_hpf_ctrl] [get_bd_pins rhd_wrapper_0/i_hpf_ctrl]
+  connect_bd_net -net rhd_regs_0_o_irq [get_bd_pins rhd_regs_0/o_irq] [get_bd_pins xlconcat_irq/In1]
+  connect_bd_net -net rhd_regs_0_o_notch_coef_addr [get_bd_pins rhd_regs_0/o_notch_coef_addr] [get_bd_pins rhd_wrapper_0/i_notch_coef_addr]
+  connect_bd_net -net rhd_regs_0_o_notch_coef_data [get_bd_pins rhd_regs_0/o_notch_coef_data] [get_bd_pins rhd_wrapper_0/i_notch_coef_data]
+  connect_bd_net -net rhd_regs_0_o_notch_coef_wr [get_bd_pins rhd_regs_0/o_notch_coef_wr] [get_bd_pins rhd_wrapper_0/i_notch_coef_wr]
+  connect_bd_net -net rhd_regs_0_o_notch_ctrl [get_bd_pins rhd_regs_0/o_notch_ctrl] [get_bd_pins rhd_wrapper_0/i_notch_ctrl]
+  connect_bd_net -net rhd_regs_0_o_pack_ctrl [get_bd_pins rhd_regs_0/o_pack_ctrl] [get_bd_pins rhd_wrapper_0/i_pack_ctrl]
+  connect_bd_net -net rhd_regs_0_o_pack_mask [get_bd_pins rhd_regs_0/o_pack_mask] [get_bd_pins rhd_wrapper_0/i_pack_mask]
+  connect_bd_net -net rhd_regs_0_o_pat_ctrl [get_bd_pins rhd_regs_0/o_pat_ctrl] [get_bd_pins rhd_wrapper_0/i_pat_ctrl]
+  connect_bd_net -net rhd_regs_0_o_prv_ctrl [get_bd_pins rhd_regs_0/o_prv_ctrl] [get_bd_pins rhd_wrapper_0/i_prv_ctrl]
+  connect_bd_net -net rhd_regs_0_o_prv_ratio [get_bd_pins rhd_regs_0/o_prv_ratio] [get_bd_pins rhd_wrapper_0/i_prv_ratio]
+  connect_bd_net -net rhd_regs_0_o_rice_ctrl [get_bd_pins rhd_regs_0/o_rice_ctrl] [get_bd_pins rhd_wrapper_0/i_rice_ctrl]
+  connect_bd_net -net rhd_regs_0_o_rice_k [get_bd_pins rhd_regs_0/o_rice_k] [get_bd_pins rhd_wrapper_0/i_rice_k]
+  connect_bd_net -net rhd_regs_0_o_rice_key_period [get_bd_pins rhd_regs_0/o_rice_key_period] [get_bd_pins rhd_wrapper_0/i_rice_key_period]
+  connect_bd_net -net rhd_regs_0_o_scrub_addr [get_bd_pins rhd_regs_0/o_scrub_addr] [get_bd_pins rhd_wrapper_0/i_scrub_addr]
+  connect_bd_net -net rhd_regs_0_o_scrub_ctrl [get_bd_pins rhd_regs_0/o_scrub_ctrl] [get_bd_pins rhd_wrapper_0/i_scrub_ctrl]
+  connect_bd_net -net rhd_regs_0_o_scrub_data [get_bd_pins rhd_regs_0/o_scrub_data] [get_bd_pins rhd_wrapper_0/i_scrub_data]
+  connect_bd_net -net rhd_regs_0_o_scrub_mask [get_bd_pins rhd_regs_0/o_scrub_mask] [get_bd_pins rhd_wrapper_0/i_scrub_mask]
+  connect_bd_net -net rhd_regs_0_o_scrub_period [get_bd_pins rhd_regs_0/o_scrub_period] [get_bd_pins rhd_wrapper_0/i_scrub_period]
+  connect_bd_net -net rhd_regs_0_o_scrub_wr [get_bd_pins rhd_regs_0/o_scrub_wr] [get_bd_pins rhd_wrapper_0/i_scrub_wr]
+  connect_bd_net -net rhd_regs_0_o_seq_en [get_bd_pins rhd_regs_0/o_seq_en] [get_bd_pins rhd_wrapper_0/i_seq_en]
+  connect_bd_net -net rhd_regs_0_o_settle_ctrl [get_bd_pins rhd_regs_0/o_settle_ctrl] [get_bd_pins rhd_wrapper_0/i_settle_ctrl]
+  connect_bd_net -net rhd_regs_0_o_settle_hits [get_bd_pins rhd_regs_0/o_settle_hits] [get_bd_pins rhd_wrapper_0/i_settle_hits]
+  connect_bd_net -net rhd_regs_0_o_settle_hold [get_bd_pins rhd_regs_0/o_settle_hold] [get_bd_pins rhd_wrapper_0/i_settle_hold]
+  connect_bd_net -net rhd_regs_0_o_settle_margin [get_bd_pins rhd_regs_0/o_settle_margin] [get_bd_pins rhd_wrapper_0/i_settle_margin]
+  connect_bd_net -net rhd_regs_0_o_settle_mask [get_bd_pins rhd_regs_0/o_settle_mask] [get_bd_pins rhd_wrapper_0/i_settle_mask]
+  connect_bd_net -net rhd_regs_0_o_settle_reg0 [get_bd_pins rhd_regs_0/o_settle_reg0] [get_bd_pins rhd_wrapper_0/i_settle_reg0]
+  connect_bd_net -net rhd_regs_0_o_snap_rd_addr [get_bd_pins rhd_regs_0/o_snap_rd_addr] [get_bd_pins rhd_wrapper_0/i_snap_rd_addr]
+  connect_bd_net -net rhd_regs_0_o_snap_rd_en [get_bd_pins rhd_regs_0/o_snap_rd_en] [get_bd_pins rhd_wrapper_0/i_snap_rd_en]
+  connect_bd_net -net rhd_regs_0_o_spatial_coef_addr [get_bd_pins rhd_regs_0/o_spatial_coef_addr] [get_bd_pins rhd_wrapper_0/i_spatial_coef_addr]
+  connect_bd_net -net rhd_regs_0_o_spatial_coef_data [get_bd_pins rhd_regs_0/o_spatial_coef_data] [get_bd_pins rhd_wrapper_0/i_spatial_coef_data]
+  connect_bd_net -net rhd_regs_0_o_spatial_coef_wr [get_bd_pins rhd_regs_0/o_spatial_coef_wr] [get_bd_pins rhd_wrapper_0/i_spatial_coef_wr]
+  connect_bd_net -net rhd_regs_0_o_spatial_ctrl [get_bd_pins rhd_regs_0/o_spatial_ctrl] [get_bd_pins rhd_wrapper_0/i_spatial_ctrl]
+  connect_bd_net -net rhd_regs_0_o_spec_bands [get_bd_pins rhd_regs_0/o_spec_bands] [get_bd_pins rhd_wrapper_0/i_spec_bands]
+  connect_bd_net -net rhd_regs_0_o_spec_ctrl [get_bd_pins rhd_regs_0/o_spec_ctrl] [get_bd_pins rhd_wrapper_0/i_spec_ctrl]
+  connect_bd_net -net rhd_regs_0_o_spec_hop [get_bd_pins rhd_regs_0/o_spec_hop] [get_bd_pins rhd_wrapper_0/i_spec_hop]
+  connect_bd_net -net rhd_regs_0_o_spec_rd_addr [get_bd_pins rhd_regs_0/o_spec_rd_addr] [get_bd_pins rhd_wrapper_0/i_spec_rd_addr]
+  connect_bd_net -net rhd_regs_0_o_spec_rd_en [get_bd_pins rhd_regs_0/o_spec_rd_en] [get_bd_pins rhd_wrapper_0/i_spec_rd_en]
+  connect_bd_net -net rhd_regs_0_o_stats_ctrl [get_bd_pins rhd_regs_0/o_stats_ctrl] [get_bd_pins rhd_wrapper_0/i_stats_ctrl]
+  connect_bd_net -net rhd_regs_0_o_stats_interval [get_bd_pins rhd_regs_0/o_stats_interval] [get_bd_pins rhd_wrapper_0/i_stats_interval]
+  connect_bd_net -net rhd_regs_0_o_stats_rd_addr [get_bd_pins rhd_regs_0/o_stats_rd_addr] [get_bd_pins rhd_wrapper_0/i_stats_rd_addr]
+  connect_bd_net -net rhd_regs_0_o_stats_rd_en [get_bd_pins rhd_regs_0/o_stats_rd_en] [get_bd_pins rhd_wrapper_0/i_stats_rd_en]
+  connect_bd_net -net rhd_regs_0_o_sync_slave [get_bd_pins rhd_regs_0/o_sync_slave] [get_bd_pins rhd_wrapper_0/i_sync_slave]
+  connect_bd_net -net rhd_regs_0_o_zc_cfg [get_bd_pins rhd_regs_0/o_zc_cfg] [get_bd_pins rhd_wrapper_0/i_zc_cfg]
+  connect_bd_net -net rhd_regs_0_o_zc_ctrl [get_bd_pins rhd_regs_0/o_zc_ctrl] [get_bd_pins rhd_wrapper_0/i_zc_ctrl]
+  connect_bd_net -net rhd_regs_0_o_zc_frames [get_bd_pins rhd_regs_0/o_zc_frames] [get_bd_pins rhd_wrapper_0/i_zc_frames]
+  connect_bd_net -net rhd_regs_0_o_zc_phase_inc [get_bd_pins rhd_regs_0/o_zc_phase_inc] [get_bd_pins rhd_wrapper_0/i_zc_phase_inc]
+  connect_bd_net -net rhd_regs_0_o_zc_rd_addr [get_bd_pins rhd_regs_0/o_zc_rd_addr] [get_bd_pins rhd_wrapper_0/i_zc_rd_addr]
+  connect_bd_net -net rhd_regs_0_o_zc_rd_en [get_bd_pins rhd_regs_0/o_zc_rd_en] [get_bd_pins rhd_wrapper_0/i_zc_rd_en]
+  connect_bd_net -net rhd_regs_0_o_zc_settle [get_bd_pins rhd_regs_0/o_zc_settle] [get_bd_pins rhd_wrapper_0/i_zc_settle]
+  connect_bd_net -net rhd_wrapper_0_o_aux_data [get_bd_pins rhd_regs_0/i_aux_data] [get_bd_pins rhd_wrapper_0/o_aux_data]
+  connect_bd_net -net rhd_wrapper_0_o_aux_slot [get_bd_pins rhd_regs_0/i_aux_slot] [get_bd_pins rhd_wrapper_0/o_aux_slot]
+  connect_bd_net -net rhd_wrapper_0_o_aux_valid [get_bd_pins rhd_regs_0/i_aux_valid] [get_bd_pins rhd_wrapper_0/o_aux_valid]
+  connect_bd_net -net rhd_wrapper_0_o_bank_ready [get_bd_pins rhd_wrapper_0/o_bank_ready] [get_bd_pins xlconcat_irq/In0]
+  connect_bd_net -net rhd_wrapper_0_o_banks_status [get_bd_pins axi_gpio_banks/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_banks_status]
+  connect_bd_net -net rhd_wrapper_0_o_cap_status [get_bd_pins rhd_regs_0/i_cap_status] [get_bd_pins rhd_wrapper_0/o_cap_status]
+  connect_bd_net -net rhd_wrapper_0_o_car_mean [get_bd_pins rhd_regs_0/i_car_mean] [get_bd_pins rhd_wrapper_0/o_car_mean]
   connect_bd_net -net rhd_wrapper_0_o_cs [get_bd_ports o_cs] [get_bd_pins rhd_wrapper_0/o_cs]
+  connect_bd_net -net rhd_wrapper_0_o_ctrl_pending [get_bd_pins axi_gpio_cfg/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_ctrl_pending]
+  connect_bd_net -net rhd_wrapper_0_o_det_evt_count [get_bd_pins rhd_regs_0/i_det_evt_count] [get_bd_pins rhd_wrapper_0/o_det_evt_count]
+  connect_bd_net -net rhd_wrapper_0_o_det_evt_data [get_bd_pins rhd_regs_0/i_det_evt_data] [get_bd_pins rhd_wrapper_0/o_det_evt_data]
+  connect_bd_net -net rhd_wrapper_0_o_detect [get_bd_ports o_detect] [get_bd_pins rhd_wrapper_0/o_detect]
   connect_bd_net -net rhd_wrapper_0_o_done [get_bd_pins axi_gpio_ctrl/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_done]
   connect_bd_net -net rhd_wrapper_0_o_dout [get_bd_pins axi_gpio_data/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_dout]
+  connect_bd_net -net rhd_wrapper_0_o_feat_rd_data [get_bd_pins rhd_regs_0/i_feat_rd_data] [get_bd_pins rhd_wrapper_0/o_feat_rd_data]
+  connect_bd_net -net rhd_wrapper_0_o_feat_ready [get_bd_pins rhd_regs_0/i_feat_ready] [get_bd_pins rhd_wrapper_0/o_feat_ready]
+  connect_bd_net -net rhd_wrapper_0_o_frame_cnt [get_bd_pins rhd_regs_0/i_frame_cnt] [get_bd_pins rhd_wrapper_0/o_frame_cnt]
+  connect_bd_net -net rhd_wrapper_0_o_frame_flags [get_bd_pins rhd_regs_0/i_frame_flags] [get_bd_pins rhd_wrapper_0/o_frame_flags]
   connect_bd_net -net rhd_wrapper_0_o_mosi [get_bd_ports o_mosi] [get_bd_pins rhd_wrapper_0/o_mosi]
+  connect_bd_net -net rhd_wrapper_0_o_overruns [get_bd_pins rhd_regs_0/i_overruns] [get_bd_pins rhd_wrapper_0/o_overruns]
   connect_bd_net -net rhd_wrapper_0_o_sclk [get_bd_ports o_sclk] [get_bd_pins rhd_wrapper_0/o_sclk]
-  connect_bd_net -net rst_ps7_0_50M_peripheral_aresetn [get_bd_pins axi_gpio_cfg/s_axi_aresetn] [get_bd_pins axi_gpio_ctrl/s_axi_aresetn] [get_bd_pins axi_gpio_data/s_axi_aresetn] [get_bd_pins ps7_0_axi_periph/ARESETN] [get_bd_pins ps7_0_axi_periph/M00_ARESETN] [get_bd_pins ps7_0_axi_periph/M01_ARESETN] [get_bd_pins ps7_0_axi_periph/M02_ARESETN] [get_bd_pins ps7_0_axi_periph/S00_ARESETN] [get_bd_pins rhd_wrapper_0/i_rst] [get_bd_pins rst_ps7_0_50M/peripheral_aresetn]
+  connect_bd_net -net rhd_wrapper_0_o_scrub_alert [get_bd_pins rhd_regs_0/i_scrub_alert] [get_bd_pins rhd_wrapper_0/o_scrub_alert]
+  connect_bd_net -net rhd_wrapper_0_o_scrub_flags [get_bd_pins rhd_regs_0/i_scrub_flags] [get_bd_pins rhd_wrapper_0/o_scrub_flags]
+  connect_bd_net -net rhd_wrapper_0_o_scrub_status [get_bd_pins rhd_regs_0/i_scrub_status] [get_bd_pins rhd_wrapper_0/o_scrub_status]
+  connect_bd_net -net rhd_wrapper_0_o_settle_status [get_bd_pins rhd_regs_0/i_settle_status] [get_bd_pins rhd_wrapper_0/o_settle_status]
+  connect_bd_net -net rhd_wrapper_0_o_snap_rd_data [get_bd_pins rhd_regs_0/i_snap_rd_data] [get_bd_pins rhd_wrapper_0/o_snap_rd_data]
+  connect_bd_net -net rhd_wrapper_0_o_spec_rd_data [get_bd_pins rhd_regs_0/i_spec_rd_data] [get_bd_pins rhd_wrapper_0/o_spec_rd_data]
+  connect_bd_net -net rhd_wrapper_0_o_spec_ready [get_bd_pins rhd_regs_0/i_spec_ready] [get_bd_pins rhd_wrapper_0/o_spec_ready]
+  connect_bd_net -net rhd_wrapper_0_o_stats_rd_data [get_bd_pins rhd_regs_0/i_stats_rd_data] [get_bd_pins rhd_wrapper_0/o_stats_rd_data]
+  connect_bd_net -net rhd_wrapper_0_o_stats_ready [get_bd_pins rhd_regs_0/i_stats_ready] [get_bd_pins rhd_wrapper_0/o_stats_ready]
+  connect_bd_net -net rhd_wrapper_0_o_sync_out [get_bd_ports o_sync_out] [get_bd_pins rhd_wrapper_0/o_sync_out]
+  connect_bd_net -net rhd_wrapper_0_o_trace_data [get_bd_pins axi_gpio_trace_data/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_trace_data]
+  connect_bd_net -net rhd_wrapper_0_o_trace_status [get_bd_pins axi_gpio_trace/gpio2_io_i] [get_bd_pins rhd_wrapper_0/o_trace_status]
+  connect_bd_net -net rhd_wrapper_0_o_zc_rd_data [get_bd_pins rhd_regs_0/i_zc_rd_data] [get_bd_pins rhd_wrapper_0/o_zc_rd_data]
+  connect_bd_net -net rhd_wrapper_0_o_zc_status [get_bd_pins rhd_regs_0/i_zc_status] [get_bd_pins rhd_wrapper_0/o_zc_status]
+  connect_bd_net -net rst_ps7_0_50M_peripheral_aresetn [get_bd_pins axi_bram_ctrl_banks/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_cap/s_axi_aresetn] [get_bd_pins axi_dma_beat/axi_resetn] [get_bd_pins axi_dma_blk/axi_resetn] [get_bd_pins axi_dma_cmp/axi_resetn] [get_bd_pins axi_dma_prv/axi_resetn] [get_bd_pins axi_gpio_banks/s_axi_aresetn] [get_bd_pins axi_gpio_cfg/s_axi_aresetn] [get_bd_pins axi_gpio_ctrl/s_axi_aresetn] [get_bd_pins axi_gpio_data/s_axi_aresetn] [get_bd_pins axi_gpio_trace/s_axi_aresetn] [get_bd_pins axi_gpio_trace_data/s_axi_aresetn] [get_bd_pins axi_mem_intercon/ARESETN] [get_bd_pins axi_mem_intercon/M00_ARESETN] [get_bd_pins axi_mem_intercon/S00_ARESETN] [get_bd_pins axi_mem_intercon/S01_ARESETN] [get_bd_pins axi_mem_intercon/S02_ARESETN] [get_bd_pins axi_mem_intercon/S03_ARESETN] [get_bd_pins axis_data_fifo_beat/s_axis_aresetn] [get_bd_pins axis_data_fifo_blk/s_axis_aresetn] [get_bd_pins axis_data_fifo_cmp/s_axis_aresetn] [get_bd_pins axis_data_fifo_prv/s_axis_aresetn] [get_bd_pins ps7_0_axi_periph/ARESETN] [get_bd_pins ps7_0_axi_periph/M00_ARESETN] [get_bd_pins ps7_0_axi_periph/M01_ARESETN] [get_bd_pins ps7_0_axi_periph/M02_ARESETN] [get_bd_pins ps7_0_axi_periph/M03_ARESETN] [get_bd_pins ps7_0_axi_periph/M04_ARESETN] [get_bd_pins ps7_0_axi_periph/M05_ARESETN] [get_bd_pins ps7_0_axi_periph/M06_ARESETN] [get_bd_pins ps7_0_axi_periph/M07_ARESETN] [get_bd_pins ps7_0_axi_periph/M08_ARESETN] [get_bd_pins ps7_0_axi_periph/M09_ARESETN] [get_bd_pins ps7_0_axi_periph/M10_ARESETN] [get_bd_pins ps7_0_axi_periph/M11_ARESETN] [get_bd_pins ps7_0_axi_periph/M12_ARESETN] [get_bd_pins ps7_0_axi_periph/S00_ARESETN] [get_bd_pins rhd_regs_0/i_rst] [get_bd_pins rhd_wrapper_0/i_rst] [get_bd_pins rst_ps7_0_50M/peripheral_aresetn]
+  connect_bd_net -net xlconcat_irq_dout [get_bd_pins processing_system7_0/IRQ_F2P] [get_bd_pins xlconcat_irq/dout]
 
   # Create address segments
+  assign_bd_address -offset 0x00000000 -range 0x40000000 -target_address_space [get_bd_addr_spaces axi_dma_beat/Data_S2MM] [get_bd_addr_segs processing_system7_0/S_AXI_HP0/HP0_DDR_LOWOCM] -force
+  assign_bd_address -offset 0x00000000 -range 0x40000000 -target_address_space [get_bd_addr_spaces axi_dma_blk/Data_S2MM] [get_bd_addr_segs processing_system7_0/S_AXI_HP0/HP0_DDR_LOWOCM] -force
+  assign_bd_address -offset 0x00000000 -range 0x40000000 -target_address_space [get_bd_addr_spaces axi_dma_cmp/Data_S2MM] [get_bd_addr_segs processing_system7_0/S_AXI_HP0/HP0_DDR_LOWOCM] -force
+  assign_bd_address -offset 0x00000000 -range 0x40000000 -target_address_space [get_bd_addr_spaces axi_dma_prv/Data_S2MM] [get_bd_addr_segs processing_system7_0/S_AXI_HP0/HP0_DDR_LOWOCM] -force
+  assign_bd_address -offset 0x40000000 -range 0x00002000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_bram_ctrl_banks/S_AXI/Mem0] -force
+  assign_bd_address -offset 0x40010000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_bram_ctrl_cap/S_AXI/Mem0] -force
+  assign_bd_address -offset 0x40400000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_dma_cmp/S_AXI_LITE/Reg] -force
+  assign_bd_address -offset 0x40410000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_dma_blk/S_AXI_LITE/Reg] -force
+  assign_bd_address -offset 0x40420000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_dma_prv/S_AXI_LITE/Reg] -force
+  assign_bd_address -offset 0x40430000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_dma_beat/S_AXI_LITE/Reg] -force
   assign_bd_address -offset 0x41200000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_cfg/S_AXI/Reg] -force
   assign_bd_address -offset 0x41210000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_ctrl/S_AXI/Reg] -force
   assign_bd_address -offset 0x41220000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_data/S_AXI/Reg] -force
+  assign_bd_address -offset 0x41230000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_banks/S_AXI/Reg] -force
+  assign_bd_address -offset 0x41240000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_trace/S_AXI/Reg] -force
+  assign_bd_address -offset 0x41250000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_trace_data/S_AXI/Reg] -force
+  assign_bd_address -offset 0x43C00000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs rhd_regs_0/S_AXI/reg0] -force
 
 
   # Restore current instance